@@ -0,0 +1,201 @@
+/*
+ *  Copyright (c) 2010-2012 Anders Wallin (anders.e.e.wallin "at" gmail.com).
+ *
+ *  This file is part of Openvoronoi
+ *  (see https://github.com/aewallin/openvoronoi).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+namespace bucketgrid {
+
+/// \brief uniform bucket-grid for nearest neighbor search
+///
+/// The square [-far,far]x[-far,far] is divided into n_bins x n_bins cells.
+/// Points outside the square are put in the nearest border cell.
+/// This is the "bucketing" technique used by Sugihara and Iri for their
+/// "one million generators" Voronoi diagram. For uniformly distributed
+/// points and n_bins ~ sqrt(N) each cell holds O(1) points and nearest()
+/// runs in O(1) expected time.
+///
+/// Storage is pooled: all points live in one std::vector, and each cell is a
+/// singly linked list (through an index array) into this pool. Inserting a
+/// point does not allocate a new node per point or per cell.
+///
+/// point_type must provide operator[] for the x(0) and y(1) coordinate
+/// and dist() which returns the squared distance, as kd_point does.
+template<class point_type>
+class BucketGrid {
+public:
+    /// create grid
+    /// \param far half-width of the square covered by the grid
+    /// \param n_bins number of cells along x and along y
+    BucketGrid(double far, unsigned int n_bins) : far_(far) {
+        n_bins_ = std::max( n_bins, 1u );
+        width_ = 2.0*far_/n_bins_;
+        cell_head_.assign( n_bins_*n_bins_, (unsigned int)NONE );
+    }
+    virtual ~BucketGrid() { }
+    /// remove all points, and let the grid cover [-far,far]x[-far,far].
+    /// the cell and point arrays keep their capacity.
+    void clear(double far) {
+        far_ = far;
+        width_ = 2.0*far_/n_bins_;
+        cell_head_.assign( n_bins_*n_bins_, (unsigned int)NONE );
+        points_.clear();
+        next_.clear();
+    }
+    /// insert given point into grid
+    int insert( const point_type pos ) {
+        unsigned int cell = cell_index( bin(pos[0]), bin(pos[1]) );
+        points_.push_back( pos );
+        next_.push_back( cell_head_[cell] );
+        cell_head_[cell] = points_.size()-1;
+        return 0;
+    }
+    /// \brief remove the point at the position of \a pos. the last point in the pool takes its place.
+    /// \return false if there is no point at this position
+    bool remove( const point_type& pos ) {
+        unsigned int cell = cell_index( bin(pos[0]), bin(pos[1]) );
+        unsigned int prev = NONE;
+        unsigned int n = cell_head_[cell];
+        while ( n != NONE && !same_position( points_[n], pos ) ) {
+            prev = n;
+            n = next_[n];
+        }
+        if ( n == NONE )
+            return false;
+        relink( cell, prev, next_[n] ); // unlink n
+        unsigned int last = points_.size()-1;
+        if ( n != last ) { // move the last point to n
+            unsigned int last_cell = cell_index( bin(points_[last][0]), bin(points_[last][1]) );
+            unsigned int m = cell_head_[last_cell];
+            prev = NONE;
+            while ( m != last ) {
+                prev = m;
+                m = next_[m];
+            }
+            relink( last_cell, prev, n );
+            points_[n] = points_[last];
+            next_[n] = next_[last];
+        }
+        points_.pop_back();
+        next_.pop_back();
+        return true;
+    }
+    /// \brief overwrite the point at the position of \a pos with \a pos, e.g. to change the data held with it
+    /// \return false if there is no point at this position
+    bool update( const point_type& pos ) {
+        unsigned int cell = cell_index( bin(pos[0]), bin(pos[1]) );
+        for (unsigned int n=cell_head_[cell]; n!=NONE; n=next_[n] ) {
+            if ( same_position( points_[n], pos ) ) {
+                points_[n] = pos;
+                return true;
+            }
+        }
+        return false;
+    }
+    /// return a point in the grid that is nearest to the given point
+    /// false is returned if the grid is empty.
+    std::pair<point_type,bool> nearest( const point_type& pos) {
+        if ( points_.empty() ) return std::make_pair(pos,false);
+        num_cells_searched = 0;
+        int ix = bin(pos[0]);
+        int iy = bin(pos[1]);
+        unsigned int result = NONE;
+        double result_dist_sq = std::numeric_limits<double>::max();
+        // search rings of cells around (ix,iy), until no closer point can be found.
+        // a point in a cell at ring-distance r+1 is at least r*width_ away.
+        for (int r=0; r<(int)n_bins_; ++r) {
+            if ( result != NONE && result_dist_sq <= sq( (r-1)*width_ ) && r>0 )
+                break;
+            for (int i=ix-r; i<=ix+r; ++i) {
+                if ( i==ix-r || i==ix+r ) { // left and right columns of the ring
+                    for (int j=iy-r; j<=iy+r; ++j)
+                        search_cell(i,j,pos,result,result_dist_sq);
+                } else { // only bottom and top cells of this column
+                    search_cell(i,iy-r,pos,result,result_dist_sq);
+                    if (r>0)
+                        search_cell(i,iy+r,pos,result,result_dist_sq);
+                }
+            }
+        }
+        return std::make_pair( points_[result], true);
+    }
+    /// for debug, return the number of cells looked at during the last search
+    int get_num_calls() {return num_cells_searched;}
+    /// return the number of points in the grid
+    unsigned int size() const {return points_.size();}
+    /// return the number of cells along x (or y)
+    unsigned int get_n_bins() const {return n_bins_;}
+private:
+    /// empty cell or end of list
+    static const unsigned int NONE = 0xFFFFFFFF;
+    /// square
+    double sq(double x) const {return x*x;}
+    /// return the cell-index in one direction for coordinate x.
+    /// points outside the grid are clamped to a border cell
+    int bin(double x) const {
+        double b = std::floor( (x+far_)/width_ );
+        if ( b < 0 )
+            return 0;
+        if ( b > n_bins_-1 )
+            return n_bins_-1;
+        return (int)b;
+    }
+    /// return the index into cell_head_ of cell (i,j)
+    unsigned int cell_index(int i, int j) const { return i*n_bins_ + j; }
+    /// true if \a p1 and \a p2 have the same coordinates
+    bool same_position( const point_type& p1, const point_type& p2 ) const {
+        return p1[0] == p2[0] && p1[1] == p2[1];
+    }
+    /// make the link after \a prev (or the head of \a cell, if prev is NONE) point to \a n
+    void relink(unsigned int cell, unsigned int prev, unsigned int n) {
+        if ( prev == NONE )
+            cell_head_[cell] = n;
+        else
+            next_[prev] = n;
+    }
+    /// compare all points in cell (i,j) against the current result
+    void search_cell(int i, int j, const point_type& pos, unsigned int& result, double& result_dist_sq) {
+        if ( i<0 || j<0 || i>=(int)n_bins_ || j>=(int)n_bins_ )
+            return;
+        num_cells_searched++;
+        for (unsigned int n=cell_head_[ cell_index(i,j) ]; n!=NONE; n=next_[n] ) {
+            double dist_sq = points_[n].dist(pos);
+            if ( dist_sq < result_dist_sq ) {
+                result = n;
+                result_dist_sq = dist_sq;
+            }
+        }
+    }
+// DATA
+    double far_; ///< the grid covers [-far_,far_]x[-far_,far_]
+    unsigned int n_bins_; ///< number of cells along x (or y)
+    double width_; ///< width of a cell
+    std::vector<unsigned int> cell_head_; ///< first point in each cell, or NONE
+    std::vector<point_type> points_; ///< all points
+    std::vector<unsigned int> next_; ///< next point in the same cell, or NONE
+    int num_cells_searched; ///< for debug, number of cells visited by nearest()
+};
+
+} // end namespace
+// end file bucketgrid.hpp
@@ -65,11 +65,11 @@ bool VoronoiDiagramChecker::face_count_equals_generator_count() {
 /// however ::SPLIT and ::APEX vertices are of degree 2.
 bool VoronoiDiagramChecker::vertex_degree_ok() {
     BOOST_FOREACH(HEVertex v, g.vertices() ) {
-        if ( g.degree(v) != VoronoiVertex::expected_degree[ g[v].type ] ) {
+        if ( g.degree(v) != VoronoiVertex::expected_degree( g[v].type ) ) {
             std::cout << " vertex_degree_ok() ERROR\n";
             std::cout << " vertex " << g[v].index << " type = " << g[v].type << "\n";
             std::cout << " vertex degree = " << g.degree(v) << "\n";
-            std::cout << " expected degree = " << VoronoiVertex::expected_degree[ g[v].type ]  << "\n";
+            std::cout << " expected degree = " << VoronoiVertex::expected_degree( g[v].type )  << "\n";
             return false;
         }
     }
@@ -0,0 +1,150 @@
+/*
+ *  Copyright (c) 2010-2012 Anders Wallin (anders.e.e.wallin "at" gmail.com).
+ *  
+ *  This file is part of Openvoronoi 
+ *  (see https://github.com/aewallin/openvoronoi).
+ *  
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+namespace ovd
+{
+
+/// \brief monotonic arena for small, long-lived objects (Site and Ofs)
+///
+/// Objects are constructed with create() into large blocks of memory, with
+/// a bump-pointer. Individual objects are never freed. clear() destroys
+/// all objects at once and rewinds the arena, but keeps the blocks for reuse.
+/// The destructor of the arena destroys all objects and frees the blocks.
+///
+/// Pointers returned by create() are valid until clear() or destruction.
+class Arena {
+public:
+    /// \param block_size size in bytes of each memory block
+    explicit Arena(std::size_t block_size = 16*1024) 
+        : block_size_(block_size), current_(0), used_(0) {}
+    ~Arena() {
+        clear();
+        for (std::size_t n=0; n<blocks_.size(); n++)
+            std::free( blocks_[n].data );
+    }
+    /// construct a T with its default constructor
+    template<class T>
+    T* create() {
+        return finalize( new ( allocate(sizeof(T)) ) T() );
+    }
+    /// construct a T from one argument
+    template<class T, class A1>
+    T* create(const A1& a1) {
+        return finalize( new ( allocate(sizeof(T)) ) T(a1) );
+    }
+    /// construct a T from two arguments
+    template<class T, class A1, class A2>
+    T* create(const A1& a1, const A2& a2) {
+        return finalize( new ( allocate(sizeof(T)) ) T(a1,a2) );
+    }
+    /// construct a T from three arguments
+    template<class T, class A1, class A2, class A3>
+    T* create(const A1& a1, const A2& a2, const A3& a3) {
+        return finalize( new ( allocate(sizeof(T)) ) T(a1,a2,a3) );
+    }
+    /// construct a T from four arguments
+    template<class T, class A1, class A2, class A3, class A4>
+    T* create(const A1& a1, const A2& a2, const A3& a3, const A4& a4) {
+        return finalize( new ( allocate(sizeof(T)) ) T(a1,a2,a3,a4) );
+    }
+    /// destroy all objects (in reverse order of creation) and rewind the arena.
+    /// the memory blocks are kept, and reused by subsequent calls to create().
+    void clear() {
+        for (std::size_t n=finalizers_.size(); n>0; n--)
+            finalizers_[n-1].destroy( finalizers_[n-1].object );
+        finalizers_.clear();
+        current_ = 0;
+        used_ = 0;
+    }
+    /// number of objects currently in the arena
+    std::size_t size() const { return finalizers_.size(); }
+    /// total size in bytes of the memory blocks held by the arena
+    std::size_t capacity() const {
+        std::size_t bytes = 0;
+        for (std::size_t n=0; n<blocks_.size(); n++)
+            bytes += blocks_[n].size;
+        return bytes;
+    }
+private:
+    Arena(const Arena&); // not copyable
+    Arena& operator=(const Arena&);
+    
+    /// all objects are aligned to this boundary
+    static std::size_t alignment() { return 16; }
+    /// return memory for an object of \a size bytes. 
+    /// moves on to the next block (or allocates a new one) when the current block is full.
+    void* allocate(std::size_t size) {
+        size = (size + alignment() - 1) & ~(alignment() - 1);
+        while ( current_ < blocks_.size() && used_ + size > blocks_[current_].size ) {
+            current_++;
+            used_ = 0;
+        }
+        if ( current_ == blocks_.size() ) {
+            Block b;
+            b.size = (size > block_size_) ? size : block_size_;
+            b.data = static_cast<char*>( std::malloc(b.size) );
+            if ( !b.data )
+                throw std::bad_alloc();
+            blocks_.push_back(b);
+            used_ = 0;
+        }
+        void* p = blocks_[current_].data + used_;
+        used_ += size;
+        return p;
+    }
+    /// remember how to destroy \a obj
+    template<class T>
+    T* finalize(T* obj) {
+        Finalizer f;
+        f.object = obj;
+        f.destroy = &destroy<T>;
+        finalizers_.push_back(f);
+        return obj;
+    }
+    /// call the destructor of a T
+    template<class T>
+    static void destroy(void* p) { static_cast<T*>(p)->~T(); }
+    
+    /// \brief a memory block
+    struct Block {
+        char* data; ///< malloc'd memory, aligned for any type
+        std::size_t size; ///< size in bytes
+    };
+    /// \brief an object and its destructor
+    struct Finalizer {
+        void* object; ///< the object
+        void (*destroy)(void*); ///< calls the destructor of object
+    };
+    
+    std::size_t block_size_; ///< default size of a new block
+    std::vector<Block> blocks_; ///< all memory blocks
+    std::size_t current_; ///< index of the block we allocate from
+    std::size_t used_; ///< bytes used in the current block
+    std::vector<Finalizer> finalizers_; ///< all objects, in order of creation
+};
+
+} // end ovd namespace
+// end file arena.hpp
@@ -0,0 +1,816 @@
+/*
+ *  Copyright (c) 2010-2012 Anders Wallin (anders.e.e.wallin "at" gmail.com).
+ *
+ *  This file is part of Openvoronoi
+ *  (see https://github.com/aewallin/openvoronoi).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <vector>
+#include <list>
+#include <set>
+#include <map>
+#include <limits>
+#include <iostream>
+#include <cassert>
+
+#include <boost/cstdint.hpp>
+#include <boost/foreach.hpp>
+#include <boost/iterator/iterator_facade.hpp>
+
+#include "topology_log.hpp"
+
+// flat (index-based) storage for the half-edge diagram.
+//
+// vertices, half-edges and faces are stored in std::vectors and referred to
+// by 32-bit indices. Removed vertices/edges are put on a free-list and their
+// slots are re-used by later add_vertex()/add_edge() calls.
+// Each vertex keeps two intrusive doubly-linked lists (out-edges and in-edges)
+// threaded through the edge records, so add/remove of an edge is O(1) and
+// iterating the out-edges of a vertex does not allocate.
+// New edges are appended to the lists, so out-edges are visited in the same
+// (insertion) order as with the BGL listS graph.
+//
+// The public interface is the same as hedi::half_edge_diagram, so the
+// VoronoiDiagram, Offset, filters and MedialAxisWalk code compiles unchanged
+// against either backend. See graph.hpp for how the backend is selected.
+
+namespace hedi  {
+
+/// index type used for vertices and edges in flat_half_edge_diagram
+typedef boost::uint32_t flat_index;
+/// invalid/null index
+const flat_index FLAT_NIL = std::numeric_limits<flat_index>::max();
+
+/// \brief vertex descriptor for flat_half_edge_diagram
+///
+/// a thin wrapper around an index. A default-constructed descriptor is invalid,
+/// just like a default-constructed BGL descriptor.
+struct flat_vertex_descriptor {
+    flat_vertex_descriptor() : idx(FLAT_NIL) {}
+    /// create descriptor for vertex number \a i
+    explicit flat_vertex_descriptor(flat_index i) : idx(i) {}
+    /// equality
+    bool operator==(const flat_vertex_descriptor& o) const { return idx == o.idx; }
+    /// inequality
+    bool operator!=(const flat_vertex_descriptor& o) const { return idx != o.idx; }
+    /// ordering, for use in std::set and std::map
+    bool operator<(const flat_vertex_descriptor& o) const { return idx < o.idx; }
+    flat_index idx; ///< index into the vertex-array
+};
+
+/// \brief edge descriptor for flat_half_edge_diagram
+struct flat_edge_descriptor {
+    flat_edge_descriptor() : idx(FLAT_NIL) {}
+    /// create descriptor for edge number \a i
+    explicit flat_edge_descriptor(flat_index i) : idx(i) {}
+    /// equality
+    bool operator==(const flat_edge_descriptor& o) const { return idx == o.idx; }
+    /// inequality
+    bool operator!=(const flat_edge_descriptor& o) const { return idx != o.idx; }
+    /// ordering, for use in std::set and std::map
+    bool operator<(const flat_edge_descriptor& o) const { return idx < o.idx; }
+    flat_index idx; ///< index into the edge-array
+};
+
+/// print vertex descriptor
+inline std::ostream& operator<<(std::ostream& stream, const flat_vertex_descriptor& v) {
+    return stream << "v" << v.idx;
+}
+/// print edge descriptor
+inline std::ostream& operator<<(std::ostream& stream, const flat_edge_descriptor& e) {
+    return stream << "e" << e.idx;
+}
+
+/// \brief half-edge diagram with contiguous index-based storage
+///
+/// Drop-in replacement for hedi::half_edge_diagram. Instead of a
+/// boost::adjacency_list with listS containers (one heap-allocated node per vertex and edge,
+/// pointer-sized descriptors) this class stores vertex, edge and face records
+/// in std::vectors and uses 32-bit indices as descriptors.
+///
+/// Templated on Vertex/Edge/Face property classes, as half_edge_diagram.
+template <class TVertexProperties,
+          class TEdgeProperties,
+          class TFaceProperties
+          >
+class flat_half_edge_diagram {
+public:
+    /// type of face descriptor
+    typedef unsigned int Face;
+    /// edge descriptor
+    typedef flat_edge_descriptor   Edge;
+    /// vertex descriptor
+    typedef flat_vertex_descriptor Vertex;
+    /// vertex descriptor
+    typedef flat_vertex_descriptor vertex_descriptor;
+    /// edge descriptor
+    typedef flat_edge_descriptor   edge_descriptor;
+    /// vertex size type
+    typedef flat_index             vertices_size_type;
+    /// edge size type
+    typedef flat_index             edges_size_type;
+    /// degree size type
+    typedef flat_index             degree_size_type;
+
+    /// vector of vertices
+    typedef std::vector<Vertex> VertexVector;
+    /// vector of faces
+    typedef std::vector<Face>   FaceVector;
+    /// vector of edges
+    typedef std::vector<Edge>   EdgeVector;
+
+protected:
+    /// vertex record
+    struct vertex_node {
+        /// create vertex with given properties
+        explicit vertex_node(const TVertexProperties& p) : prop(p), out_head(FLAT_NIL), out_tail(FLAT_NIL),
+                                                           in_head(FLAT_NIL), in_tail(FLAT_NIL), out_degree(0), in_degree(0), alive(true) {}
+        TVertexProperties prop; ///< vertex properties
+        flat_index out_head;    ///< first out-edge, or next free vertex when on the free-list
+        flat_index out_tail;    ///< last out-edge
+        flat_index in_head;     ///< first in-edge
+        flat_index in_tail;     ///< last in-edge
+        flat_index out_degree;  ///< number of out-edges
+        flat_index in_degree;   ///< number of in-edges
+        bool alive;             ///< false when this slot is on the free-list
+    };
+    /// half-edge record
+    struct edge_node {
+        edge_node() : source(FLAT_NIL), target(FLAT_NIL),
+                      next_out(FLAT_NIL), prev_out(FLAT_NIL), next_in(FLAT_NIL), prev_in(FLAT_NIL) {}
+        TEdgeProperties prop;  ///< edge properties
+        flat_index source;     ///< source vertex, FLAT_NIL when this slot is on the free-list
+        flat_index target;     ///< target vertex
+        flat_index next_out;   ///< next out-edge of source, or next free edge when on the free-list
+        flat_index prev_out;   ///< previous out-edge of source
+        flat_index next_in;    ///< next in-edge of target
+        flat_index prev_in;    ///< previous in-edge of target
+    };
+public:
+    /// \brief iterator over the out-edges of a vertex
+    ///
+    /// follows the intrusive out-edge list. As with the BGL listS graph
+    /// removing the edge pointed to invalidates the iterator.
+    class OutEdgeItr : public boost::iterator_facade<OutEdgeItr, Edge, boost::forward_traversal_tag, Edge> {
+    public:
+        OutEdgeItr() : edges_(0), current_(FLAT_NIL) {}
+        /// iterator starting at edge \a start in the given edge-array
+        OutEdgeItr(const std::vector<edge_node>* e, flat_index start) : edges_(e), current_(start) {}
+    private:
+        friend class boost::iterator_core_access;
+        void increment() { current_ = (*edges_)[current_].next_out; }
+        bool equal(const OutEdgeItr& other) const { return current_ == other.current_; }
+        Edge dereference() const { return Edge(current_); }
+        const std::vector<edge_node>* edges_; ///< the edge-array
+        flat_index current_; ///< current edge
+    };
+    /// out edge iterator
+    typedef OutEdgeItr out_edge_iterator;
+
+    /// access to Face properties
+    inline TFaceProperties& operator[](Face f) { return faces[f]; }
+    /// const access to Face properties
+    inline const TFaceProperties& operator[](Face f) const { return faces[f]; }
+    /// access to Edge properties
+    inline TEdgeProperties& operator[](Edge e) { return edge_nodes[e.idx].prop; }
+    /// const access to Edge properties
+    inline const TEdgeProperties& operator[](Edge e) const { return edge_nodes[e.idx].prop; }
+    /// access to Vertex properties
+    inline TVertexProperties& operator[](Vertex v)  { return vertex_nodes[v.idx].prop; }
+    /// const access to Vertex properties
+    inline const TVertexProperties& operator[](Vertex v) const  { return vertex_nodes[v.idx].prop; }
+
+//DATA
+    /// container for face properties
+    std::vector< TFaceProperties > faces;
+protected:
+    std::vector< vertex_node > vertex_nodes; ///< vertex records, indexed by Vertex::idx
+    std::vector< edge_node > edge_nodes;     ///< half-edge records, indexed by Edge::idx
+    flat_index free_vertex; ///< head of the vertex free-list
+    flat_index free_edge;   ///< head of the edge free-list
+    flat_index n_vertices;  ///< number of live vertices
+    flat_index n_edges;     ///< number of live edges
+    /// vertices and edges added/removed since begin_undo()
+    topology_log<Vertex, Edge, TVertexProperties, TEdgeProperties> changes;
+    unsigned int undo_faces; ///< number of faces at begin_undo()
+public:
+
+flat_half_edge_diagram() : free_vertex(FLAT_NIL), free_edge(FLAT_NIL), n_vertices(0), n_edges(0), undo_faces(0) {}
+/// dtor
+virtual ~flat_half_edge_diagram() {}
+
+/// reserve storage for \a nv vertices, \a ne half-edges and \a nf faces
+void reserve(unsigned int nv, unsigned int ne, unsigned int nf) {
+    vertex_nodes.reserve(nv);
+    edge_nodes.reserve(ne);
+    faces.reserve(nf);
+}
+
+/// remove all vertices, edges and faces. the storage is kept for reuse.
+void clear() {
+    vertex_nodes.clear();
+    edge_nodes.clear();
+    faces.clear();
+    free_vertex = FLAT_NIL;
+    free_edge = FLAT_NIL;
+    n_vertices = 0;
+    n_edges = 0;
+    changes.clear();
+}
+
+/// \brief start recording the vertices, edges and faces that are added or removed, for undo()
+///
+/// see half_edge_diagram::begin_undo()
+void begin_undo() {
+    changes.begin();
+    undo_faces = faces.size();
+}
+/// stop recording, and forget the recorded changes
+void end_undo() { changes.clear(); }
+/// true if \a v was added since begin_undo()
+bool is_new(Vertex v) const { return changes.is_new(v); }
+/// true if \a e was added since begin_undo()
+bool is_new(Edge e) const { return changes.is_new(e); }
+/// true if \a f was added since begin_undo()
+bool is_new(Face f) const { return changes.active() && f >= undo_faces; }
+/// \brief revert the changes since begin_undo(), and stop recording
+///
+/// see half_edge_diagram::undo(). removed vertices and edges are added back in the
+/// slots at the head of the free-lists, so their indices may change.
+void undo(std::map<Vertex,Vertex>& vmap, std::map<Edge,Edge>& emap) {
+    changes.undo( *this, vmap, emap );
+    faces.erase( faces.begin()+undo_faces, faces.end() );
+}
+
+/// return an invalid face_descriptor
+Face HFace() { return std::numeric_limits<Face>::quiet_NaN(); }
+/// add a blank vertex and return its descriptor
+Vertex add_vertex() { return add_vertex( TVertexProperties() ); }
+/// add a vertex with given properties, return vertex descriptor
+Vertex add_vertex(const TVertexProperties& prop) {
+    flat_index idx;
+    if ( free_vertex != FLAT_NIL ) {
+        idx = free_vertex;
+        free_vertex = vertex_nodes[idx].out_head;
+        vertex_nodes[idx] = vertex_node(prop);
+    } else {
+        idx = vertex_nodes.size();
+        assert( idx != FLAT_NIL );
+        vertex_nodes.push_back( vertex_node(prop) );
+    }
+    n_vertices++;
+    changes.added( Vertex(idx) );
+    return Vertex(idx);
+}
+/// return the target vertex of the given edge
+Vertex target(const Edge e ) const { return Vertex( edge_nodes[e.idx].target ); }
+/// return the source vertex of the given edge
+Vertex source(const Edge e ) const { return Vertex( edge_nodes[e.idx].source ); }
+/// return degree of given vertex
+unsigned int degree( Vertex v)  { return vertex_nodes[v.idx].out_degree + vertex_nodes[v.idx].in_degree; }
+/// return number of faces in graph
+unsigned int num_faces() const { return faces.size(); }
+/// return number of vertices in graph
+unsigned int num_vertices() const { return n_vertices; }
+/// return number of edges in graph
+unsigned int num_edges() const { return n_edges; }
+/// return number of edges on Face f
+unsigned int num_edges(Face f) { return face_edges(f).size(); }
+/// add an edge between vertices v1-v2
+Edge add_edge(Vertex v1, Vertex v2) { return add_edge( v1, v2, TEdgeProperties() ); }
+/// add an edge with given properties between vertices v1-v2
+Edge add_edge( Vertex v1, Vertex  v2, const TEdgeProperties& prop ) {
+    assert( vertex_nodes[v1.idx].alive && vertex_nodes[v2.idx].alive );
+    flat_index idx;
+    if ( free_edge != FLAT_NIL ) {
+        idx = free_edge;
+        free_edge = edge_nodes[idx].next_out;
+        edge_nodes[idx] = edge_node();
+    } else {
+        idx = edge_nodes.size();
+        assert( idx != FLAT_NIL );
+        edge_nodes.push_back( edge_node() );
+    }
+    edge_node& en = edge_nodes[idx];
+    en.prop = prop;
+    en.source = v1.idx;
+    en.target = v2.idx;
+    // append to the out-list of v1
+    vertex_node& src = vertex_nodes[v1.idx];
+    en.prev_out = src.out_tail;
+    if ( src.out_tail != FLAT_NIL )
+        edge_nodes[src.out_tail].next_out = idx;
+    else
+        src.out_head = idx;
+    src.out_tail = idx;
+    src.out_degree++;
+    // append to the in-list of v2
+    vertex_node& trg = vertex_nodes[v2.idx];
+    en.prev_in = trg.in_tail;
+    if ( trg.in_tail != FLAT_NIL )
+        edge_nodes[trg.in_tail].next_in = idx;
+    else
+        trg.in_head = idx;
+    trg.in_tail = idx;
+    trg.in_degree++;
+    n_edges++;
+    changes.added( Edge(idx) );
+    return Edge(idx);
+}
+/// return begin/edge iterators for out-edges of Vertex \a v
+std::pair<OutEdgeItr, OutEdgeItr> out_edge_itr( Vertex v ) {
+    return std::make_pair( OutEdgeItr(&edge_nodes, vertex_nodes[v.idx].out_head), OutEdgeItr(&edge_nodes, FLAT_NIL) );
+}
+/// return true if v1-v2 edge exists
+inline bool has_edge( Vertex v1, Vertex v2) { return find_edge(v1,v2) != FLAT_NIL; }
+/// return v1-v2 Edge
+Edge edge( Vertex v1, Vertex v2) { assert(has_edge(v1,v2)); return Edge( find_edge(v1,v2) ); }
+/// clear given vertex. this removes all edges connecting to the vertex.
+void clear_vertex( Vertex v ) {
+    while ( vertex_nodes[v.idx].out_head != FLAT_NIL )
+        remove_edge( Edge( vertex_nodes[v.idx].out_head ) );
+    while ( vertex_nodes[v.idx].in_head != FLAT_NIL )
+        remove_edge( Edge( vertex_nodes[v.idx].in_head ) );
+}
+/// remove given vertex. call clear_vertex() before this!
+void remove_vertex( Vertex v ) {
+    vertex_node& vn = vertex_nodes[v.idx];
+    assert( vn.alive );
+    assert( vn.out_head == FLAT_NIL && vn.in_head == FLAT_NIL );
+    changes.removing( v, vn.prop );
+    vn.alive = false;
+    vn.out_head = free_vertex;
+    free_vertex = v.idx;
+    n_vertices--;
+}
+/// remove given edge
+void remove_edge( Edge e ) {
+    edge_node& en = edge_nodes[e.idx];
+    assert( en.source != FLAT_NIL );
+    changes.removing( e, Vertex(en.source), Vertex(en.target), en.prop );
+    // unlink from the out-list of the source
+    vertex_node& src = vertex_nodes[en.source];
+    if ( en.prev_out != FLAT_NIL )
+        edge_nodes[en.prev_out].next_out = en.next_out;
+    else
+        src.out_head = en.next_out;
+    if ( en.next_out != FLAT_NIL )
+        edge_nodes[en.next_out].prev_out = en.prev_out;
+    else
+        src.out_tail = en.prev_out;
+    src.out_degree--;
+    // unlink from the in-list of the target
+    vertex_node& trg = vertex_nodes[en.target];
+    if ( en.prev_in != FLAT_NIL )
+        edge_nodes[en.prev_in].next_in = en.next_in;
+    else
+        trg.in_head = en.next_in;
+    if ( en.next_in != FLAT_NIL )
+        edge_nodes[en.next_in].prev_in = en.prev_in;
+    else
+        trg.in_tail = en.prev_in;
+    trg.in_degree--;
+    // put on free-list
+    en.prop = TEdgeProperties();
+    en.source = FLAT_NIL;
+    en.target = FLAT_NIL;
+    en.prev_out = en.next_in = en.prev_in = FLAT_NIL;
+    en.next_out = free_edge;
+    free_edge = e.idx;
+    n_edges--;
+}
+/// delete a vertex. clear and remove.
+void delete_vertex(Vertex v) { clear_vertex(v); remove_vertex(v); }
+
+/// insert Vertex \a v into the middle of Edge \a e
+void add_vertex_in_edge( Vertex v, Edge e) {
+    // see half_edge_diagram::add_vertex_in_edge() for a diagram
+    Edge e_twin = (*this)[e].twin;
+    assert( e_twin != Edge() );
+    Vertex esource = source(e);
+    Vertex etarget = target(e);
+    Face face = (*this)[e].face;
+    Face twin_face = (*this)[e_twin].face;
+    Edge previous = previous_edge(e);
+    Edge twin_previous = previous_edge(e_twin);
+
+    assert( (*this)[previous].face == (*this)[e].face );
+    assert( (*this)[twin_previous].face == (*this)[e_twin].face );
+
+    Edge e1 = add_edge( esource, v );
+    Edge te2 = add_edge( v, esource );
+    (*this)[e1].twin = te2; (*this)[te2].twin = e1;
+    Edge e2 = add_edge( v, etarget );
+    Edge te1 = add_edge( etarget, v );
+    (*this)[e2].twin = te1; (*this)[te1].twin = e2;
+
+    // next-pointers
+    (*this)[previous].next = e1; (*this)[e1].next=e2; (*this)[e2].next = (*this)[e].next;
+    (*this)[twin_previous].next = te1; (*this)[te1].next=te2; (*this)[te2].next = (*this)[e_twin].next;
+    // this copies params, face, k, type
+    (*this)[e1] = (*this)[e];       (*this)[e2] = (*this)[e];       // NOTE: we use EdgeProperties::operator= here to copy !
+    (*this)[te1] = (*this)[e_twin]; (*this)[te2] = (*this)[e_twin];
+    // update the faces
+    faces[face].edge = e1;
+    faces[twin_face].edge = te1;
+    // finally, remove the old edge
+    remove_edge( e );
+    remove_edge( e_twin );
+}
+/// ad two edges, one from \a v1 to \a v2 and one from \a v2 to \a v1
+std::pair<Edge,Edge> add_twin_edges(Vertex v1, Vertex v2) {
+    Edge e1 = add_edge( v1, v2 );
+    Edge e2 = add_edge( v2, v1 );
+    (*this)[e1].twin = e2;
+    (*this)[e2].twin = e1;
+    return std::make_pair(e1,e2);
+}
+
+/// make e1 the twin of e2 (and vice versa)
+void twin_edges( Edge e1, Edge e2 ) {
+    if (target(e1) != source(e2)) {
+        std::cout << " error target(e1)= " << (*this)[target(e1)].index << " != " << (*this)[source(e2)].index << " = source(e2) \n";
+        std::cout << "target(e1) = " << target(e1) << "\n";
+        std::cout << "source(e2) = " << source(e2) << "\n";
+    }
+    assert( target(e1) == source(e2) );
+    assert( source(e1) == target(e2) );
+
+    (*this)[e1].twin = e2;
+    (*this)[e2].twin = e1;
+}
+
+/// add a face
+Face add_face() {
+    TFaceProperties f_prop;
+    return add_face(f_prop);
+}
+
+/// add a face, with given properties
+Face add_face(const TFaceProperties& prop) {
+    faces.push_back( prop );
+    Face index = faces.size()-1;
+    faces[index].idx = index;
+    return index;
+}
+
+/// \brief remove face \a f, which must have no edges left
+///
+/// the last face is moved to index \a f, and the edges around it are updated.
+/// the caller must update any other references to the moved face.
+void remove_face(Face f) {
+    Face last = faces.size()-1;
+    if ( f != last ) {
+        faces[f] = faces[last];
+        faces[f].idx = f;
+        Edge start = faces[f].edge;
+        Edge current = start;
+        do {
+            (*this)[current].face = f;
+            current = (*this)[current].next;
+        } while ( current != start );
+    }
+    faces.pop_back();
+}
+
+/// return all vertices in a vector of vertex descriptors
+VertexVector vertices()  const {
+    VertexVector vv;
+    vv.reserve(n_vertices);
+    for ( flat_index n=0; n<vertex_nodes.size(); ++n ) {
+        if ( vertex_nodes[n].alive )
+            vv.push_back( Vertex(n) );
+    }
+    return vv;
+}
+
+/// return all vertices adjecent to given vertex
+VertexVector adjacent_vertices(  Vertex v) const {
+    VertexVector vv;
+    for ( flat_index e = vertex_nodes[v.idx].out_head; e != FLAT_NIL; e = edge_nodes[e].next_out )
+        vv.push_back( Vertex( edge_nodes[e].target ) );
+    return vv;
+}
+
+/// return all vertices of given face
+VertexVector face_vertices(Face face_idx) const {
+    VertexVector verts;
+    Edge startedge = faces[face_idx].edge; // the edge where we start
+    verts.push_back( target(startedge) );
+    Edge current = (*this)[startedge].next;
+    int count=0;
+    do {
+        verts.push_back( target(current) );
+        assert( (*this)[current].face == (*this)[ (*this)[current].next ].face );
+        current = (*this)[current].next;
+        assert( count < 3000000 ); // stop at some max limit
+        count++;
+    } while ( current != startedge );
+    return verts;
+}
+
+/// return edges of face f as a vector
+/// NOTE: it is faster to write a do-while loop in client code than to call this function!
+EdgeVector face_edges( Face f) const {
+    Edge start_edge = faces[f].edge;
+    Edge current_edge = start_edge;
+    EdgeVector out;
+    do {
+        out.push_back(current_edge);
+        current_edge = (*this)[current_edge].next;
+    } while( current_edge != start_edge );
+    return out;
+}
+
+/// return out_edges of given vertex
+EdgeVector out_edges( Vertex v) const {
+    EdgeVector ev;
+    ev.reserve( vertex_nodes[v.idx].out_degree );
+    for ( flat_index e = vertex_nodes[v.idx].out_head; e != FLAT_NIL; e = edge_nodes[e].next_out )
+        ev.push_back( Edge(e) );
+    return ev;
+}
+
+/// return all edges as a vector
+EdgeVector edges() const {
+    EdgeVector ev;
+    ev.reserve(n_edges);
+    for ( flat_index n=0; n<edge_nodes.size(); ++n ) {
+        if ( edge_nodes[n].source != FLAT_NIL )
+            ev.push_back( Edge(n) );
+    }
+    return ev;
+}
+
+/// return the previous edge. traverses all edges in face until previous found.
+Edge previous_edge( Edge e ) const {
+    Edge previous = (*this)[e].next;
+    while ( (*this)[previous].next != e ) {
+        previous = (*this)[previous].next;
+    }
+    return previous;
+}
+
+/// return adjacent faces to the given vertex
+FaceVector adjacent_faces( Vertex q ) const {
+    std::set<Face> face_set;
+    for ( flat_index e = vertex_nodes[q.idx].out_head; e != FLAT_NIL; e = edge_nodes[e].next_out )
+        face_set.insert( edge_nodes[e].prop.face );
+    FaceVector fv(face_set.begin(), face_set.end());
+    return fv;
+}
+
+/// inserts given vertex into edge e, and into the twin edge e_twin
+/// maintain next-pointers, face-assignment, and k-values
+void insert_vertex_in_edge(Vertex v, Edge e ) {
+    // see half_edge_diagram::insert_vertex_in_edge() for a diagram
+    Edge twin = (*this)[e].twin;
+    Vertex src = source(e);
+    Vertex trg = target(e);
+    Vertex twin_source = source(twin);
+    Vertex twin_target = target(twin);
+    assert( src == twin_target );
+    assert( trg == twin_source );
+
+    Face face = (*this)[e].face;
+    Face twin_face = (*this)[twin].face;
+    Edge previous = previous_edge(e);
+    assert( (*this)[previous].face == (*this)[e].face );
+    Edge twin_previous = previous_edge(twin);
+    assert( (*this)[twin_previous].face == (*this)[twin].face );
+
+    Edge e1 = add_edge( src, v ); // these replace e
+    Edge e2 = add_edge( v, trg );
+
+    // preserve the left/right face link
+    (*this)[e1].face = face;
+    (*this)[e2].face = face;
+    // next-pointers
+    (*this)[previous].next = e1;
+    (*this)[e1].next = e2;
+    (*this)[e2].next = (*this)[e].next;
+
+    Edge te1 = add_edge( twin_source, v  ); // these replace twin
+    Edge te2 = add_edge( v, twin_target  );
+
+    (*this)[te1].face = twin_face;
+    (*this)[te2].face = twin_face;
+
+    (*this)[twin_previous].next = te1;
+    (*this)[te1].next = te2;
+    (*this)[te2].next = (*this)[twin].next;
+
+    // TWINNING (note indices 'cross', see ASCII art above)
+    (*this)[e1].twin = te2;
+    (*this)[te2].twin = e1;
+    (*this)[e2].twin = te1;
+    (*this)[te1].twin = e2;
+
+    // update the faces
+    faces[face].edge = e1;
+    faces[twin_face].edge = te1;
+
+    // finally, remove the old edge
+    remove_edge( e );
+    remove_edge( twin );
+}
+
+/// remove given v1-v2 edge
+void remove_edge( Vertex v1, Vertex v2) {
+    assert( has_edge(v1,v2) );
+    remove_edge( edge(v1,v2) );
+}
+
+/// remove given v1-v2 edge and its twin
+void remove_twin_edges( Vertex v1, Vertex v2) {
+    assert( has_edge(v1,v2) );
+    assert( has_edge(v2,v1) );
+    Edge e1 = edge(v1,v2);
+    Edge e2 = edge(v2,v1);
+    remove_edge( e1 );
+    remove_edge( e2 );
+}
+
+/// remove a degree-two Vertex from the middle of an Edge
+// preserve edge-properties (next, face, k)
+void remove_deg2_vertex( Vertex v ) {
+    // see half_edge_diagram::remove_deg2_vertex() for a diagram
+    EdgeVector v_edges = out_edges(v);
+    assert( v_edges.size() == 2);
+    assert( source(v_edges[0]) == v && source(v_edges[1]) == v );
+
+    Vertex v1 = target( v_edges[0] );
+    Vertex v2 = target( v_edges[1] );
+    Edge v1_next = (*this)[ v_edges[0] ].next;
+    Edge v1_prev = previous_edge( (*this)[ v_edges[0] ].twin );
+    Edge v2_next = (*this)[ v_edges[1] ].next;
+    Edge v2_prev = previous_edge( (*this)[ v_edges[1] ].twin );
+    Face face1 = (*this)[ v_edges[1] ].face;
+    Face face2 = (*this)[ v_edges[0] ].face;
+
+    std::pair<Edge,Edge> new_edges = add_twin_edges(v1,v2);
+    Edge new1 = new_edges.first;
+    Edge new2 = new_edges.second;
+    set_next(new1,v2_next);
+    set_next(new2,v1_next);
+    set_next(v2_prev,new2);
+    set_next(v1_prev,new1);
+    faces[face1].edge = new1;
+    faces[face2].edge = new2;
+    (*this)[new1] = (*this)[ v_edges[1] ]; // NOTE: uses EdgeProperties::operator= to copy edge properties
+    (*this)[new2] = (*this)[ v_edges[0] ]; //  this sets: params, type, k, face
+    remove_twin_edges(v,v1);
+    remove_twin_edges(v,v2);
+    remove_vertex(v);
+}
+/// set next-pointer of e1 to e2
+void set_next(Edge e1, Edge e2) {
+    if (target(e1) != source(e2) ){
+        std::cout << " ERROR target(e1) = " << (*this)[target(e1)].index << " source(e2)= " << (*this)[source(e2)].index << "\n";
+    }
+    assert( target(e1) == source(e2) );
+    (*this)[e1].next = e2;
+}
+
+/// form a face from the edge-list:
+/// e1->e2->...->e1
+/// for all edges, set edge.face=f, and edge.k=k
+void set_next_cycle( std::list<Edge> list, Face f, double k) {
+    typename std::list<Edge>::iterator begin,it,nxt,end;
+    it= list.begin();
+    begin = it;
+    faces[f].edge = *it;
+    end= list.end();
+    for( ; it!=end ; it++ ) {
+        nxt = it;
+        nxt++;
+        if ( nxt != end )
+            set_next(*it,*nxt);
+        else
+            set_next(*it,*begin);
+
+        (*this)[*it].face = f;
+        (*this)[*it].k = k;
+    }
+}
+
+/// set next-pointers for the given list (but don't close to form a cycle)
+// also set face and k properties for edge
+void set_next_chain( std::list<Edge> list, Face f, double k) {
+    typename std::list<Edge>::iterator it,nxt,end;
+    it= list.begin();
+    faces[f].edge = *it;
+    end= list.end();
+    for( ; it!=end ; it++ ) {
+        nxt = it;
+        nxt++;
+        if ( nxt != end )
+            set_next(*it,*nxt);
+
+        (*this)[*it].face = f;
+        (*this)[*it].k = k;
+    }
+}
+
+/// set next-pointers for the list
+void set_next_chain( std::list<Edge> list ) {
+    typename std::list<Edge>::iterator it,nxt,end;
+    it= list.begin();
+    end= list.end();
+    for( ; it!=end ; it++ ) {
+        nxt = it;
+        nxt++;
+        if ( nxt != end )
+            set_next(*it,*nxt);
+    }
+}
+
+/// on a face, search and return the left/right edge from endp
+std::pair<Edge,Edge> find_next_prev(Face f, Vertex endp) {
+    Edge current = faces[f].edge;
+    Edge start_edge = current;
+    Edge next_edge = current;
+    Edge prev_edge = current;
+    do {
+        if ( source(current) == endp )
+            next_edge = current;
+        if ( target(current) == endp )
+            prev_edge = current;
+        current = (*this)[current].next;
+    } while (current!=start_edge);
+    assert( next_edge != Edge() );
+    assert( prev_edge != Edge() );
+    return std::make_pair(next_edge, prev_edge);
+}
+
+/// print all faces of graph
+void print_faces() {
+    for( Face f=0;f<num_faces();f++) {
+        print_face(f);
+    }
+}
+
+/// print out vertices on given Face
+void print_face(Face f) {
+    std::cout << " Face " << f << ": ";
+    Edge current = faces[f].edge;
+    Edge start=current;
+    int num_e=0;
+    do {
+        Vertex v = source(current);
+        std::cout << (*this)[v].index  << "(" << (*this)[v].status  << ")-f"<< (*this)[current].face << "-";
+        num_e++;
+        assert(num_e<300);
+        current = (*this)[current].next;
+    } while ( current!=start );
+    std::cout << "\n";
+}
+
+/// print given edges
+void print_edges(EdgeVector& q) {
+    BOOST_FOREACH( Edge e, q ) {
+        std::cout << (*this)[source(e)].index << "-" << (*this)[target(e)].index << "\n";
+    }
+}
+
+/// print edge
+void print_edge(Edge e) {
+    std::cout << (*this)[source(e)].index << "-f" << (*this)[e].face << "-" << (*this)[target(e)].index << "\n";
+}
+
+/// print given vertices
+void print_vertices(VertexVector& q) {
+    BOOST_FOREACH( Vertex v, q) {
+        std::cout << (*this)[v].index << "["<< (*this)[v].type << "]" << " ";
+    }
+    std::cout << std::endl;
+}
+
+protected:
+/// return index of the v1-v2 edge, or FLAT_NIL if there is no such edge
+flat_index find_edge( Vertex v1, Vertex v2 ) const {
+    for ( flat_index e = vertex_nodes[v1.idx].out_head; e != FLAT_NIL; e = edge_nodes[e].next_out ) {
+        if ( edge_nodes[e].target == v2.idx )
+            return e;
+    }
+    return FLAT_NIL;
+}
+
+}; // end flat_half_edge_diagram class definition
+
+} // end hedi namespace
+// end flat_halfedgediagram.hpp
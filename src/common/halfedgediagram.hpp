@@ -21,12 +21,15 @@
 
 #include <vector>
 #include <list>
+#include <map>
 
 #include <boost/graph/adjacency_list.hpp>
 #include <boost/foreach.hpp> 
 #include <boost/iterator/iterator_facade.hpp>
 #include <boost/assign/list_of.hpp>
 
+#include "topology_log.hpp"
+
 // bundled BGL properties, see: http://www.boost.org/doc/libs/1_44_0/libs/graph/doc/bundles.html
 
 // dcel notes from http://www.holmes3d.net/graphics/dcel/
@@ -161,21 +164,50 @@ public:
     std::vector< TFaceProperties > faces; // this could maybe be held as a GraphProperty of the BGL-graph?
     /// underlying BGL graph
     BGLGraph g;
+protected:
+    /// vertices and edges added/removed since begin_undo()
+    topology_log<Vertex, Edge, TVertexProperties, TEdgeProperties> changes;
+    unsigned int undo_faces; ///< number of faces at begin_undo()
+public:
     
 // NOTE: there is no HEDIGraph constructor, we use the default one..
 
 /// dtor
 virtual ~half_edge_diagram(){
-    // sites are associated with faces. go through all faces and delete the site
-    //std::cout << "~half_edge_diagram()...";
-    /*
-    BOOST_FOREACH( TFaceProperties fprop, faces ) {
-        if (fprop.site)
-            delete fprop.site;
-    }
+    // sites are associated with faces, but they are not owned by the graph.
+    // the VoronoiDiagram creates (and destroys) them in its site_arena.
+}
+
+/// remove all vertices, edges and faces. 
+/// the face-vector keeps its capacity, the listS vertex/edge nodes are freed.
+void clear() {
     g.clear();
-    */
-    //std::cout << "DONE.";
+    faces.clear();
+    changes.clear();
+}
+
+/// \brief start recording the vertices, edges and faces that are added or removed, for undo()
+///
+/// properties of vertices, edges and faces that are modified, but not removed, are not recorded.
+void begin_undo() {
+    changes.begin();
+    undo_faces = faces.size();
+}
+/// stop recording, and forget the recorded changes
+void end_undo() { changes.clear(); }
+/// true if \a v was added since begin_undo()
+bool is_new(Vertex v) const { return changes.is_new(v); }
+/// true if \a e was added since begin_undo()
+bool is_new(Edge e) const { return changes.is_new(e); }
+/// true if \a f was added since begin_undo()
+bool is_new(Face f) const { return changes.active() && f >= undo_faces; }
+/// \brief revert the changes since begin_undo(), and stop recording
+///
+/// added vertices, edges and faces are removed. removed vertices and edges are added back,
+/// with new descriptors. these are returned in \a vmap and \a emap, keyed by the old descriptor.
+void undo(std::map<Vertex,Vertex>& vmap, std::map<Edge,Edge>& emap) {
+    changes.undo( *this, vmap, emap );
+    faces.erase( faces.begin()+undo_faces, faces.end() );
 }
 
 // One-liner wrappers around boost-graph-library functions:
@@ -183,9 +215,17 @@ virtual ~half_edge_diagram(){
 /// return an invalid face_descriptor
 Face HFace() { return std::numeric_limits<Face>::quiet_NaN(); }
 /// add a blank vertex and return its descriptor
-Vertex add_vertex() { return boost::add_vertex( g ); }
+Vertex add_vertex() { 
+    Vertex v = boost::add_vertex( g );
+    changes.added(v);
+    return v;
+}
 /// add a vertex with given properties, return vertex descriptor
-Vertex add_vertex(const TVertexProperties& prop) { return boost::add_vertex( prop, g ); }
+Vertex add_vertex(const TVertexProperties& prop) { 
+    Vertex v = boost::add_vertex( prop, g );
+    changes.added(v);
+    return v;
+}
 /// return the target vertex of the given edge
 Vertex target(const Edge e ) const { return boost::target( e, g ); }
 /// return the source vertex of the given edge
@@ -201,9 +241,17 @@ unsigned int num_edges() const { return boost::num_edges( g ); }
 /// return number of edges on Face f
 unsigned int num_edges(Face f) { return face_edges(f).size(); }
 /// add an edge between vertices v1-v2
-Edge add_edge(Vertex v1, Vertex v2) { return boost::add_edge( v1, v2, g).first; }
+Edge add_edge(Vertex v1, Vertex v2) { 
+    Edge e = boost::add_edge( v1, v2, g).first;
+    changes.added(e);
+    return e;
+}
 /// add an edge with given properties between vertices v1-v2
-Edge add_edge( Vertex v1, Vertex  v2, const TEdgeProperties& prop ) { return boost::add_edge( v1, v2, prop, g).first; }
+Edge add_edge( Vertex v1, Vertex  v2, const TEdgeProperties& prop ) { 
+    Edge e = boost::add_edge( v1, v2, prop, g).first;
+    changes.added(e);
+    return e;
+}
 /// return begin/edge iterators for out-edges of Vertex \a v
 std::pair<OutEdgeItr, OutEdgeItr> out_edge_itr( Vertex v ) { return boost::out_edges( v, g ); } // FIXME: change name to out_edges!!
 /// return true if v1-v2 edge exists
@@ -211,11 +259,26 @@ inline bool has_edge( Vertex v1, Vertex v2) { return boost::edge( v1, v2, g ).se
 /// return v1-v2 Edge
 Edge edge( Vertex v1, Vertex v2) { assert(has_edge(v1,v2)); return boost::edge( v1, v2, g ).first; }
 /// clear given vertex. this removes all edges connecting to the vertex.
-void clear_vertex( Vertex v ) { boost::clear_vertex( v, g ); }
+void clear_vertex( Vertex v ) { 
+    if ( !changes.active() ) {
+        boost::clear_vertex( v, g );
+        return;
+    }
+    while ( boost::out_degree( v, g ) > 0 ) // one at a time, so that each edge is recorded
+        remove_edge( *boost::out_edges( v, g ).first );
+    while ( boost::in_degree( v, g ) > 0 )
+        remove_edge( *boost::in_edges( v, g ).first );
+}
 /// remove given vertex. call clear_vertex() before this!
-void remove_vertex( Vertex v ) { boost::remove_vertex( v , g ); }
+void remove_vertex( Vertex v ) { 
+    changes.removing( v, g[v] );
+    boost::remove_vertex( v , g );
+}
 /// remove given edge
-void remove_edge( Edge e ) { boost::remove_edge( e , g ); }
+void remove_edge( Edge e ) { 
+    changes.removing( e, source(e), target(e), g[e] );
+    boost::remove_edge( e , g );
+}
 /// delete a vertex. clear and remove.
 void delete_vertex(Vertex v) { clear_vertex(v); remove_vertex(v); }
 
@@ -250,14 +313,14 @@ void add_vertex_in_edge( Vertex v, Edge e) {
     assert( g[previous].face == g[e].face );
     assert( g[twin_previous].face == g[e_twin].face );
     
-    Edge e1 = boost::add_edge( esource, v, g).first;
-    Edge te2 = boost::add_edge( v, esource,  g).first;
+    Edge e1 = add_edge( esource, v );
+    Edge te2 = add_edge( v, esource );
     g[e1].twin = te2; g[te2].twin = e1;
     //boost::tie(e1,te2) = add_twin_edges( esource, v ); 
     //Edge e2, te1;
     //boost::tie(e2,te1) = add_twin_edges( v, etarget );    
-    Edge e2 = boost::add_edge( v, etarget, g).first;
-    Edge te1 = boost::add_edge( etarget, v,  g).first;
+    Edge e2 = add_edge( v, etarget );
+    Edge te1 = add_edge( etarget, v );
     g[e2].twin = te1; g[te1].twin = e2;
 
 
@@ -274,8 +337,8 @@ void add_vertex_in_edge( Vertex v, Edge e) {
     faces[twin_face].edge = te1;
     // finally, remove the old edge
     //remove_twin_edges(esource, etarget);
-    boost::remove_edge( e , g );
-    boost::remove_edge( e_twin , g );
+    remove_edge( e );
+    remove_edge( e_twin );
 }
 /// ad two edges, one from \a v1 to \a v2 and one from \a v2 to \a v1
 std::pair<Edge,Edge> add_twin_edges(Vertex v1, Vertex v2) {
@@ -283,8 +346,8 @@ std::pair<Edge,Edge> add_twin_edges(Vertex v1, Vertex v2) {
     //bool b;
     //boost::tie( e1 , b ) = boost::add_edge( v1, v2, g);
     //boost::tie( e2 , b ) = boost::add_edge( v2, v1, g);
-    Edge e1 = boost::add_edge( v1, v2, g).first;
-    Edge e2 = boost::add_edge( v2, v1, g).first;
+    Edge e1 = add_edge( v1, v2 );
+    Edge e2 = add_edge( v2, v1 );
     //twin_edges(e1,e2);
     g[e1].twin = e2;
     g[e2].twin = e1;
@@ -322,6 +385,25 @@ Face add_face(const TFaceProperties& prop) {
     return index;    
 }
 
+/// \brief remove face \a f, which must have no edges left
+///
+/// the last face is moved to index \a f, and the edges around it are updated.
+/// the caller must update any other references to the moved face.
+void remove_face(Face f) {
+    Face last = faces.size()-1;
+    if ( f != last ) {
+        faces[f] = faces[last];
+        faces[f].idx = f;
+        Edge start = faces[f].edge;
+        Edge current = start;
+        do {
+            g[current].face = f;
+            current = g[current].next;
+        } while ( current != start );
+    }
+    faces.pop_back();
+}
+
 /// return all vertices in a vector of vertex descriptors
 VertexVector vertices()  const {
     VertexVector vv;
@@ -495,8 +577,8 @@ void insert_vertex_in_edge(Vertex v, Edge e ) {
     faces[twin_face].edge = te1;
     
     // finally, remove the old edge
-    boost::remove_edge( e   , g);
-    boost::remove_edge( twin, g);
+    remove_edge( e );
+    remove_edge( twin );
 }
 
 /// remove given v1-v2 edge
@@ -504,7 +586,7 @@ void remove_edge( Vertex v1, Vertex v2) {
     assert( has_edge(v1,v2) );
     typedef typename std::pair<Edge, bool> EdgeBool;
     EdgeBool result = boost::edge(v1, v2, g );    
-    boost::remove_edge( result.first , g );
+    remove_edge( result.first );
 }
 
 /// remove given v1-v2 edge and its twin
@@ -514,8 +596,8 @@ void remove_twin_edges( Vertex v1, Vertex v2) {
     typedef typename std::pair<Edge, bool> EdgeBool;
     EdgeBool result1 = boost::edge(v1, v2, g ); 
     EdgeBool result2 = boost::edge(v2, v1, g );    
-    boost::remove_edge( result1.first , g );
-    boost::remove_edge( result2.first , g );
+    remove_edge( result1.first );
+    remove_edge( result2.first );
 }
 
 /// remove a degree-two Vertex from the middle of an Edge
@@ -0,0 +1,92 @@
+/*
+ *  Copyright (c) 2010-2012 Anders Wallin (anders.e.e.wallin "at" gmail.com).
+ *
+ *  This file is part of Openvoronoi
+ *  (see https://github.com/aewallin/openvoronoi).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "point.hpp"
+
+namespace ovd {
+
+/// number of cells along x (or y) of the grid used by hilbert_index()
+const unsigned int HILBERT_GRID = 1u << 16;
+
+/// \brief position of cell (x,y) along the Hilbert curve through a HILBERT_GRID x HILBERT_GRID grid
+///
+/// Points that are close along the curve are close in the plane, so
+/// sorting points by this index gives an insertion order with good locality.
+/// x and y must be smaller than HILBERT_GRID. The result fits in 32 bits.
+inline unsigned int hilbert_index(unsigned int x, unsigned int y) {
+    unsigned int d = 0;
+    for (unsigned int s = HILBERT_GRID/2; s > 0; s /= 2) {
+        unsigned int rx = (x & s) ? 1 : 0;
+        unsigned int ry = (y & s) ? 1 : 0;
+        d += s * s * ((3 * rx) ^ ry);
+        if (ry == 0) { // rotate the quadrant
+            if (rx == 1) {
+                x = HILBERT_GRID-1 - x;
+                y = HILBERT_GRID-1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return d;
+}
+
+/// \brief hilbert_index() of points, on a grid that covers the bounding box of a point set
+class HilbertOrder {
+public:
+    /// grid over the bounding box of \a points
+    explicit HilbertOrder(const std::vector<Point>& points) : minx(0), miny(0), scale(0) {
+        if ( points.empty() )
+            return;
+        minx = points[0].x;
+        miny = points[0].y;
+        double maxx = minx, maxy = miny;
+        for (unsigned int n=1; n<points.size(); ++n) {
+            minx = std::min(minx,points[n].x); maxx = std::max(maxx,points[n].x);
+            miny = std::min(miny,points[n].y); maxy = std::max(maxy,points[n].y);
+        }
+        double width = std::max( maxx-minx, maxy-miny );
+        scale = (width > 0) ? (HILBERT_GRID-1)/width : 0;
+    }
+    /// position of \a p along the curve. points outside the bounding box are clamped to its border.
+    unsigned int index(const Point& p) const {
+        return hilbert_index( cell(p.x-minx), cell(p.y-miny) );
+    }
+private:
+    /// grid cell for offset \a d from the lower-left corner
+    unsigned int cell(double d) const {
+        double c = d*scale;
+        if ( c < 0 )
+            return 0;
+        if ( c > HILBERT_GRID-1 )
+            return HILBERT_GRID-1;
+        return (unsigned int)c;
+    }
+    double minx;  ///< lower-left corner of the bounding box
+    double miny;  ///< lower-left corner of the bounding box
+    double scale; ///< grid cells per unit length
+};
+
+} // end namespace
+// end file hilbert.hpp
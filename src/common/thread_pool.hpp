@@ -0,0 +1,155 @@
+/*
+ *  Copyright (c) 2010-2012 Anders Wallin (anders.e.e.wallin "at" gmail.com).
+ *
+ *  This file is part of Openvoronoi
+ *  (see https://github.com/aewallin/openvoronoi).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <deque>
+#include <vector>
+#include <cassert>
+
+#include <boost/thread.hpp>
+#include <boost/bind/bind.hpp>
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+
+namespace ovd {
+
+/// \brief fixed-size thread pool with one task deque per worker
+///
+/// A worker takes tasks from the back of its own deque (LIFO, so a follow-on
+/// task submitted by a running task is likely to find its data in cache),
+/// and when its own deque is empty it steals from the front of the other
+/// workers' deques. Tasks submitted from outside the pool are spread
+/// round-robin over the workers.
+///
+/// Tasks must not throw.
+class WorkStealingPool : boost::noncopyable {
+public:
+    /// a unit of work
+    typedef boost::function<void ()> Task;
+
+    /// start \a n_threads workers. n_threads==0 starts one worker per hardware thread.
+    explicit WorkStealingPool(unsigned int n_threads)
+        : queued(0), pending(0), next_worker(0), stop(false) {
+        if (n_threads == 0)
+            n_threads = boost::thread::hardware_concurrency();
+        if (n_threads == 0)
+            n_threads = 1;
+        for (unsigned int n=0; n<n_threads; ++n)
+            workers.push_back( new Worker() );
+        for (unsigned int n=0; n<n_threads; ++n)
+            threads.create_thread( boost::bind( &WorkStealingPool::run, this, n ) );
+    }
+    /// stop and join all workers. tasks still in the deques are not run.
+    ~WorkStealingPool() {
+        {
+            boost::mutex::scoped_lock lock(mutex);
+            stop = true;
+        }
+        work_cv.notify_all();
+        threads.join_all();
+        for (unsigned int n=0; n<workers.size(); ++n)
+            delete workers[n];
+    }
+    /// add a task. Called from a worker the task goes on that worker's own deque.
+    void submit(const Task& t) {
+        boost::mutex::scoped_lock lock(mutex);
+        unsigned int* self = worker_id.get();
+        unsigned int w = self ? *self : (next_worker++ % workers.size());
+        {
+            boost::mutex::scoped_lock wlock(workers[w]->mutex);
+            workers[w]->tasks.push_back(t);
+        }
+        queued++;
+        pending++;
+        work_cv.notify_one();
+    }
+    /// block until all submitted tasks have run. Must not be called from a worker.
+    void wait() {
+        assert( !worker_id.get() );
+        boost::mutex::scoped_lock lock(mutex);
+        while (pending > 0)
+            done_cv.wait(lock);
+    }
+    /// number of worker threads
+    unsigned int size() const { return workers.size(); }
+private:
+    /// a worker's task deque
+    struct Worker {
+        boost::mutex mutex;      ///< protects tasks
+        std::deque<Task> tasks;  ///< tasks waiting to run
+    };
+    /// worker loop for worker \a id
+    void run(unsigned int id) {
+        worker_id.reset( new unsigned int(id) );
+        for (;;) {
+            Task t;
+            if ( take(id, t) ) {
+                t();
+                boost::mutex::scoped_lock lock(mutex);
+                if (--pending == 0)
+                    done_cv.notify_all();
+                continue;
+            }
+            boost::mutex::scoped_lock lock(mutex);
+            while (!stop && queued == 0)
+                work_cv.wait(lock);
+            if (stop)
+                return;
+        }
+    }
+    /// pop from the back of our own deque, or steal from the front of another deque
+    bool take(unsigned int id, Task& t) {
+        unsigned int n_workers = workers.size();
+        for (unsigned int k=0; k<n_workers; ++k) {
+            Worker* w = workers[ (id+k) % n_workers ];
+            boost::mutex::scoped_lock wlock(w->mutex);
+            if ( w->tasks.empty() )
+                continue;
+            if (k == 0) {
+                t = w->tasks.back();
+                w->tasks.pop_back();
+            } else {
+                t = w->tasks.front();
+                w->tasks.pop_front();
+            }
+            wlock.unlock();
+            boost::mutex::scoped_lock lock(mutex);
+            queued--;
+            return true;
+        }
+        return false;
+    }
+// DATA
+    std::vector<Worker*> workers;   ///< one deque per worker thread
+    boost::thread_group threads;    ///< the worker threads
+    /// index of the worker running on the calling thread, null outside the pool
+    boost::thread_specific_ptr<unsigned int> worker_id;
+    boost::mutex mutex;             ///< protects the counters below
+    boost::condition_variable work_cv; ///< signalled when a task is queued, or on stop
+    boost::condition_variable done_cv; ///< signalled when pending drops to zero
+    unsigned int queued;            ///< tasks sitting in a deque
+    unsigned int pending;           ///< tasks submitted but not finished
+    unsigned int next_worker;       ///< round-robin counter for submits from outside the pool
+    bool stop;                      ///< set by the destructor
+};
+
+} // end namespace
+// end file thread_pool.hpp
@@ -0,0 +1,171 @@
+/*
+ *  Copyright (c) 2010-2012 Anders Wallin (anders.e.e.wallin "at" gmail.com).
+ *
+ *  This file is part of Openvoronoi
+ *  (see https://github.com/aewallin/openvoronoi).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <vector>
+#include <set>
+#include <map>
+
+namespace hedi  {
+
+/// \brief record of the vertices and edges added to and removed from a half-edge diagram
+///
+/// Used by half_edge_diagram and flat_half_edge_diagram to implement begin_undo() and undo().
+/// While active, the diagram reports each add/remove here. A removed vertex or edge is stored
+/// with its properties (and an edge with its endpoints), so that undo() can add it back.
+///
+/// undo() replays the record backwards. Re-created vertices and edges get new descriptors, and
+/// a descriptor may be re-used by the graph during the recorded changes, so the replay keeps a map
+/// from recorded descriptors to current ones. When the replay is done the maps hold, for each
+/// vertex and edge that existed before begin() and was removed, its new descriptor.
+template <class Vertex, class Edge, class TVertexProperties, class TEdgeProperties>
+class topology_log {
+public:
+    topology_log() : on(false) {}
+    /// clear the record and start recording
+    void begin() {
+        clear();
+        on = true;
+    }
+    /// stop recording, and forget the record
+    void clear() {
+        on = false;
+        steps.clear();
+        vertex_props.clear();
+        edge_props.clear();
+        new_vertices.clear();
+        new_edges.clear();
+    }
+    /// true while recording
+    bool active() const { return on; }
+    /// true if \a v was added since begin()
+    bool is_new(Vertex v) const { return new_vertices.find(v) != new_vertices.end(); }
+    /// true if \a e was added since begin()
+    bool is_new(Edge e) const { return new_edges.find(e) != new_edges.end(); }
+
+    /// \a v was added
+    void added(Vertex v) {
+        if (!on)
+            return;
+        steps.push_back( step(ADD_VERTEX) );
+        steps.back().v = v;
+        new_vertices.insert(v);
+    }
+    /// \a e was added
+    void added(Edge e) {
+        if (!on)
+            return;
+        steps.push_back( step(ADD_EDGE) );
+        steps.back().e = e;
+        new_edges.insert(e);
+    }
+    /// \a v, with properties \a p, is about to be removed
+    void removing(Vertex v, const TVertexProperties& p) {
+        if (!on)
+            return;
+        steps.push_back( step(REMOVE_VERTEX) );
+        steps.back().v = v;
+        steps.back().prop = vertex_props.size();
+        vertex_props.push_back(p);
+        new_vertices.erase(v);
+    }
+    /// the \a src - \a trg edge \a e, with properties \a p, is about to be removed
+    void removing(Edge e, Vertex src, Vertex trg, const TEdgeProperties& p) {
+        if (!on)
+            return;
+        steps.push_back( step(REMOVE_EDGE) );
+        steps.back().e = e;
+        steps.back().v = src;
+        steps.back().trg = trg;
+        steps.back().prop = edge_props.size();
+        edge_props.push_back(p);
+        new_edges.erase(e);
+    }
+
+    /// \brief revert the recorded changes of graph \a g, and stop recording
+    ///
+    /// \a vmap and \a emap are filled with the new descriptors of re-created vertices and edges.
+    /// re-created vertices and edges have their properties from the time of removal, with the
+    /// next- and twin-pointers of edges mapped to the new descriptors.
+    template <class Graph>
+    void undo(Graph& g, std::map<Vertex,Vertex>& vmap, std::map<Edge,Edge>& emap) {
+        on = false; // the graph calls added() and removing() during the replay
+        vmap.clear();
+        emap.clear();
+        for (unsigned int n=steps.size(); n-- > 0; ) {
+            const step& s = steps[n];
+            switch (s.op) {
+            case ADD_EDGE:
+                g.remove_edge( mapped(emap, s.e) );
+                emap.erase(s.e);
+                break;
+            case REMOVE_EDGE: {
+                const TEdgeProperties& p = edge_props[s.prop];
+                Edge e = g.add_edge( mapped(vmap, s.v), mapped(vmap, s.trg), p );
+                g[e].next = p.next; // not copied by the assignment operator of the edge properties
+                g[e].twin = p.twin;
+                emap[s.e] = e;
+                break;
+            }
+            case ADD_VERTEX: // its edges were added later, and are gone by now
+                g.remove_vertex( mapped(vmap, s.v) );
+                vmap.erase(s.v);
+                break;
+            case REMOVE_VERTEX:
+                vmap[s.v] = g.add_vertex( vertex_props[s.prop] );
+                break;
+            }
+        }
+        typename std::map<Edge,Edge>::const_iterator it;
+        for (it = emap.begin(); it != emap.end(); ++it) {
+            g[it->second].next = mapped(emap, g[it->second].next);
+            g[it->second].twin = mapped(emap, g[it->second].twin);
+        }
+        clear();
+    }
+    /// \a d through the map \a m, or \a d itself if it is not in the map
+    template <class Descriptor>
+    static Descriptor mapped(const std::map<Descriptor,Descriptor>& m, Descriptor d) {
+        typename std::map<Descriptor,Descriptor>::const_iterator it = m.find(d);
+        return ( it == m.end() ) ? d : it->second;
+    }
+private:
+    /// kind of change
+    enum op_type { ADD_VERTEX, REMOVE_VERTEX, ADD_EDGE, REMOVE_EDGE };
+    /// one recorded change
+    struct step {
+        /// change of given kind
+        explicit step(op_type o) : op(o), prop(0) {}
+        op_type op;        ///< kind of change
+        Vertex v;          ///< the vertex, or the source of the edge
+        Vertex trg;        ///< target of the removed edge
+        Edge e;            ///< the edge
+        unsigned int prop; ///< index into vertex_props or edge_props, for a removal
+    };
+    bool on; ///< recording
+    std::vector<step> steps; ///< the changes, in order
+    std::vector<TVertexProperties> vertex_props; ///< properties of removed vertices
+    std::vector<TEdgeProperties> edge_props;     ///< properties of removed edges
+    std::set<Vertex> new_vertices; ///< vertices added since begin(), and not removed
+    std::set<Edge> new_edges;      ///< edges added since begin(), and not removed
+};
+
+} // end hedi namespace
+// end topology_log.hpp
@@ -0,0 +1,487 @@
+/*
+ *  Copyright (c) 2010-2012 Anders Wallin (anders.e.e.wallin "at" gmail.com).
+ *
+ *  This file is part of Openvoronoi
+ *  (see https://github.com/aewallin/openvoronoi).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cassert>
+#include <cstring>
+#include <map>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/foreach.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include "diagram_archive.hpp"
+#include "voronoidiagram.hpp"
+
+namespace ovd
+{
+
+namespace {
+
+const char magic[4] = {'O','V','D','B'};  ///< first four bytes of an archive
+const boost::uint32_t byte_order = 0x01020304; ///< written in host byte-order, to detect the other order
+
+/// site record types
+enum { POINT_RECORD = 0, LINE_RECORD = 1, ARC_RECORD = 2 };
+
+/// write numbers in host byte-order
+class Writer {
+public:
+    Writer(std::ostream& o): out(o) {}
+    void u8(unsigned int x) { put( (boost::uint8_t)x ); }
+    void u32(unsigned int x) { put( (boost::uint32_t)x ); }
+    void i32(int x) { put( (boost::int32_t)x ); }
+    void f64(double x) { put(x); }
+    void point(const Point& p) { f64(p.x); f64(p.y); }
+private:
+    template<class T>
+    void put(const T& x) { out.write( reinterpret_cast<const char*>(&x), sizeof(T) ); }
+    std::ostream& out;
+};
+
+/// read numbers from a buffer. reading past the end clears ok, and returns zeros.
+class Reader {
+public:
+    Reader(const char* d, std::size_t s): p(d), end(d+s), ok(true) {}
+    unsigned int u8() { return get<boost::uint8_t>(); }
+    unsigned int u32() { return get<boost::uint32_t>(); }
+    int i32() { return get<boost::int32_t>(); }
+    double f64() { return get<double>(); }
+    Point point() { double x = f64(); return Point( x, f64() ); }
+    /// true if \a n records of \a size bytes remain. a cheap check before resizing vectors to \a n.
+    bool remains(unsigned int n, std::size_t size) const { return n <= (std::size_t)(end-p) / size; }
+    /// all reads were within the buffer
+    bool good() const { return ok; }
+private:
+    template<class T>
+    T get() {
+        T x = 0;
+        if ( (std::size_t)(end-p) < sizeof(T) ) {
+            ok = false;
+            return x;
+        }
+        std::memcpy( &x, p, sizeof(T) );
+        p += sizeof(T);
+        return x;
+    }
+    const char* p;   ///< read position
+    const char* end; ///< end of buffer
+    bool ok;         ///< all reads were within the buffer
+};
+
+/// a site, as read from the archive
+struct SavedSite {
+    unsigned int type;
+    HEFace face;
+    int ref;       ///< vertex (POINT_RECORD) or pseudo-edge
+    Point p1;      ///< position, or start
+    Point p2;      ///< end
+    Point c;       ///< center of arc
+    double k;      ///< offset-direction of line
+    bool cw;       ///< direction of arc
+};
+
+/// a vertex, as read from the archive
+struct VertexRecord {
+    int index;
+    unsigned int status;
+    unsigned int type;
+    Point position;
+    double r;
+    double max_error;
+    double k3;
+    double alfa;
+    HEFace null_face;
+    HEFace face;
+};
+
+/// a half-edge, as read from the archive
+struct EdgeRecord {
+    int source;
+    int target;
+    int next;
+    int twin;
+    int params;
+    HEFace face;
+    HEFace null_face;
+    bool has_null_face;
+    double k;
+    unsigned int type;
+    bool sign;
+    bool valid;
+    bool inserted_direction;
+};
+
+/// a face, as read from the archive
+struct FaceRecord {
+    int edge;
+    int site;
+    unsigned int status;
+    bool null;
+};
+
+/// position of \a d in the map \a m, or -1
+template <class Descriptor>
+int ordinal(const std::map<Descriptor,int>& m, Descriptor d) {
+    typename std::map<Descriptor,int>::const_iterator it = m.find(d);
+    return ( it == m.end() ) ? -1 : it->second;
+}
+
+/// true if \a i is -1 (when \a allow_none) or a valid position in a table of size \a n
+bool valid_ref(int i, unsigned int n, bool allow_none) {
+    return ( i == -1 && allow_none ) || ( i >= 0 && (unsigned int)i < n );
+}
+
+} // end anonymous namespace
+
+/// \brief write diagram \a vd to \a out
+void DiagramArchive::save(VoronoiDiagram& vd, std::ostream& out) {
+    HEGraph& g = vd.g;
+    VertexVector verts = g.vertices();
+    EdgeVector edges = g.edges();
+    std::map<HEVertex,int> vertex_ord;
+    std::map<HEEdge,int> edge_ord;
+    std::map<Site*,int> site_ord;
+    std::map<EdgeParams*,int> param_ord;
+    std::vector<Site*> sites;
+    std::vector<EdgeParams*> params;
+    for (unsigned int n=0; n<verts.size(); ++n)
+        vertex_ord[ verts[n] ] = n;
+    for (unsigned int n=0; n<edges.size(); ++n) {
+        edge_ord[ edges[n] ] = n;
+        EdgeParams* par = g[ edges[n] ].params.get();
+        if ( par && param_ord.find(par) == param_ord.end() ) {
+            param_ord[par] = params.size();
+            params.push_back(par);
+        }
+    }
+    for (HEFace f=0; f<g.num_faces(); ++f) { // null-faces share the site of a segment endpoint
+        Site* s = g[f].site;
+        if ( s && site_ord.find(s) == site_ord.end() ) {
+            site_ord[s] = sites.size();
+            sites.push_back(s);
+        }
+    }
+    
+    Writer w(out);
+    out.write( magic, 4 );
+    w.u32( version );
+    w.u32( byte_order );
+    w.f64( vd.far_radius );
+    w.i32( vd.num_psites );
+    w.i32( vd.num_lsites );
+    w.i32( vd.num_asites );
+    w.i32( vd.vertex_count );
+    w.u32( vd.last_point_face );
+    w.u32( sites.size() );
+    w.u32( verts.size() );
+    w.u32( params.size() );
+    w.u32( edges.size() );
+    w.u32( g.num_faces() );
+    w.u32( vd.vertex_map.size() );
+    
+    for (unsigned int n=0; n<sites.size(); ++n) {
+        Site* s = sites[n];
+        if ( s->isPoint() ) {
+            w.u8( POINT_RECORD );
+            w.u32( s->face );
+            w.i32( ordinal(vertex_ord, s->vertex()) );
+            w.point( s->position() );
+        } else if ( s->isLine() ) {
+            w.u8( LINE_RECORD );
+            w.u32( s->face );
+            w.i32( ordinal(edge_ord, s->edge()) );
+            w.point( s->start() );
+            w.point( s->end() );
+            w.f64( s->k() );
+        } else {
+            assert( s->isArc() );
+            w.u8( ARC_RECORD );
+            w.u32( s->face );
+            w.i32( ordinal(edge_ord, s->edge()) );
+            w.point( s->start() );
+            w.point( s->end() );
+            w.point( Point( s->x(), s->y() ) );
+            w.u8( s->cw() );
+        }
+    }
+    BOOST_FOREACH( HEVertex v, verts ) {
+        const VoronoiVertex& vv = g[v];
+        w.i32( vv.index );
+        w.u8( vv.status );
+        w.u8( vv.type );
+        w.point( vv.position );
+        w.f64( vv.dist() );
+        w.f64( vv.max_error );
+        w.f64( vv.k3 );
+        w.f64( vv.alfa );
+        w.u32( vv.null_face );
+        w.u32( vv.face );
+    }
+    BOOST_FOREACH( EdgeParams* par, params ) {
+        for (unsigned int m=0; m<8; ++m)
+            w.f64( par->x[m] );
+        for (unsigned int m=0; m<8; ++m)
+            w.f64( par->y[m] );
+    }
+    BOOST_FOREACH( HEEdge e, edges ) {
+        const EdgeProps& ep = g[e];
+        w.i32( vertex_ord[ g.source(e) ] );
+        w.i32( vertex_ord[ g.target(e) ] );
+        w.i32( ordinal(edge_ord, ep.next) );
+        w.i32( ordinal(edge_ord, ep.twin) );
+        w.i32( ep.params ? param_ord[ ep.params.get() ] : -1 );
+        w.u32( ep.face );
+        w.u32( ep.has_null_face ? ep.null_face : 0 ); // not initialized, and not used, without a null-face
+        w.u8( ep.has_null_face );
+        w.f64( ep.k );
+        w.u8( ep.type );
+        w.u8( ep.sign );
+        w.u8( ep.valid );
+        w.u8( ep.inserted_direction );
+    }
+    for (HEFace f=0; f<g.num_faces(); ++f) {
+        w.i32( ordinal(edge_ord, g[f].edge) );
+        w.i32( g[f].site ? site_ord[ g[f].site ] : -1 );
+        w.u8( g[f].status );
+        w.u8( g[f].null );
+    }
+    BOOST_FOREACH( HEVertex v, vd.vertex_map ) {
+        w.i32( ordinal(vertex_ord, v) );
+    }
+}
+
+/// \brief replace the diagram in \a vd with the archive in the buffer \a data of \a size bytes
+///
+/// the whole archive is read and checked before \a vd is modified.
+/// \return false if the archive is truncated, has another version or byte-order, or refers to
+/// vertices, edges, faces or sites that are not in it.
+bool DiagramArchive::load(VoronoiDiagram& vd, const char* data, std::size_t size) {
+    if ( size < 4 || std::memcmp( data, magic, 4 ) != 0 )
+        return false;
+    Reader r( data+4, size-4 );
+    if ( r.u32() != version || r.u32() != byte_order )
+        return false;
+    double far = r.f64();
+    int num_psites = r.i32();
+    int num_lsites = r.i32();
+    int num_asites = r.i32();
+    int vertex_count = r.i32();
+    HEFace last_point_face = r.u32();
+    unsigned int n_sites = r.u32();
+    unsigned int n_verts = r.u32();
+    unsigned int n_params = r.u32();
+    unsigned int n_edges = r.u32();
+    unsigned int n_faces = r.u32();
+    unsigned int n_handles = r.u32();
+    // smallest record sizes. guards the vector sizes below against a corrupt header.
+    if ( !r.good() || !r.remains(n_sites,25) || !r.remains(n_verts,62) || !r.remains(n_params,128) ||
+         !r.remains(n_edges,41) || !r.remains(n_faces,10) || !r.remains(n_handles,4) )
+        return false;
+    
+    std::vector<SavedSite> sites(n_sites);
+    for (unsigned int n=0; n<n_sites && r.good(); ++n) {
+        SavedSite& s = sites[n];
+        s.type = r.u8();
+        s.face = r.u32();
+        s.ref = r.i32();
+        s.p1 = r.point();
+        if ( s.type == LINE_RECORD ) {
+            s.p2 = r.point();
+            s.k = r.f64();
+        } else if ( s.type == ARC_RECORD ) {
+            s.p2 = r.point();
+            s.c = r.point();
+            s.cw = r.u8();
+        } else if ( s.type != POINT_RECORD ) {
+            return false;
+        }
+        if ( s.face >= n_faces ||
+             !valid_ref( s.ref, (s.type == POINT_RECORD) ? n_verts : n_edges, true ) )
+            return false;
+    }
+    std::vector<VertexRecord> verts(n_verts);
+    for (unsigned int n=0; n<n_verts && r.good(); ++n) {
+        VertexRecord& v = verts[n];
+        v.index = r.i32();
+        v.status = r.u8();
+        v.type = r.u8();
+        v.position = r.point();
+        v.r = r.f64();
+        v.max_error = r.f64();
+        v.k3 = r.f64();
+        v.alfa = r.f64();
+        v.null_face = r.u32();
+        v.face = r.u32();
+        if ( v.status > NEW || v.type > SPLIT || v.null_face >= n_faces || v.face >= n_faces )
+            return false;
+    }
+    std::vector< boost::intrusive_ptr<EdgeParams> > params(n_params);
+    for (unsigned int n=0; n<n_params && r.good(); ++n) {
+        params[n] = new EdgeParams();
+        for (unsigned int m=0; m<8; ++m)
+            params[n]->x[m] = r.f64();
+        for (unsigned int m=0; m<8; ++m)
+            params[n]->y[m] = r.f64();
+    }
+    std::vector<EdgeRecord> edges(n_edges);
+    for (unsigned int n=0; n<n_edges && r.good(); ++n) {
+        EdgeRecord& e = edges[n];
+        e.source = r.i32();
+        e.target = r.i32();
+        e.next = r.i32();
+        e.twin = r.i32();
+        e.params = r.i32();
+        e.face = r.u32();
+        e.null_face = r.u32();
+        e.has_null_face = r.u8();
+        e.k = r.f64();
+        e.type = r.u8();
+        e.sign = r.u8();
+        e.valid = r.u8();
+        e.inserted_direction = r.u8();
+        if ( !valid_ref(e.source, n_verts, false) || !valid_ref(e.target, n_verts, false) ||
+             !valid_ref(e.next, n_edges, true) || !valid_ref(e.twin, n_edges, true) ||
+             !valid_ref(e.params, n_params, true) || e.face >= n_faces || e.null_face >= n_faces ||
+             e.type > ARCSITE )
+            return false;
+    }
+    std::vector<FaceRecord> faces(n_faces);
+    for (unsigned int n=0; n<n_faces && r.good(); ++n) {
+        FaceRecord& f = faces[n];
+        f.edge = r.i32();
+        f.site = r.i32();
+        f.status = r.u8();
+        f.null = r.u8();
+        if ( !valid_ref(f.edge, n_edges, true) || !valid_ref(f.site, n_sites, true) || f.status > NONINCIDENT )
+            return false;
+    }
+    std::vector<int> handles(n_handles);
+    for (unsigned int n=0; n<n_handles && r.good(); ++n) {
+        handles[n] = r.i32();
+        if ( !valid_ref(handles[n], n_verts, true) )
+            return false;
+    }
+    if ( !r.good() || last_point_face >= n_faces )
+        return false;
+    
+    // the archive is valid. replace the diagram.
+    HEGraph& g = vd.g;
+    g.clear();
+    vd.site_arena.clear();
+    VertexVector vmap(n_verts);
+    for (unsigned int n=0; n<n_verts; ++n) {
+        const VertexRecord& v = verts[n];
+        vmap[n] = g.add_vertex( VoronoiVertex( v.position, (VertexStatus)v.status, (VertexType)v.type, v.r ) );
+        VoronoiVertex& vv = g[ vmap[n] ];
+        vv.index = v.index;
+        vv.max_error = v.max_error;
+        vv.k3 = v.k3;
+        vv.alfa = v.alfa;
+        vv.null_face = v.null_face;
+        vv.face = v.face;
+    }
+    EdgeVector emap(n_edges);
+    for (unsigned int n=0; n<n_edges; ++n) {
+        const EdgeRecord& e = edges[n];
+        emap[n] = g.add_edge( vmap[e.source], vmap[e.target] );
+        EdgeProps& ep = g[ emap[n] ];
+        ep.face = e.face;
+        ep.null_face = e.null_face;
+        ep.has_null_face = e.has_null_face;
+        ep.k = e.k;
+        ep.type = (EdgeType)e.type;
+        if ( e.params != -1 )
+            ep.params = params[e.params];
+        ep.sign = e.sign;
+        ep.valid = e.valid;
+        ep.inserted_direction = e.inserted_direction;
+    }
+    for (unsigned int n=0; n<n_edges; ++n) { // next and twin, now that all edges exist
+        EdgeProps& ep = g[ emap[n] ];
+        ep.next = ( edges[n].next == -1 ) ? HEEdge() : emap[ edges[n].next ];
+        ep.twin = ( edges[n].twin == -1 ) ? HEEdge() : emap[ edges[n].twin ];
+    }
+    std::vector<Site*> smap(n_sites);
+    for (unsigned int n=0; n<n_sites; ++n) {
+        const SavedSite& s = sites[n];
+        HEVertex sv = ( s.type == POINT_RECORD && s.ref != -1 ) ? vmap[s.ref] : HEVertex();
+        HEEdge se = ( s.type != POINT_RECORD && s.ref != -1 ) ? emap[s.ref] : HEEdge();
+        if ( s.type == POINT_RECORD ) {
+            smap[n] = vd.site_arena.create<PointSite>( s.p1, s.face, sv );
+        } else if ( s.type == LINE_RECORD ) {
+            LineSite* ls = vd.site_arena.create<LineSite>( s.p1, s.p2, s.k, s.face );
+            ls->e = se;
+            smap[n] = ls;
+        } else {
+            ArcSite* as = vd.site_arena.create<ArcSite>( s.p1, s.p2, s.c, s.cw );
+            as->face = s.face;
+            as->e = se;
+            smap[n] = as;
+        }
+    }
+    for (unsigned int n=0; n<n_faces; ++n) {
+        const FaceRecord& f = faces[n];
+        HEFace fd = g.add_face();
+        g[fd].edge = ( f.edge == -1 ) ? HEEdge() : emap[f.edge];
+        g[fd].site = ( f.site == -1 ) ? 0 : smap[f.site];
+        g[fd].status = (VoronoiFaceStatus)f.status;
+        g[fd].null = f.null;
+    }
+    vd.vertex_map.assign( n_handles, HEVertex() );
+    for (unsigned int n=0; n<n_handles; ++n) {
+        if ( handles[n] != -1 )
+            vd.vertex_map[n] = vmap[ handles[n] ];
+    }
+    
+    vd.far_radius = far;
+    vd.num_psites = num_psites;
+    vd.num_lsites = num_lsites;
+    vd.num_asites = num_asites;
+    vd.vertex_count = vertex_count;
+    vd.last_point_face = last_point_face;
+    vd.epoch = 1; // all epoch-stamps of the new vertices are zero
+    while ( !vd.vertexQueue.empty() )
+        vd.vertexQueue.pop();
+    vd.incident_faces.clear();
+    vd.modified_vertices.clear();
+    vd.v0.clear();
+    vd.vpos->reset_stat();
+    vd.build_nearest_index();
+    vd.committed();
+    vd.publish_pending();
+    return true;
+}
+
+/// \brief load() from the file \a filename, mapped read-only into memory
+bool DiagramArchive::load_file(VoronoiDiagram& vd, const std::string& filename) {
+    using namespace boost::interprocess;
+    try {
+        file_mapping file( filename.c_str(), read_only );
+        mapped_region region( file, read_only );
+        return load( vd, static_cast<const char*>( region.get_address() ), region.get_size() );
+    } catch ( interprocess_exception& ) { // missing or empty file
+        return false;
+    }
+}
+
+} // end namespace
+// end file diagram_archive.cpp
@@ -0,0 +1,61 @@
+/*
+ *  Copyright (c) 2010-2012 Anders Wallin (anders.e.e.wallin "at" gmail.com).
+ *
+ *  This file is part of Openvoronoi
+ *  (see https://github.com/aewallin/openvoronoi).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <ostream>
+#include <cstddef>
+
+namespace ovd
+{
+
+class VoronoiDiagram;
+
+/// \brief binary file format of a VoronoiDiagram
+///
+/// The complete diagram is stored: the sites, the vertices with position and clearance radius,
+/// the half-edges with type, next, twin, face and the 8-parameter bisector coefficients, the faces, and
+/// the point-site handles. Loading a diagram copies these records into the graph, without
+/// positioning any vertex, so it is much faster than inserting the sites again. The loaded diagram can
+/// be used with Offset, the filters, MedialAxisWalk, and further insertions.
+///
+/// The format is versioned. Numbers are stored in the byte-order of the machine that wrote
+/// the file, and a file with the other byte-order is rejected. The layout is:
+/// - header: "OVDB", version, byte-order mark 0x01020304, far-radius, site and vertex counters
+/// - sites: type, face, geometry, and the vertex (PointSite) or pseudo-edge (LineSite, ArcSite)
+/// - vertices
+/// - bisector parameters, each record shared by the edges that share it in the diagram
+/// - half-edges. vertices, edges and sites are referred to by their position in the file.
+/// - faces
+/// - the vertex of each point-site handle, or -1
+///
+/// Sites of failed insertions, and the state of an insertion in progress, are not stored.
+class DiagramArchive {
+public:
+    static void save(VoronoiDiagram& vd, std::ostream& out);
+    static bool load(VoronoiDiagram& vd, const char* data, std::size_t size);
+    static bool load_file(VoronoiDiagram& vd, const std::string& filename);
+    /// the version of the format written by save()
+    static const unsigned int version = 1;
+};
+
+} // end namespace
+// end file diagram_archive.hpp
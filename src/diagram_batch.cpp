@@ -0,0 +1,183 @@
+/*
+ *  Copyright (c) 2010-2012 Anders Wallin (anders.e.e.wallin "at" gmail.com).
+ *
+ *  This file is part of Openvoronoi
+ *  (see https://github.com/aewallin/openvoronoi).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cmath>
+#include <cassert>
+#include <algorithm>
+
+#include <boost/bind/bind.hpp>
+
+#include "diagram_batch.hpp"
+#include "voronoidiagram.hpp"
+#include "common/thread_pool.hpp"
+
+namespace ovd
+{
+
+/// the input and output of one diagram
+struct DiagramBatch::Job {
+    Job(const BatchSites& s): sites(s), vd(0), ok(false), done(false) {}
+    BatchSites sites;                ///< input
+    VoronoiDiagram* vd;              ///< output diagram, owned by the batch until released
+    std::vector<OffsetLoops> loops;  ///< output offsets, one per sites.offsets distance
+    bool ok;                         ///< all sites inserted without error
+    bool done;                       ///< build (and offset) tasks have run. protected by Sync::mutex
+};
+
+/// signals the done-flag of jobs to waiting threads
+struct DiagramBatch::Sync {
+    boost::mutex mutex;              ///< protects Job::done
+    boost::condition_variable cv;    ///< notified when a job is done
+};
+
+DiagramBatch::DiagramBatch(unsigned int n_threads) {
+    pool = new WorkStealingPool(n_threads);
+    sync = new Sync();
+}
+
+/// waits for all jobs, and deletes diagrams that were not released
+DiagramBatch::~DiagramBatch() {
+    pool->wait();
+    delete pool;
+    for (unsigned int n=0; n<jobs.size(); ++n) {
+        if (jobs[n]->vd)
+            delete jobs[n]->vd;
+        delete jobs[n];
+    }
+    delete sync;
+}
+
+DiagramBatch::Handle DiagramBatch::add(const BatchSites& sites) {
+    Job* j = new Job(sites);
+    jobs.push_back(j);
+    pool->submit( boost::bind( &DiagramBatch::build, this, j ) );
+    return jobs.size()-1;
+}
+
+void DiagramBatch::wait() {
+    pool->wait();
+}
+
+void DiagramBatch::wait(Handle h) {
+    Job* j = get_job(h);
+    boost::mutex::scoped_lock lock(sync->mutex);
+    while (!j->done)
+        sync->cv.wait(lock);
+}
+
+bool DiagramBatch::ready(Handle h) {
+    Job* j = get_job(h);
+    boost::mutex::scoped_lock lock(sync->mutex);
+    return j->done;
+}
+
+bool DiagramBatch::ok(Handle h) {
+    wait(h);
+    return get_job(h)->ok;
+}
+
+VoronoiDiagram* DiagramBatch::diagram(Handle h) {
+    wait(h);
+    return get_job(h)->vd;
+}
+
+const std::vector<OffsetLoops>& DiagramBatch::offsets(Handle h) {
+    wait(h);
+    return get_job(h)->loops;
+}
+
+VoronoiDiagram* DiagramBatch::release(Handle h) {
+    wait(h);
+    Job* j = get_job(h);
+    VoronoiDiagram* out = j->vd;
+    j->vd = 0;
+    return out;
+}
+
+unsigned int DiagramBatch::num_threads() const {
+    return pool->size();
+}
+
+VoronoiDiagram* DiagramBatch::create_diagram(double far, unsigned int n_bins) {
+    return new VoronoiDiagram(far, n_bins);
+}
+
+DiagramBatch::Job* DiagramBatch::get_job(Handle h) {
+    assert( h < jobs.size() );
+    return jobs[h];
+}
+
+/// build task: insert all point-sites, then all line-sites, with the bulk insert functions.
+/// queues the offset task on the same worker if offsets were requested.
+void DiagramBatch::build(Job* j) {
+    const BatchSites& s = j->sites;
+    unsigned int bins = s.n_bins;
+    if (bins == 0)
+        bins = std::max( 1, (int)std::sqrt( (double)s.points.size() ) );
+    try {
+        j->vd = create_diagram(s.far, bins);
+        j->vd->set_silent(true);
+        j->vd->use_site_validation( s.validate );
+        std::vector<int> ids = j->vd->insert_point_sites( s.points );
+        std::vector< std::pair<int,int> > segs;
+        segs.reserve( s.segments.size() );
+        j->ok = ( std::find( ids.begin(), ids.end(), -1 ) == ids.end() );
+        for (unsigned int n=0; n<s.segments.size(); ++n) {
+            int i1 = s.segments[n].first;
+            int i2 = s.segments[n].second;
+            if ( i1<0 || i2<0 || i1>=(int)ids.size() || i2>=(int)ids.size() ) {
+                j->ok = false;
+                continue;
+            }
+            segs.push_back( std::make_pair( ids[i1], ids[i2] ) );
+        }
+        std::vector<bool> inserted = j->vd->insert_line_sites( segs );
+        if ( std::find( inserted.begin(), inserted.end(), false ) != inserted.end() )
+            j->ok = false;
+    } catch (...) {
+        j->ok = false;
+    }
+    if ( j->ok && !s.offsets.empty() )
+        pool->submit( boost::bind( &DiagramBatch::offset, this, j ) );
+    else
+        finish(j);
+}
+
+/// offset task: one offset() per requested distance
+void DiagramBatch::offset(Job* j) {
+    try {
+        Offset of( j->vd->get_graph_reference() );
+        for (unsigned int n=0; n<j->sites.offsets.size(); ++n)
+            j->loops.push_back( of.offset( j->sites.offsets[n] ) );
+    } catch (...) {
+        j->ok = false;
+    }
+    finish(j);
+}
+
+/// mark the job done and wake threads in wait(h)
+void DiagramBatch::finish(Job* j) {
+    boost::mutex::scoped_lock lock(sync->mutex);
+    j->done = true;
+    sync->cv.notify_all();
+}
+
+} // end namespace
+// end file diagram_batch.cpp
@@ -0,0 +1,109 @@
+/*
+ *  Copyright (c) 2010-2012 Anders Wallin (anders.e.e.wallin "at" gmail.com).
+ *
+ *  This file is part of Openvoronoi
+ *  (see https://github.com/aewallin/openvoronoi).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <vector>
+#include <utility>
+
+#include "common/point.hpp"
+#include "offset.hpp"
+
+namespace ovd
+{
+
+class VoronoiDiagram;
+class WorkStealingPool;
+
+/// \brief the input for one diagram of a DiagramBatch
+///
+/// All points are inserted first, then the segments. A segment is a pair
+/// of indices into \a points.
+struct BatchSites {
+    BatchSites(): far(1.0), n_bins(0), validate(true) {}
+    std::vector<Point> points; ///< point-sites
+    std::vector< std::pair<int,int> > segments; ///< line-sites, as indices into points
+    /// offset distances. If not empty, offsets are produced by a follow-on task on the pool.
+    std::vector<double> offsets;
+    double far; ///< far-radius of the diagram
+    /// number of bins for the bucket-grid. 0 means sqrt(number of points)
+    unsigned int n_bins;
+    /// skip duplicate points and intersecting segments, see VoronoiDiagram::use_site_validation().
+    /// skipped sites make the job not ok().
+    bool validate;
+};
+
+/// \brief build many independent voronoi diagrams in parallel
+///
+/// Each add() queues one build task on a work-stealing thread pool and
+/// returns a handle. The diagram for a handle is ready when wait() or
+/// wait(handle) returns. Offsets, if requested in BatchSites::offsets, are
+/// computed by a second task that the build task puts on its own worker's deque.
+///
+/// Diagrams are built with set_silent(true). A diagram is owned by the
+/// batch until release() is called.
+class DiagramBatch {
+public:
+    /// handle to one diagram of the batch
+    typedef unsigned int Handle;
+
+    /// start a pool of \a n_threads workers. 0 means one per hardware thread.
+    explicit DiagramBatch(unsigned int n_threads=0);
+    virtual ~DiagramBatch();
+    /// queue a diagram for building, return its handle
+    Handle add(const BatchSites& sites);
+    /// block until all queued diagrams (and their offsets) are done
+    void wait();
+    /// block until diagram \a h (and its offsets) is done
+    void wait(Handle h);
+    /// true when diagram \a h is done
+    bool ready(Handle h);
+    /// true if all sites of diagram \a h were inserted without error
+    bool ok(Handle h);
+    /// the diagram for \a h, or null if it was released. call wait(h) first.
+    VoronoiDiagram* diagram(Handle h);
+    /// offsets of diagram \a h, one OffsetLoops per BatchSites::offsets distance. call wait(h) first.
+    const std::vector<OffsetLoops>& offsets(Handle h);
+    /// hand diagram \a h over to the caller, who must delete it. call wait(h) first.
+    VoronoiDiagram* release(Handle h);
+    /// number of handles given out
+    unsigned int size() const { return jobs.size(); }
+    /// number of worker threads
+    unsigned int num_threads() const;
+protected:
+    /// create an empty diagram. called on a worker thread.
+    virtual VoronoiDiagram* create_diagram(double far, unsigned int n_bins);
+private:
+    DiagramBatch(const DiagramBatch&); // don't copy.
+    DiagramBatch& operator=(const DiagramBatch&);
+    struct Job;
+    struct Sync;
+    void build(Job* job);
+    void offset(Job* job);
+    void finish(Job* job);
+    Job* get_job(Handle h);
+// DATA
+    std::vector<Job*> jobs; ///< one job per handle
+    WorkStealingPool* pool; ///< the worker threads
+    Sync* sync; ///< mutex and condition for the done-flags of jobs
+};
+
+} // end namespace
+// end file diagram_batch.hpp
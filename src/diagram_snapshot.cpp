@@ -0,0 +1,274 @@
+/*
+ *  Copyright (c) 2010-2012 Anders Wallin (anders.e.e.wallin "at" gmail.com).
+ *
+ *  This file is part of Openvoronoi
+ *  (see https://github.com/aewallin/openvoronoi).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cassert>
+#include <map>
+#include <algorithm>
+
+#include <boost/foreach.hpp>
+
+#include "diagram_snapshot.hpp"
+
+namespace ovd
+{
+
+namespace {
+
+/// the geometry of site \a s
+DiagramSnapshot::SiteGeometry site_geometry(Site* s) {
+    DiagramSnapshot::SiteGeometry out;
+    out.type = DiagramSnapshot::NO_SITE;
+    out.cw = false;
+    out.k = 0;
+    if (!s)
+        return out;
+    if ( s->isPoint() ) {
+        out.type = DiagramSnapshot::POINT_SITE;
+        out.start = s->position();
+        return out;
+    }
+    out.type = s->isLine() ? DiagramSnapshot::LINE_SITE : DiagramSnapshot::ARC_SITE;
+    out.start = s->start();
+    out.end = s->end();
+    out.k = s->k();
+    if ( s->isArc() ) {
+        out.center = Point( s->x(), s->y() );
+        out.cw = s->cw();
+    }
+    return out;
+}
+
+/// \brief offset walk of Offset, on a DiagramSnapshot
+///
+/// the same algorithm as Offset::offset(), with edges and faces numbered as in the snapshot.
+/// The state is local to one offset() call, so that threads can compute offsets of one snapshot.
+class SnapshotOffset {
+public:
+    SnapshotOffset(const DiagramSnapshot& snap): s(snap) {}
+    /// offset loops at distance \a t
+    OffsetLoops offset(double t) {
+        set_flags(t);
+        OffsetLoops out;
+        for (HEFace f=0; f<s.num_faces(); ++f) {
+            if ( !face_done[f] )
+                out.push_back( loop_walk(f, t) );
+        }
+        return out;
+    }
+private:
+    /// radius of the source and target vertices of \a e
+    void radii(unsigned int e, double& src_r, double& trg_r) const {
+        src_r = s.radius( s.source(e) );
+        trg_r = s.radius( s.target(e) );
+    }
+    /// face_done[f] is 0 for faces with an edge that brackets \a t, and with only valid edges
+    void set_flags(double t) {
+        face_done.assign( s.num_faces(), 1 );
+        for (HEFace f=0; f<s.num_faces(); ++f) {
+            bool valid = true;
+            for (unsigned int e=s.face_begin(f); e<s.face_end(f); ++e) {
+                double src_r, trg_r;
+                radii(e, src_r, trg_r);
+                if ( std::min(src_r,trg_r) < t && t < std::max(src_r,trg_r) )
+                    face_done[f] = 0;
+                valid = valid && s.valid(e);
+            }
+            if (!valid)
+                face_done[f] = 1;
+        }
+    }
+    /// one offset loop, starting on face \a start
+    OffsetLoop loop_walk(HEFace start, double t) {
+        unsigned int start_edge = next_offset_edge( s.face_begin(start), t, false );
+        unsigned int current = start_edge;
+        OffsetLoop loop;
+        loop.offset_distance = t;
+        loop.push_back( OffsetVertex( s.point(current, t) ) );
+        do {
+            double src_r, trg_r;
+            radii(current, src_r, trg_r);
+            assert( (src_r<t && t<trg_r) || (trg_r<t && t<src_r) );
+            unsigned int next = next_offset_edge( s.next(current), t, src_r<t && t<trg_r ); // mode of Offset::edge_mode()
+            loop.push_back( element(current, next, t) );
+            face_done[ s.face(current) ] = 1;
+            current = s.twin(next);
+            assert( current != DiagramSnapshot::NONE );
+        } while ( current != start_edge );
+        return loop;
+    }
+    /// starting at \a e, the next edge on the face with src_r < t < trg_r (or trg_r < t < src_r with \a mode)
+    unsigned int next_offset_edge(unsigned int e, double t, bool mode) const {
+        unsigned int current = e;
+        do {
+            double src_r, trg_r;
+            radii(current, src_r, trg_r);
+            if ( (!mode && src_r<t && t<trg_r) || (mode && trg_r<t && t<src_r) )
+                return current;
+            current = s.next(current);
+        } while ( current != e );
+        return e;
+    }
+    /// the offset element on the face of \a current, from edge \a current to edge \a next
+    OffsetVertex element(unsigned int current, unsigned int next, double t) const {
+        HEFace f = s.face(current);
+        const DiagramSnapshot::SiteGeometry& site = s.site(f);
+        assert( site.type != DiagramSnapshot::NO_SITE );
+        Point p1 = s.point(current, t);
+        Point p2 = s.point(next, t);
+        if ( site.type == DiagramSnapshot::LINE_SITE )
+            return OffsetVertex( p2, -1, Point(0,0), true, f );
+        Point center = ( site.type == DiagramSnapshot::POINT_SITE ) ? site.start : site.center;
+        double radius = ( site.type == DiagramSnapshot::POINT_SITE ) ? (p1-center).norm() : -1.0; // see ArcSite::offset()
+        return OffsetVertex( p2, radius, center, center.is_right(p1,p2), f );
+    }
+    const DiagramSnapshot& s; ///< the snapshot
+    std::vector<unsigned char> face_done; ///< 1 for faces that need no (more) offset
+};
+
+} // end anonymous namespace
+
+const unsigned int DiagramSnapshot::NONE;
+
+/// empty snapshot, with no vertices, edges or faces
+DiagramSnapshot::DiagramSnapshot() {
+    clear();
+}
+
+/// snapshot of graph \a g, with given version()
+DiagramSnapshot::DiagramSnapshot(HEGraph& g, unsigned int version) {
+    build(g, version);
+}
+
+/// \brief replace the snapshot with a copy of graph \a g, with given version()
+///
+/// the storage is kept for reuse. don't call this while other threads read the snapshot.
+void DiagramSnapshot::build(HEGraph& g, unsigned int version) {
+    clear();
+    ver = version;
+    std::map<HEVertex, unsigned int> vertex_id;
+    BOOST_FOREACH( HEVertex v, g.vertices() ) {
+        vertex_id[v] = vx.size();
+        vx.push_back( g[v].position.x );
+        vy.push_back( g[v].position.y );
+        vr.push_back( g[v].dist() );
+        v_type.push_back( g[v].type );
+        v_index.push_back( g[v].index );
+    }
+    
+    // half-edges in face-cycle order
+    EdgeVector order;
+    order.reserve( g.num_edges() );
+    std::map<HEEdge, unsigned int> edge_id;
+    f_begin.clear();
+    f_site.reserve( g.num_faces() );
+    for (HEFace f=0; f<g.num_faces(); ++f) {
+        f_begin.push_back( order.size() );
+        f_site.push_back( site_geometry( g[f].site ) );
+        f_null.push_back( g[f].null );
+        HEEdge start = g[f].edge;
+        HEEdge current = start;
+        do {
+            assert( g[current].face == f );
+            edge_id[current] = order.size();
+            order.push_back( current );
+            current = g[current].next;
+        } while ( current != start );
+    }
+    f_begin.push_back( order.size() );
+    assert( order.size() == g.num_edges() );
+    
+    std::map<EdgeParams*, unsigned int> param_id;
+    e_source.reserve( order.size() );
+    for (unsigned int n=0; n<order.size(); ++n) {
+        const EdgeProps& ep = g[ order[n] ];
+        e_source.push_back( vertex_id[ g.source( order[n] ) ] );
+        std::map<HEEdge, unsigned int>::const_iterator twin = edge_id.find( ep.twin );
+        e_twin.push_back( twin == edge_id.end() ? NONE : twin->second );
+        e_face.push_back( ep.face );
+        e_type.push_back( ep.type );
+        e_k.push_back( ep.k );
+        e_sign.push_back( ep.sign );
+        e_valid.push_back( ep.valid );
+        if ( !ep.params ) {
+            e_params.push_back( NONE );
+            continue;
+        }
+        std::map<EdgeParams*, unsigned int>::const_iterator it = param_id.find( ep.params.get() );
+        if ( it == param_id.end() ) {
+            it = param_id.insert( std::make_pair( ep.params.get(), params.size() ) ).first;
+            params.push_back( *ep.params );
+            params.back().refs = 0; // the copy is not reference-counted
+        }
+        e_params.push_back( it->second );
+    }
+    
+    // out-edges: count per vertex, then fill in the rows
+    v_begin.assign( vx.size()+1, 0 );
+    for (unsigned int e=0; e<e_source.size(); ++e)
+        v_begin[ e_source[e]+1 ]++;
+    for (unsigned int v=0; v<vx.size(); ++v)
+        v_begin[v+1] += v_begin[v];
+    v_out.resize( e_source.size() );
+    std::vector<unsigned int> fill( v_begin.begin(), v_begin.end()-1 );
+    for (unsigned int e=0; e<e_source.size(); ++e)
+        v_out[ fill[ e_source[e] ]++ ] = e;
+}
+
+/// \brief point on half-edge \a e at offset-distance \a t, see EdgeProps::point()
+Point DiagramSnapshot::point(unsigned int e, double t) const {
+    if ( e_params[e] == NONE )
+        return Point(0,0);
+    return params[ e_params[e] ].point( e_sign[e], t );
+}
+
+/// \brief offsets at distance \a t, the same as Offset::offset() on the diagram
+///
+/// may be called by several threads at the same time.
+OffsetLoops DiagramSnapshot::offset(double t) const {
+    SnapshotOffset walk(*this);
+    return walk.offset(t);
+}
+
+/// remove all vertices, edges and faces, keeping the storage
+void DiagramSnapshot::clear() {
+    ver = 0;
+    vx.clear();
+    vy.clear();
+    vr.clear();
+    v_type.clear();
+    v_index.clear();
+    v_begin.assign( 1, 0 );
+    v_out.clear();
+    e_source.clear();
+    e_twin.clear();
+    e_face.clear();
+    e_type.clear();
+    e_k.clear();
+    e_sign.clear();
+    e_valid.clear();
+    e_params.clear();
+    params.clear();
+    f_begin.assign( 1, 0 );
+    f_site.clear();
+    f_null.clear();
+}
+
+} // end namespace
+// end file diagram_snapshot.cpp
@@ -0,0 +1,153 @@
+/*
+ *  Copyright (c) 2010-2012 Anders Wallin (anders.e.e.wallin "at" gmail.com).
+ *
+ *  This file is part of Openvoronoi
+ *  (see https://github.com/aewallin/openvoronoi).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <vector>
+#include <utility>
+
+#include <boost/shared_ptr.hpp>
+
+#include "graph.hpp"
+#include "offset.hpp"
+
+namespace ovd
+{
+
+/// \brief immutable copy of a VoronoiDiagram in compressed-sparse-row form, see VoronoiDiagram::snapshot()
+///
+/// Vertices, half-edges and faces are numbered from zero. Vertex positions and clearance radii are
+/// stored as separate x, y and r arrays. The half-edges of face f are stored in face-cycle order
+/// at positions face_begin(f) .. face_end(f)-1, so next() is the following position, and a walk around
+/// a face reads consecutive memory. out_edges() lists the half-edges leaving each vertex, in the same
+/// row-offset form. Sites and bisector parameters are copied, so a snapshot does not refer to the
+/// diagram, and stays valid while the diagram is modified or deleted.
+///
+/// A snapshot is never modified after construction, so any number of threads can read one snapshot.
+/// See VoronoiDiagram::use_snapshot_publishing() for snapshots that are published while the diagram is built.
+class DiagramSnapshot {
+public:
+    /// type of the Site of a face
+    enum SiteType { NO_SITE, POINT_SITE, LINE_SITE, ARC_SITE };
+    /// geometry of the Site of a face
+    struct SiteGeometry {
+        SiteType type;  ///< kind of site
+        Point start;    ///< position of a point-site, or start of a line- or arc-site
+        Point end;      ///< end of a line- or arc-site
+        Point center;   ///< center of an arc-site
+        bool cw;        ///< direction of an arc-site
+        double k;       ///< offset-direction of a line- or arc-site
+    };
+    /// unsigned -1, for a missing twin
+    static const unsigned int NONE = (unsigned int)-1;
+
+    DiagramSnapshot();
+    explicit DiagramSnapshot(HEGraph& g, unsigned int version=0);
+    void build(HEGraph& g, unsigned int version=0);
+    
+    /// the number of committed changes of the diagram when the snapshot was taken, see VoronoiDiagram::num_changes()
+    unsigned int version() const { return ver; }
+    /// number of vertices
+    unsigned int num_vertices() const { return vx.size(); }
+    /// number of half-edges
+    unsigned int num_edges() const { return e_source.size(); }
+    /// number of faces
+    unsigned int num_faces() const { return f_begin.size()-1; }
+    
+    /// position of vertex \a v
+    Point position(unsigned int v) const { return Point( vx[v], vy[v] ); }
+    /// clearance-disk radius of vertex \a v
+    double radius(unsigned int v) const { return vr[v]; }
+    /// type of vertex \a v
+    VertexType vertex_type(unsigned int v) const { return v_type[v]; }
+    /// VoronoiVertex::index of vertex \a v
+    int vertex_index(unsigned int v) const { return v_index[v]; }
+    /// x-coordinates of all vertices
+    const std::vector<double>& x() const { return vx; }
+    /// y-coordinates of all vertices
+    const std::vector<double>& y() const { return vy; }
+    /// clearance-disk radii of all vertices
+    const std::vector<double>& r() const { return vr; }
+    /// the half-edges with source \a v, as a [begin, end) range
+    std::pair<const unsigned int*, const unsigned int*> out_edges(unsigned int v) const {
+        const unsigned int* base = v_out.empty() ? 0 : &v_out[0];
+        return std::make_pair( base + v_begin[v], base + v_begin[v+1] );
+    }
+    
+    /// source vertex of half-edge \a e
+    unsigned int source(unsigned int e) const { return e_source[e]; }
+    /// target vertex of half-edge \a e
+    unsigned int target(unsigned int e) const { return e_source[ next(e) ]; }
+    /// the next half-edge, counterclockwise on the face of \a e
+    unsigned int next(unsigned int e) const { 
+        return ( e+1 == f_begin[ e_face[e]+1 ] ) ? f_begin[ e_face[e] ] : e+1;
+    }
+    /// the twin of half-edge \a e, or NONE for the outermost edges
+    unsigned int twin(unsigned int e) const { return e_twin[e]; }
+    /// the face of half-edge \a e
+    HEFace face(unsigned int e) const { return e_face[e]; }
+    /// type of half-edge \a e
+    EdgeType edge_type(unsigned int e) const { return e_type[e]; }
+    /// offset-direction of half-edge \a e, see EdgeProps::k
+    double k(unsigned int e) const { return e_k[e]; }
+    /// EdgeProps::valid flag of half-edge \a e, as set by the filters when the snapshot was taken
+    bool valid(unsigned int e) const { return e_valid[e]; }
+    Point point(unsigned int e, double t) const;
+    
+    /// first half-edge of face \a f
+    unsigned int face_begin(HEFace f) const { return f_begin[f]; }
+    /// one past the last half-edge of face \a f
+    unsigned int face_end(HEFace f) const { return f_begin[f+1]; }
+    /// the site of face \a f
+    const SiteGeometry& site(HEFace f) const { return f_site[f]; }
+    /// true if \a f is a null-face
+    bool null_face(HEFace f) const { return f_null[f]; }
+    
+    OffsetLoops offset(double t) const;
+private:
+    void clear();
+    unsigned int ver;                ///< version()
+    std::vector<double> vx;          ///< vertex x-coordinates
+    std::vector<double> vy;          ///< vertex y-coordinates
+    std::vector<double> vr;          ///< vertex clearance radii
+    std::vector<VertexType> v_type;  ///< vertex types
+    std::vector<int> v_index;        ///< vertex indices in the diagram
+    std::vector<unsigned int> v_begin; ///< row offsets into v_out, one per vertex and one at the end
+    std::vector<unsigned int> v_out;   ///< out-edges, grouped by source vertex
+    
+    std::vector<unsigned int> e_source; ///< half-edge source vertices
+    std::vector<unsigned int> e_twin;   ///< half-edge twins
+    std::vector<HEFace> e_face;         ///< half-edge faces
+    std::vector<EdgeType> e_type;       ///< half-edge types
+    std::vector<double> e_k;            ///< half-edge offset-directions
+    std::vector<bool> e_sign;           ///< half-edge sqrt()-signs, see EdgeProps::sign
+    std::vector<bool> e_valid;          ///< half-edge valid-flags
+    std::vector<unsigned int> e_params; ///< index into params, or NONE
+    std::vector<EdgeParams> params;     ///< copies of the bisector parameters, one per shared record
+    
+    std::vector<unsigned int> f_begin;  ///< row offsets into the half-edge arrays, one per face and one at the end
+    std::vector<SiteGeometry> f_site;   ///< face sites
+    std::vector<bool> f_null;           ///< null-face flags
+};
+
+/// a published snapshot, shared by the readers that hold it. see VoronoiDiagram::published()
+typedef boost::shared_ptr<const DiagramSnapshot> SnapshotPtr;
+
+} // end namespace
+// end file diagram_snapshot.hpp
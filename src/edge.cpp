@@ -25,10 +25,8 @@ using namespace ovd::numeric;
 
 namespace ovd {
 
-/// create edge with zero edge-parameters
+/// create edge without edge-parameters
 EdgeProps::EdgeProps() {
-    x[0]=0;x[1]=0;x[2]=0;x[3]=0;x[4]=0;x[5]=0;x[6]=0;x[7]=0;
-    y[0]=0;y[1]=0;y[2]=0;y[3]=0;y[4]=0;y[5]=0;y[6]=0;y[7]=0;
     has_null_face = false;
     valid=true;
 }
@@ -87,6 +85,15 @@ Point EdgeProps::projection_point(Solution& sl) const {
 /// the eight-parameter formula for a point on the edge is:
 /// x = x1 - x2 - x3*t +/- x4 * sqrt( square(x5+x6*t) - square(x7+x8*t) )
 Point EdgeProps::point(double t) const {
+    if (!params)
+        return Point(0,0);
+    return params->point(sign, t);
+}
+
+/// \brief return point on the bisector at offset-distance \a t
+/// \param sign chooses the +/- branch of the sqrt(), see EdgeProps::sign
+/// \param t offset-distance
+Point EdgeParams::point(bool sign, double t) const {
     double discr1 =  chop( sq(x[4]+x[5]*t) - sq(x[6]+x[7]*t), 1e-14 );
     double discr2 =  chop( sq(y[4]+y[5]*t) - sq(y[6]+y[7]*t), 1e-14 );
     if ( (discr1 >= 0) && (discr2 >= 0) ) {
@@ -96,7 +103,10 @@ Point EdgeProps::point(double t) const {
         double yc = y[0] - y[1] - y[2]*t + nsig * y[3] * sqrt( discr2 );
         if (xc!=xc) { // test for NaN!
             std::cout << "Edge::point() ERROR: " << xc << " , " << yc << " t=" << t << "\n";
-            print_params();
+            std::cout << "x-params: ";
+            for (int m=0;m<8;m++)
+                std::cout << x[m] << " ";
+            std::cout << "sign= " << sign << "\n";
             assert(0);
             return Point(0,0);
         }
@@ -109,54 +119,59 @@ Point EdgeProps::point(double t) const {
     }
 }
 
-/// dispatch to setter functions based on type of \a s1 and \a s2
+/// dispatch to setter functions based on type of \a s1 and \a s2.
+/// the parameters are written to a new EdgeParams record, so a record shared with other edges is not modified.
+/// the two sites of a PointSite-PointSite edge are put in a fixed order, so that
+/// both half-edges of the edge get the same record, and share_parameters() can share it.
 void EdgeProps::set_parameters(Site* s1, Site* s2, bool sig) {
+    EdgeParams* par_ptr = new EdgeParams();
+    params = par_ptr;
+    EdgeParams& par = *par_ptr;
     sign = sig; // sqrt() sign for edge-parametrization
-    if (s1->isPoint() && s2->isPoint())        // PP
-        set_pp_parameters(s1,s2);
-    else if (s1->isPoint() && s2->isLine())    // PL
-        set_pl_parameters(s1,s2);
+    if (s1->isPoint() && s2->isPoint()) {      // PP
+        Point p1 = s1->position();
+        Point p2 = s2->position();
+        if ( p2.x < p1.x || ( p2.x == p1.x && p2.y < p1.y ) ) { // swapping the sites is the same as flipping the sign
+            set_pp_parameters(par,s2,s1);
+            sign = !sign;
+        } else {
+            set_pp_parameters(par,s1,s2);
+        }
+    } else if (s1->isPoint() && s2->isLine())    // PL
+        set_pl_parameters(par,s1,s2);
     else if (s2->isPoint() && s1->isLine())  {  // LP
-        set_pl_parameters(s2,s1);
+        set_pl_parameters(par,s2,s1);
         sign = !sign;
     } else if (s1->isLine() && s2->isLine())     // LL
-        set_ll_parameters(s2,s1);
+        set_ll_parameters(par,s2,s1);
     else if (s1->isPoint() && s2->isArc() ) // PA
-        set_pa_parameters(s1,s2);
+        set_pa_parameters(par,s1,s2);
     else if (s2->isPoint() && s1->isArc() ) { // AP
         sign = !sign;
-        set_pa_parameters(s2,s1);
+        set_pa_parameters(par,s2,s1);
         
     } else if (s1->isLine() && s2->isArc() ) // LA
-        set_la_parameters(s1,s2);
+        set_la_parameters(par,s1,s2);
     else if (s2->isLine() && s1->isArc() ) // AL
-        set_la_parameters(s2,s1);
+        set_la_parameters(par,s2,s1);
     else
         assert(0);
         // AA
 }
 
+/// use the EdgeParams record of \a other (normally the twin edge) if it holds the same parameters as ours.
+/// the sign is not changed, it stays per half-edge.
+void EdgeProps::share_parameters(const EdgeProps& other) {
+    if ( params && other.params && params != other.params && params->same( *other.params ) )
+        params = other.params;
+}
+
 /// assignment of edge-parameters
 EdgeProps& EdgeProps::operator=(const EdgeProps &other) {
     if (this == &other)
         return *this;
     sign = other.sign;
-    x[0] = other.x[0];
-    x[1] = other.x[1];
-    x[2] = other.x[2];
-    x[3] = other.x[3];
-    x[4] = other.x[4];
-    x[5] = other.x[5];
-    x[6] = other.x[6];        
-    x[7] = other.x[7];
-    y[0] = other.y[0];
-    y[1] = other.y[1];
-    y[2] = other.y[2];
-    y[3] = other.y[3];
-    y[4] = other.y[4];
-    y[5] = other.y[5];
-    y[6] = other.y[6];        
-    y[7] = other.y[7];
+    params = other.params; // shared, not copied
     face = other.face; 
     null_face = other.null_face;
     has_null_face = other.has_null_face;
@@ -168,7 +183,7 @@ EdgeProps& EdgeProps::operator=(const EdgeProps &other) {
 }
 
 /// set edge parameters for PointSite-PointSite edge
-void EdgeProps::set_pp_parameters(Site* s1, Site* s2) {
+void EdgeProps::set_pp_parameters(EdgeParams& par, Site* s1, Site* s2) {
     assert( s1->isPoint() && s2->isPoint() );
     double d = (s1->position() - s2->position()).norm();
     double alfa1 = (s2->x() - s1->x()) / d;
@@ -176,26 +191,26 @@ void EdgeProps::set_pp_parameters(Site* s1, Site* s2) {
     double alfa3 = -d/2;
     
     type = LINE;
-    x[0]=s1->x();       
-    x[1]=alfa1*alfa3; // 
-    x[2]=0;  
-    x[3]=-alfa2;       
-    x[4]=0;             
-    x[5]=+1;          
-    x[6]=alfa3;       
-    x[7]=0;
-    y[0]=s1->y();     
-    y[1]=alfa2*alfa3; 
-    y[2]=0; 
-    y[3]=-alfa1;       
-    y[4]=0;           
-    y[5]=+1;          
-    y[6]=alfa3;       
-    y[7]=0;
+    par.x[0]=s1->x();       
+    par.x[1]=alfa1*alfa3; // 
+    par.x[2]=0;  
+    par.x[3]=-alfa2;       
+    par.x[4]=0;             
+    par.x[5]=+1;          
+    par.x[6]=alfa3;       
+    par.x[7]=0;
+    par.y[0]=s1->y();     
+    par.y[1]=alfa2*alfa3; 
+    par.y[2]=0; 
+    par.y[3]=-alfa1;       
+    par.y[4]=0;           
+    par.y[5]=+1;          
+    par.y[6]=alfa3;       
+    par.y[7]=0;
 }
 
 /// set ::PARABOLA edge parameters (between PointSite and LineSite).
-void EdgeProps::set_pl_parameters(Site* s1, Site* s2) {
+void EdgeProps::set_pl_parameters(EdgeParams& par, Site* s1, Site* s2) {
     assert( s1->isPoint() && s2->isLine() );
     
     type = PARABOLA;
@@ -214,43 +229,46 @@ void EdgeProps::set_pl_parameters(Site* s1, Site* s2) {
     //    sign = !sign;
     //}
     
-    x[0]=s1->x();       // xc1
-    x[1]=s2->a()*alfa3; // alfa1*alfa3
-    x[2]=s2->a(); //*kk;    // -alfa1 = - a2 * k2?
-    x[3]=s2->b();       // alfa2 = b2
-    x[4]=0;             // alfa4 = r1 (PointSite has zero radius)
-    x[5]=+1;            // lambda1 (always positive offset from PointSite)
-    x[6]=alfa3;         // alfa3= a2*xc1+b2*yc1+d2?
-    x[7]=+1; //kk;            // -1 = k2 side of line??
+    par.x[0]=s1->x();       // xc1
+    par.x[1]=s2->a()*alfa3; // alfa1*alfa3
+    par.x[2]=s2->a(); //*kk;    // -alfa1 = - a2 * k2?
+    par.x[3]=s2->b();       // alfa2 = b2
+    par.x[4]=0;             // alfa4 = r1 (PointSite has zero radius)
+    par.x[5]=+1;            // lambda1 (always positive offset from PointSite)
+    par.x[6]=alfa3;         // alfa3= a2*xc1+b2*yc1+d2?
+    par.x[7]=+1; //kk;            // -1 = k2 side of line??
 
-    y[0]=s1->y();       // yc1
-    y[1]=s2->b()*alfa3; // alfa2*alfa3
-    y[2]=s2->b(); //*kk;    // -alfa2 = -b2
-    y[3]=s2->a();       // alfa1 = a2
-    y[4]=0;             // alfa4 = r1 (PointSite has zero radius)
-    y[5]=+1;            // lambda1 (always positive offset from PointSite)
-    y[6]=alfa3;         // alfa3
-    y[7]=+1; //kk;            // -1 = k2 side of line??
+    par.y[0]=s1->y();       // yc1
+    par.y[1]=s2->b()*alfa3; // alfa2*alfa3
+    par.y[2]=s2->b(); //*kk;    // -alfa2 = -b2
+    par.y[3]=s2->a();       // alfa1 = a2
+    par.y[4]=0;             // alfa4 = r1 (PointSite has zero radius)
+    par.y[5]=+1;            // lambda1 (always positive offset from PointSite)
+    par.y[6]=alfa3;         // alfa3
+    par.y[7]=+1; //kk;            // -1 = k2 side of line??
 }
 
 /// set ::SEPARATOR edge parameters
 void EdgeProps::set_sep_parameters(Point& endp, Point& p) {
+    EdgeParams* par_ptr = new EdgeParams();
+    params = par_ptr;
+    EdgeParams& par = *par_ptr;
     type = SEPARATOR;
     double dx = p.x - endp.x;
     double dy = p.y - endp.y;
     double d = (p-endp).norm();
     assert( d > 0 );
-    x[0]=endp.x;
-    x[2]=-dx/d; // negative of normalized direction from endp to p
-    y[0]=endp.y;
-    y[2]=-dy/d;
+    par.x[0]=endp.x;
+    par.x[2]=-dx/d; // negative of normalized direction from endp to p
+    par.y[0]=endp.y;
+    par.y[2]=-dy/d;
     
-    x[1]=0;x[3]=0;x[4]=0;x[5]=0;x[6]=0;x[7]=0;
-    y[1]=0;y[3]=0;y[4]=0;y[5]=0;y[6]=0;y[7]=0;
+    par.x[1]=0;par.x[3]=0;par.x[4]=0;par.x[5]=0;par.x[6]=0;par.x[7]=0;
+    par.y[1]=0;par.y[3]=0;par.y[4]=0;par.y[5]=0;par.y[6]=0;par.y[7]=0;
 }
 
 /// set edge parametrization for LineSite-LineSite edge (parallel case)
-void EdgeProps::set_ll_para_parameters(Site* s1, Site* s2) {
+void EdgeProps::set_ll_para_parameters(EdgeParams& par, Site* s1, Site* s2) {
     assert( s1->isLine() && s2->isLine() );
     type = PARA_LINELINE;
     
@@ -295,17 +313,17 @@ void EdgeProps::set_ll_para_parameters(Site* s1, Site* s2) {
     // the tangent of the bisector (as well as the two line-sites) is a vector
     // (-b , a)
 
-    x[0]=  x1;
-    x[1]= -s1->b();
-    y[0]= y1;
-    y[1]= s1->a();
+    par.x[0]=  x1;
+    par.x[1]= -s1->b();
+    par.y[0]= y1;
+    par.y[1]= s1->a();
     
-    x[2]=0;x[3]=0;x[4]=0;x[5]=0;x[6]=0;x[7]=0;
-    y[2]=0;y[3]=0;y[4]=0;y[5]=0;y[6]=0;y[7]=0;
+    par.x[2]=0;par.x[3]=0;par.x[4]=0;par.x[5]=0;par.x[6]=0;par.x[7]=0;
+    par.y[2]=0;par.y[3]=0;par.y[4]=0;par.y[5]=0;par.y[6]=0;par.y[7]=0;
 }
 
 /// set edge parametrization for LineSite-LineSite edge
-void EdgeProps::set_ll_parameters(Site* s1, Site* s2) {  // Held thesis p96
+void EdgeProps::set_ll_parameters(EdgeParams& par, Site* s1, Site* s2) {  // Held thesis p96
     assert( s1->isLine() && s2->isLine() );
     type = LINELINE;
     double delta = s1->a()*s2->b() - s1->b()*s2->a() ;
@@ -314,7 +332,7 @@ void EdgeProps::set_ll_parameters(Site* s1, Site* s2) {  // Held thesis p96
     // is numerically unstable for parallel cases
     if (std::abs(delta) <= 1024.0*std::numeric_limits<double>::epsilon())
     {
-        set_ll_para_parameters(s1,s2);
+        set_ll_para_parameters(par,s1,s2);
         return;
     }
    
@@ -326,17 +344,17 @@ void EdgeProps::set_ll_parameters(Site* s1, Site* s2) {  // Held thesis p96
     
     // point (alfa1,alfa2) is the intersection point between the line-segments
     // vector (-alfa3,-alfa4) is the direction/tangent of the bisector
-    x[0]=  alfa1;  
-    x[2]= -alfa3; 
-    y[0]=  alfa2;         
-    y[2]= -alfa4;  
+    par.x[0]=  alfa1;  
+    par.x[2]= -alfa3; 
+    par.y[0]=  alfa2;         
+    par.y[2]= -alfa4;  
 
-    x[1]=0;x[3]=0;x[4]=0;x[5]=0;x[6]=0;x[7]=0;
-    y[1]=0;y[3]=0;y[4]=0;y[5]=0;y[6]=0;y[7]=0;
+    par.x[1]=0;par.x[3]=0;par.x[4]=0;par.x[5]=0;par.x[6]=0;par.x[7]=0;
+    par.y[1]=0;par.y[3]=0;par.y[4]=0;par.y[5]=0;par.y[6]=0;par.y[7]=0;
 }
 
 /// set edge parameters when s1 is PointSite and s2 is ArcSite
-void EdgeProps::set_pa_parameters(Site* s1, Site* s2) {
+void EdgeProps::set_pa_parameters(EdgeParams& par, Site* s1, Site* s2) {
     assert( s1->isPoint() && s2->isArc() );
     //std::cout << "set_pa_parameters()\n";
     
@@ -365,29 +383,29 @@ void EdgeProps::set_pa_parameters(Site* s1, Site* s2) {
     double alfa2 = ( s2->y() - s1->y() ) / d;
     double alfa3 = ( s2->r()*s2->r() -  d*d) / (2*d);
     double alfa4 = ( lamb2 * s2->r()  ) / d;
-    x[0] = s1->x();
-    x[1] = alfa1*alfa3;
-    x[2] = alfa1*alfa4;
-    x[3] = alfa2;
-    x[4] = 0; //r1;  PointSite has zero radius
-    x[5] = +1; //lamb1; always outward offset from PointSite
-    x[6] = alfa3;
-    x[7] = alfa4;
+    par.x[0] = s1->x();
+    par.x[1] = alfa1*alfa3;
+    par.x[2] = alfa1*alfa4;
+    par.x[3] = alfa2;
+    par.x[4] = 0; //r1;  PointSite has zero radius
+    par.x[5] = +1; //lamb1; always outward offset from PointSite
+    par.x[6] = alfa3;
+    par.x[7] = alfa4;
     
-    y[0] = s1->y();
-    y[1] = alfa2*alfa3;
-    y[2] = alfa2*alfa4;
-    y[3] = alfa1;
-    y[4] = 0; //r1;     PointSite has zero radius
-    y[5] = +1; //lamb1; always outward offset from PointSite
-    y[6] = alfa3;
-    y[7] = alfa4;
+    par.y[0] = s1->y();
+    par.y[1] = alfa2*alfa3;
+    par.y[2] = alfa2*alfa4;
+    par.y[3] = alfa1;
+    par.y[4] = 0; //r1;     PointSite has zero radius
+    par.y[5] = +1; //lamb1; always outward offset from PointSite
+    par.y[6] = alfa3;
+    par.y[7] = alfa4;
     //print_params();
 }
 
 
 /// set edge parameters when s1 is ArcSite and s2 is LineSite
-void EdgeProps::set_la_parameters(Site* s1, Site* s2) { 
+void EdgeProps::set_la_parameters(EdgeParams& par, Site* s1, Site* s2) { 
     assert( s1->isLine() && s2->isArc() );
     std::cout << "set_la_parameters() sign= " << sign << " cw= " << s2->cw() << "\n";
     type = PARABOLA;
@@ -408,23 +426,23 @@ void EdgeProps::set_la_parameters(Site* s1, Site* s2) {
     //sign = false;
     // figure out sign?
     
-    x[0] = s2->x();
-    x[1] = alfa1*alfa3;
-    x[2] = alfa1*kk;
-    x[3] = alfa2;
-    x[4] = alfa4;
-    x[5] = lamb2;
-    x[6] = alfa3;
-    x[7] = kk;
+    par.x[0] = s2->x();
+    par.x[1] = alfa1*alfa3;
+    par.x[2] = alfa1*kk;
+    par.x[3] = alfa2;
+    par.x[4] = alfa4;
+    par.x[5] = lamb2;
+    par.x[6] = alfa3;
+    par.x[7] = kk;
     
-    y[0] = s2->y();
-    y[1] = alfa2*alfa3;
-    y[2] = alfa2*kk;
-    y[3] = alfa1;
-    y[4] = alfa4;
-    y[5] = lamb2;
-    y[6] = alfa3;
-    y[7] = kk;
+    par.y[0] = s2->y();
+    par.y[1] = alfa2*alfa3;
+    par.y[2] = alfa2*kk;
+    par.y[3] = alfa1;
+    par.y[4] = alfa4;
+    par.y[5] = lamb2;
+    par.y[6] = alfa3;
+    par.y[7] = kk;
     print_params();
 }
 
@@ -459,7 +477,8 @@ double EdgeProps::minimum_pp_t(Site* s1, Site* s2) {
 }
 /// minimum t-value for ::PARABOLA edge 
 double EdgeProps::minimum_pl_t(Site* , Site* ) {
-    double mint = - x[6]/(2.0*x[7]);
+    assert( params );
+    double mint = - params->x[6]/(2.0*params->x[7]);
     assert( mint >=0 );
     return mint;
 }
@@ -472,6 +491,12 @@ double EdgeProps::minimum_pa_t(Site* s1, Site* s2) {
 }
 /// print out edge parametrization
 void EdgeProps::print_params() const {
+    if (!params) {
+        std::cout << "no params, sign= " << sign << "\n";
+        return;
+    }
+    const boost::array<double,8>& x = params->x;
+    const boost::array<double,8>& y = params->y;
     std::cout << "x-params: ";
     for (int m=0;m<8;m++)
         std::cout << x[m] << " ";
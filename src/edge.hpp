@@ -23,6 +23,7 @@
 #include <cassert>
 #include <cmath>
 #include <boost/array.hpp>
+#include <boost/intrusive_ptr.hpp>
 
 #include <boost/graph/adjacency_list.hpp>
 
@@ -32,6 +33,10 @@
 
 namespace ovd {
 
+#ifdef OVD_FLAT_HEDI
+/// edge-descriptors
+typedef hedi::flat_edge_descriptor HEEdge;
+#else
 #define OUT_EDGE_CONTAINER boost::listS 
 #define VERTEX_CONTAINER boost::listS
 #define EDGE_LIST_CONTAINER boost::listS
@@ -41,6 +46,7 @@ typedef boost::adjacency_list_traits<OUT_EDGE_CONTAINER,
                                      VERTEX_CONTAINER, 
                                      boost::bidirectionalS, 
                                      EDGE_LIST_CONTAINER >::edge_descriptor HEEdge;
+#endif
 /// face descriptor                                     
 typedef unsigned int HEFace;
 
@@ -69,6 +75,28 @@ enum EdgeType {
 */
 
 
+/// \brief the eight x- and eight y-parameters of the bisector formula
+///
+/// One record is shared by both half-edges of an edge, and by the edges
+/// that split_edge() makes out of it, since these all lie on the same bisector.
+/// A record is never modified once it is shared: EdgeProps::set_parameters()
+/// always fills in a new record.
+/// The reference count is not atomic, a diagram is used by one thread at a time.
+struct EdgeParams {
+    EdgeParams(): refs(0) { x.assign(0); y.assign(0); }
+    boost::array<double,8> x; ///< 8-parameter parametrization
+    boost::array<double,8> y; ///< 8-parameter parametrization
+    unsigned int refs; ///< number of EdgeProps pointing to this record
+    /// true if all parameters are equal
+    bool same(const EdgeParams& other) const { return x == other.x && y == other.y; }
+    Point point(bool sign, double t) const;
+};
+
+/// reference counting for boost::intrusive_ptr<EdgeParams>
+inline void intrusive_ptr_add_ref(EdgeParams* p) { ++p->refs; }
+/// reference counting for boost::intrusive_ptr<EdgeParams>
+inline void intrusive_ptr_release(EdgeParams* p) { if ( --p->refs == 0 ) delete p; }
+
 /// \brief properties of an edge in the VoronoiDiagram
 ///
 /// each edge stores a pointer to the next HEEdge 
@@ -90,15 +118,16 @@ public:
     double k; ///< offset-direction from the adjacent site, either +1 or -1
     EdgeType type; ///< the type of this edge
     
-    boost::array<double,8> x; ///< 8-parameter parametrization
-    boost::array<double,8> y; ///< 8-parameter parametrization
-    bool sign; ///< flag to choose either +/- in front of sqrt()
+    /// parametrization of the bisector, shared with the twin edge. null if not set.
+    boost::intrusive_ptr<EdgeParams> params;
+    bool sign; ///< flag to choose either +/- in front of sqrt(). per half-edge.
 
     Point point(double t) const; 
     double minimum_t( Site* s1, Site* s2);
        
     void set_parameters(Site* s1, Site* s2, bool sig);
     void set_sep_parameters(Point& endp, Point& p);
+    void share_parameters(const EdgeProps& other);
     EdgeProps &operator=(const EdgeProps &p);
     bool valid; ///< flag set by Filter, for use by downstream algorithms
     bool inserted_direction; ///< true if ::LINESITE-edge inserted in this direction
@@ -108,12 +137,12 @@ private:
     double minimum_pl_t(Site* s1, Site* s2);
     double minimum_pa_t(Site* s1, Site* s2);
 
-    void set_pp_parameters(Site* s1, Site* s2);
-    void set_pl_parameters(Site* s1, Site* s2);
-    void set_ll_parameters(Site* s1, Site* s2);
-    void set_ll_para_parameters(Site* s1, Site* s2);
-    void set_pa_parameters(Site* s1, Site* s2);
-    void set_la_parameters(Site* s1, Site* s2);
+    void set_pp_parameters(EdgeParams& par, Site* s1, Site* s2);
+    void set_pl_parameters(EdgeParams& par, Site* s1, Site* s2);
+    void set_ll_parameters(EdgeParams& par, Site* s1, Site* s2);
+    void set_ll_para_parameters(EdgeParams& par, Site* s1, Site* s2);
+    void set_pa_parameters(EdgeParams& par, Site* s1, Site* s2);
+    void set_la_parameters(EdgeParams& par, Site* s1, Site* s2);
     void print_params() const;
 };
 
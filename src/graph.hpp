@@ -26,6 +26,7 @@
 
 #include "common/point.hpp"
 #include "common/halfedgediagram.hpp"
+#include "common/flat_halfedgediagram.hpp"
 #include "vertex.hpp"
 #include "site.hpp"
 #include "edge.hpp"
@@ -33,6 +34,13 @@
 // this file contains typedefs used by voronoidiagram.hpp
 namespace ovd {
 
+// The graph is either a hedi::half_edge_diagram (a boost::adjacency_list with listS containers),
+// or, when OVD_FLAT_HEDI is defined (cmake -DUSE_FLAT_HEDI=ON), a hedi::flat_half_edge_diagram
+// which stores vertices/edges in contiguous arrays with 32-bit indices.
+#ifdef OVD_FLAT_HEDI
+/// edge-descriptors in the graph
+typedef hedi::flat_edge_descriptor HEEdge;
+#else
 // vecS is slightly faster than listS
 // vecS   5.72us * n log(n)
 // listS  6.18 * n log(n)
@@ -45,6 +53,7 @@ typedef boost::adjacency_list_traits<OUT_EDGE_CONTAINER,
                                      VERTEX_CONTAINER, 
                                      boost::bidirectionalS, 
                                      EDGE_LIST_CONTAINER >::edge_descriptor HEEdge;
+#endif
                                      
 ///face-descriptors in the graph 
 // (if there were a traits-class for HEDIGraph we could use it here, instead of "hard coding" the type)
@@ -78,6 +87,17 @@ struct FaceProps {
 
 };
 
+#ifdef OVD_FLAT_HEDI
+/// the type of graph with which we construct the voronoi-diagram
+typedef hedi::flat_half_edge_diagram< VoronoiVertex, // vertex properties
+                                      EdgeProps,     // edge properties
+                                      FaceProps      // face properties
+                                      > HEGraph;
+
+typedef HEGraph::Vertex       HEVertex;       ///< vertex descriptor
+typedef HEGraph::OutEdgeItr   HEOutEdgeItr;   ///< out edge iterator
+typedef HEGraph::vertices_size_type HEVertexSize; ///< vertex size
+#else
 /// the type of graph with which we construct the voronoi-diagram
 typedef hedi::half_edge_diagram< OUT_EDGE_CONTAINER,     // out-edges storage
                        VERTEX_CONTAINER,         // vertex set stored here
@@ -97,6 +117,7 @@ typedef boost::graph_traits< HEGraph::BGLGraph >::edge_iterator      HEEdgeItr;
 typedef boost::graph_traits< HEGraph::BGLGraph >::out_edge_iterator  HEOutEdgeItr;   ///< out edge iterator
 typedef boost::graph_traits< HEGraph::BGLGraph >::adjacency_iterator HEAdjacencyItr; ///< adj iterator
 typedef boost::graph_traits< HEGraph::BGLGraph >::vertices_size_type HEVertexSize;   ///< vertex size
+#endif
 
 // these containers are used, for simplicity, instead of iterators (like in BGL) when accessing
 // adjacent vertices, edges, faces.
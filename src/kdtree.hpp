@@ -79,10 +79,16 @@ public:
     KDTree(int dim = 3) : dim_(dim), root_(0), rect_(0) {
     }
     virtual ~KDTree() {
+        clear();
+    }
+    /// remove all points from the tree
+    void clear() {
         if (rect_)
             delete rect_;
         if (root_)
             delete root_;
+        rect_ = 0;
+        root_ = 0;
     }
     /// insert given point into tree
     int insert( const point_type pos) {
@@ -102,6 +108,26 @@ public:
         kd_nearest_i( root_, pos, result, result_dist , rect);
         return std::make_pair( result->pos, true);
     }
+    /// \brief remove the point at the position of \a pos
+    /// \return false if there is no point at this position
+    bool remove( const point_type& pos ) {
+        bool found = false;
+        root_ = remove_rec( root_, pos, found );
+        return found;
+    }
+    /// \brief overwrite the point at the position of \a pos with \a pos, e.g. to change the data held with it
+    /// \return false if there is no point at this position
+    bool update( const point_type& pos ) {
+        kd_node<point_type>* node = root_;
+        while (node) {
+            if ( same_position( node->pos, pos ) ) {
+                node->pos = pos;
+                return true;
+            }
+            node = ( pos[node->dir] < node->pos[node->dir] ) ? node->left : node->right;
+        }
+        return false;
+    }
     /// for debug, return the number of function calls made during a search
     int get_num_calls() {return num_nearest_i_calls;}
     /// print output of tree
@@ -146,6 +172,63 @@ private:
             }
         }
     }
+    /// \brief recursive point-removal function
+    ///
+    /// a removed node is replaced by the minimum, in its cut-direction, of its right subtree.
+    /// if there is no right subtree, the minimum of the left subtree is used, and
+    /// the left subtree becomes the right subtree.
+    /// \return the node that replaces \a node in its parent
+    kd_node<point_type>* remove_rec( kd_node<point_type>* node, const point_type& pos, bool& found ) {
+        if (node == 0)
+            return 0;
+        int d = node->dir;
+        if ( !same_position( node->pos, pos ) ) {
+            if ( pos[d] < node->pos[d] )
+                node->left = remove_rec( node->left, pos, found );
+            else
+                node->right = remove_rec( node->right, pos, found );
+            return node;
+        }
+        found = true;
+        bool dummy;
+        if (node->right) {
+            point_type m = find_min( node->right, d )->pos;
+            node->pos = m;
+            node->right = remove_rec( node->right, m, dummy );
+        } else if (node->left) {
+            point_type m = find_min( node->left, d )->pos;
+            node->pos = m;
+            node->right = remove_rec( node->left, m, dummy );
+            node->left = 0;
+        } else {
+            delete node;
+            return 0;
+        }
+        return node;
+    }
+    /// return the node with the smallest coordinate in direction \a d
+    kd_node<point_type>* find_min( kd_node<point_type>* node, int d ) {
+        kd_node<point_type>* result = node;
+        if (node->left) {
+            kd_node<point_type>* m = find_min( node->left, d );
+            if ( m->pos[d] < result->pos[d] )
+                result = m;
+        }
+        if ( node->dir != d && node->right ) { // if the cut is in direction d, the right subtree is not smaller
+            kd_node<point_type>* m = find_min( node->right, d );
+            if ( m->pos[d] < result->pos[d] )
+                result = m;
+        }
+        return result;
+    }
+    /// true if \a p1 and \a p2 have the same coordinates
+    bool same_position( const point_type& p1, const point_type& p2 ) const {
+        for (int i=0; i < dim_; i++) {
+            if ( p1[i] != p2[i] )
+                return false;
+        }
+        return true;
+    }
     /// square
     double sq(double x) {return x*x;}
     
@@ -31,6 +31,7 @@ void Offset::print() {
 /// create offsets at offset distance \a t
 OffsetLoops Offset::offset(double t) {
     offset_list.clear();
+    ofs_arena.clear();
     set_flags(t);
     HEFace start;
     while (find_start_face(start)) // while there are faces that still require offsets
@@ -78,7 +79,7 @@ void Offset::offset_loop_walk(HEFace start, double t) {
 /// return an offset-element corresponding to the current face
 OffsetVertex Offset::offset_element_from_face(HEFace current_face, HEEdge current_edge, HEEdge next_edge, double t) {
     Site* s = g[current_face].site;
-    Ofs* o = s->offset( g[current_edge].point(t), g[next_edge].point(t) ); // ask the Site for offset-geometry here.
+    Ofs* o = s->offset( g[current_edge].point(t), g[next_edge].point(t), ofs_arena ); // ask the Site for offset-geometry here.
     bool cw(true);
     if (!s->isLine() ) // point and arc-sites produce arc-offsets, for which cw must be set.
         cw = find_cw( o->start(), o->center(), o->end() ); // figure out cw or ccw arcs?
@@ -93,6 +93,8 @@ protected:
 private:
     Offset(); // don't use.
     HEGraph& g; ///< vd-graph
+    /// offset-elements (Ofs) returned by Site::offset() are created here. cleared for each offset()
+    Arena ofs_arena;
     /// hold a 0/1 flag for each face, indicating if an offset for this face has been produced or not.
     std::vector<unsigned char> face_done;
 };
@@ -0,0 +1,115 @@
+/*
+ *  Copyright (c) 2010-2012 Anders Wallin (anders.e.e.wallin "at" gmail.com).
+ *
+ *  This file is part of Openvoronoi
+ *  (see https://github.com/aewallin/openvoronoi).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <boost/python.hpp>
+
+#include "diagram_batch.hpp"
+#include "voronoidiagram_py.hpp"
+#include "offset_py.hpp"
+
+namespace ovd {
+namespace pyovd {
+
+/// releases the python GIL for the lifetime of the object
+class release_gil {
+public:
+    release_gil() : state( PyEval_SaveThread() ) {}
+    ~release_gil() { PyEval_RestoreThread(state); }
+private:
+    PyThreadState* state; ///< saved thread-state
+};
+
+/// \brief python wrapper for DiagramBatch
+///
+/// The python lists are converted to BatchSites while holding the GIL, and
+/// every call that waits for the pool releases the GIL, so other python
+/// threads run while the whole batch is built.
+class DiagramBatch_py : public DiagramBatch {
+public:
+    /// batch with one thread per hardware thread
+    DiagramBatch_py() : DiagramBatch(0) { }
+    /// batch with \a n_threads threads
+    DiagramBatch_py(unsigned int n_threads) : DiagramBatch(n_threads) { }
+    /// queue a diagram. \a points is a list of Point, \a segments a list of (i,j) index-pairs into points
+    Handle add2(boost::python::list points, boost::python::list segments) {
+        return add_py(points, segments, boost::python::list(), 1.0, 0);
+    }
+    /// queue a diagram, with offsets at each distance in the list \a offsets
+    Handle add3(boost::python::list points, boost::python::list segments, boost::python::list offsets) {
+        return add_py(points, segments, offsets, 1.0, 0);
+    }
+    /// queue a diagram with given far-radius and number of bins
+    Handle add_py(boost::python::list points, boost::python::list segments, boost::python::list offsets,
+                  double far, unsigned int n_bins) {
+        BatchSites s;
+        s.far = far;
+        s.n_bins = n_bins;
+        for (int n=0; n<boost::python::len(points); ++n)
+            s.points.push_back( boost::python::extract<Point>( points[n] ) );
+        for (int n=0; n<boost::python::len(segments); ++n) {
+            boost::python::object seg = segments[n];
+            s.segments.push_back( std::make_pair( (int)boost::python::extract<int>( seg[0] ),
+                                                  (int)boost::python::extract<int>( seg[1] ) ) );
+        }
+        for (int n=0; n<boost::python::len(offsets); ++n)
+            s.offsets.push_back( boost::python::extract<double>( offsets[n] ) );
+        return add(s);
+    }
+    /// wait for all diagrams, without the GIL
+    void wait_all() {
+        release_gil nogil;
+        wait();
+    }
+    /// wait for diagram \a h, without the GIL
+    void wait_one(Handle h) {
+        release_gil nogil;
+        wait(h);
+    }
+    /// true if the line-sites of diagram \a h were inserted without error
+    bool ok_py(Handle h) {
+        wait_one(h);
+        return ok(h);
+    }
+    /// the diagram for \a h. it is owned by the batch.
+    VoronoiDiagram* diagram_py(Handle h) {
+        wait_one(h);
+        return diagram(h);
+    }
+    /// offsets of diagram \a h, one list of loops per requested offset distance
+    boost::python::list offsets_py(Handle h) {
+        wait_one(h);
+        boost::python::list out;
+        const std::vector<OffsetLoops>& loops = offsets(h);
+        for (unsigned int n=0; n<loops.size(); ++n)
+            out.append( offset_loops_py( loops[n] ) );
+        return out;
+    }
+protected:
+    /// diagrams are VoronoiDiagram_py, so that diagram() has the python interface
+    virtual VoronoiDiagram* create_diagram(double far, unsigned int n_bins) {
+        return new VoronoiDiagram_py(far, n_bins);
+    }
+};
+
+} // pyovd
+} // end ovd namespace
+// end diagram_batch_py.hpp
@@ -26,6 +26,37 @@
 namespace ovd {
 namespace pyovd {
     
+/// convert offset loops to a python-list of loops.
+/// each loop is a list of [position, radius, center, cw, face, offset_distance] lists,
+/// except the first element which is [position, -1, offset_distance]
+inline boost::python::list offset_loops_py(const OffsetLoops& loops) {
+    boost::python::list py_offsets;
+    BOOST_FOREACH( OffsetLoop loop, loops ) { // loop through each loop
+        boost::python::list py_loop;
+        bool first = true;
+        BOOST_FOREACH( OffsetVertex lpt, loop.vertices ) { //loop through each line/arc
+            boost::python::list py_lpt;
+            double offset_distance = loop.offset_distance;
+            if (first) {
+                first = false;
+                py_lpt.append( lpt.p );
+                py_lpt.append( -1 );
+                py_lpt.append( offset_distance ); // 2
+            } else {
+                py_lpt.append( lpt.p ); // 0, position
+                py_lpt.append( lpt.r ); // 1, radius
+                py_lpt.append( lpt.c ); // 2, center
+                py_lpt.append( lpt.cw ); // 3, cw or ccw
+                py_lpt.append( lpt.f ); // 4, face
+                py_lpt.append( offset_distance ); // 5
+            }
+            py_loop.append( py_lpt );
+        }
+        py_offsets.append( py_loop );
+    }
+    return py_offsets;
+}
+
 /// \brief python wrapper for Offset
 class Offset_py : public Offset {
 public:
@@ -35,31 +66,7 @@ public:
     /// return list of offsets at given offset distance \a t
     boost::python::list offset_py(double t) {
         offset(t);
-        boost::python::list py_offsets;
-        BOOST_FOREACH( OffsetLoop loop, offset_list ) { // loop through each loop
-            boost::python::list py_loop;
-            bool first = true;
-            BOOST_FOREACH( OffsetVertex lpt, loop.vertices ) { //loop through each line/arc
-                boost::python::list py_lpt;
-                double offset_distance = loop.offset_distance;
-                if (first) {
-                    first = false;
-                    py_lpt.append( lpt.p );
-                    py_lpt.append( -1 );
-                    py_lpt.append( offset_distance ); // 2
-                } else {
-                    py_lpt.append( lpt.p ); // 0, position
-                    py_lpt.append( lpt.r ); // 1, radius
-                    py_lpt.append( lpt.c ); // 2, center
-                    py_lpt.append( lpt.cw ); // 3, cw or ccw
-                    py_lpt.append( lpt.f ); // 4, face
-                    py_lpt.append( offset_distance ); // 5
-                }
-                py_loop.append( py_lpt );
-            }
-            py_offsets.append( py_loop );
-        }
-        return py_offsets;
+        return offset_loops_py(offset_list);
     }
     /// return a python-list of OffsetLoop objects
     boost::python::list offset_loop_list(double t) {
@@ -25,6 +25,8 @@
 #include "medial_axis_walk_py.hpp"
 #include "offset_py.hpp"
 #include "offset_sorter_py.hpp"
+#include "diagram_batch_py.hpp"
+#include "site_validator_py.hpp"
 
 #include "utility/vd2svg.hpp"
 #include "version.hpp"
@@ -61,8 +63,12 @@ BOOST_PYTHON_MODULE(openvoronoi) {
     bp::class_< VoronoiDiagram_py, boost::noncopyable, bp::bases<VoronoiDiagram> >("VoronoiDiagram", bp::no_init)
         .def(bp::init<double, unsigned int>())
         .def("addVertexSite",  &VoronoiDiagram_py::insert_point_site1 ) // (point)
+        .def("addVertexSites",  &VoronoiDiagram_py::insert_point_sites_py ) // (list of points), returns list of handles
+        .def("removeVertexSite",  &VoronoiDiagram_py::remove_point_site ) // (handle), returns bool
         //.def("addVertexSite",  &VoronoiDiagram_py::insert_point_site2 ) // (point, step)
         .def("addLineSite",  &VoronoiDiagram_py::insert_line_site2 ) // takes two arguments
+        .def("addLineSites",  &VoronoiDiagram_py::insert_line_sites_py ) // (list of (idx1,idx2)), returns list of True/False
+        .def("addPolyline",  &VoronoiDiagram_py::insert_polyline_py ) // (list of idx, closed), returns True/False
         .def("addLineSite",  &VoronoiDiagram_py::insert_line_site3 ) // takes three arguments (idx1, idx2, step)
         .def("addArcSite",  &VoronoiDiagram_py::insert_arc_site ) // arc-site (idx1,idx2, center, cw?, step) 
         .def("addArcSite",  &VoronoiDiagram_py::insert_arc_site4 ) // arc-site (idx1,idx2, center, cw?, step) 
@@ -87,12 +93,20 @@ BOOST_PYTHON_MODULE(openvoronoi) {
         .def("debug_on", &VoronoiDiagram_py::debug_on)
         .def("set_silent", &VoronoiDiagram_py::set_silent)
         .def("check", &VoronoiDiagram_py::check)
-        .staticmethod("reset_vertex_count")
+        .def("reset", &VoronoiDiagram_py::reset)
+        .def("useFaceGrid", &VoronoiDiagram_py::use_face_grid)
+        .def("useJumpAndWalk", &VoronoiDiagram_py::use_jump_and_walk1)
+        .def("useJumpAndWalk", &VoronoiDiagram_py::use_jump_and_walk)
+        .def("useSiteValidation", &VoronoiDiagram_py::use_site_validation)
+        .def("useRollback", &VoronoiDiagram_py::use_rollback)
+        .def("solverTierCount", &VoronoiDiagram_py::solver_tier_count)
+        .def("resetSolverTierCounts", &VoronoiDiagram_py::reset_solver_tier_counts)
         .def("getStat", &VoronoiDiagram_py::getStat)
         .def("filterReset", &VoronoiDiagram_py::filter_reset)
         .def("filter_graph", &VoronoiDiagram_py::filter) // "filter" is a built-in function in Python!
         .def("getFaceStats", &VoronoiDiagram_py::getFaceStats)
         .def("getGraph", &VoronoiDiagram_py::get_graph_reference, bp::return_value_policy<bp::reference_existing_object>())
+        .def_pickle(voronoidiagram_pickle_suite())
     ;
     
     bp::enum_<VertexStatus>("VertexStatus")
@@ -163,6 +177,34 @@ BOOST_PYTHON_MODULE(openvoronoi) {
         .def("get_loops", &OffsetSorter_py::offset_list_py )
     ;  
   
+// Batch of diagrams built on a thread pool
+    bp::class_<DiagramBatch_py, boost::noncopyable >("DiagramBatch", bp::no_init)
+        .def(bp::init<>())
+        .def(bp::init<unsigned int>())
+        .def("add", &DiagramBatch_py::add2 ) // (points, segments)
+        .def("add", &DiagramBatch_py::add3 ) // (points, segments, offsets)
+        .def("add", &DiagramBatch_py::add_py ) // (points, segments, offsets, far, n_bins)
+        .def("wait", &DiagramBatch_py::wait_all )
+        .def("wait", &DiagramBatch_py::wait_one )
+        .def("ready", &DiagramBatch_py::ready )
+        .def("ok", &DiagramBatch_py::ok_py )
+        .def("diagram", &DiagramBatch_py::diagram_py, bp::return_internal_reference<>() )
+        .def("offsets", &DiagramBatch_py::offsets_py )
+        .def("size", &DiagramBatch_py::size )
+        .def("numThreads", &DiagramBatch_py::num_threads )
+    ;
+  
+// Validation of input sites
+    bp::enum_<SiteConflict::Type>("SiteConflictType")
+        .value("DUPLICATE_POINT", SiteConflict::DUPLICATE_POINT)
+        .value("INTERSECTION", SiteConflict::INTERSECTION)
+        .value("BAD_SEGMENT", SiteConflict::BAD_SEGMENT)
+    ;
+    bp::class_<SiteValidator_py>("SiteValidator")
+        .def(bp::init<double>())
+        .def("validate", &SiteValidator_py::validate_py ) // (points, segments), returns list of (type, i, j)
+    ;
+
 // Filters
     bp::class_< Filter, boost::noncopyable >(" Filter_base", bp::no_init) // pure virtual base class!
     ;
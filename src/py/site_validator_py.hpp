@@ -0,0 +1,59 @@
+/*
+ *  Copyright (c) 2010-2012 Anders Wallin (anders.e.e.wallin "at" gmail.com).
+ *
+ *  This file is part of Openvoronoi
+ *  (see https://github.com/aewallin/openvoronoi).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <boost/python.hpp>
+
+#include "site_validator.hpp"
+
+namespace ovd {
+namespace pyovd {
+
+/// \brief python wrapper for SiteValidator
+class SiteValidator_py : public SiteValidator {
+public:
+    /// validator for identical points
+    SiteValidator_py() : SiteValidator(0.0) {}
+    /// points closer than \a tol are duplicates
+    SiteValidator_py(double tol) : SiteValidator(tol) {}
+    /// \a points is a list of Point, \a segments a list of (i,j) index-pairs into points.
+    /// returns a list of (SiteConflictType, i, j) tuples
+    boost::python::list validate_py(boost::python::list points, boost::python::list segments) const {
+        std::vector<Point> pts;
+        for (int n=0; n<boost::python::len(points); ++n)
+            pts.push_back( boost::python::extract<Point>( points[n] ) );
+        std::vector< std::pair<int,int> > segs;
+        for (int n=0; n<boost::python::len(segments); ++n) {
+            boost::python::object seg = segments[n];
+            segs.push_back( std::make_pair( (int)boost::python::extract<int>( seg[0] ),
+                                            (int)boost::python::extract<int>( seg[1] ) ) );
+        }
+        boost::python::list out;
+        std::vector<SiteConflict> conflicts = validate(pts, segs);
+        for (unsigned int n=0; n<conflicts.size(); ++n)
+            out.append( boost::python::make_tuple( conflicts[n].type, conflicts[n].first, conflicts[n].second ) );
+        return out;
+    }
+};
+
+} // pyovd
+} // end ovd namespace
+// end site_validator_py.hpp
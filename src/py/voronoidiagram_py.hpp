@@ -20,6 +20,9 @@
 
 #pragma once
 
+#include <string>
+#include <sstream>
+
 #include "voronoidiagram.hpp"
 #include "vertex.hpp"
 
@@ -38,6 +41,18 @@ struct point_pickle_suite : boost::python::pickle_suite {
     }
 };
 
+class VoronoiDiagram_py;
+
+/// \brief pickle support for VoronoiDiagram
+///
+/// the state is the binary archive of VoronoiDiagram::save(). use_jump_and_walk(), use_site_validation()
+/// and use_rollback() are not stored.
+struct voronoidiagram_pickle_suite : boost::python::pickle_suite {
+    static boost::python::tuple getinitargs(VoronoiDiagram_py const& vd);
+    static boost::python::tuple getstate(VoronoiDiagram_py& vd);
+    static void setstate(VoronoiDiagram_py& vd, boost::python::tuple state);
+};
+
 /// \brief python wrapper for VoronoiDiagram
 class VoronoiDiagram_py : public VoronoiDiagram {
 public:
@@ -51,6 +66,43 @@ public:
     int insert_point_site1(const Point& p) {
         return insert_point_site(p);
     }
+    /// insert a python-list of points, return a list of handles in the same order
+    boost::python::list insert_point_sites_py(const boost::python::list& points) {
+        std::vector<Point> pts;
+        for (int n=0; n<boost::python::len(points); ++n)
+            pts.push_back( boost::python::extract<Point>( points[n] ) );
+        std::vector<int> ids = insert_point_sites(pts);
+        boost::python::list out;
+        BOOST_FOREACH( int id, ids ) {
+            out.append( id );
+        }
+        return out;
+    }
+    /// insert a python-list of (idx1,idx2) segments, return a list of True/False in the same order
+    boost::python::list insert_line_sites_py(const boost::python::list& segments) {
+        std::vector< std::pair<int,int> > segs;
+        for (int n=0; n<boost::python::len(segments); ++n) {
+            boost::python::object seg = segments[n];
+            segs.push_back( std::make_pair( (int)boost::python::extract<int>( seg[0] ),
+                                            (int)boost::python::extract<int>( seg[1] ) ) );
+        }
+        std::vector<bool> ok = insert_line_sites(segs);
+        boost::python::list out;
+        for (unsigned int n=0; n<ok.size(); ++n)
+            out.append( (bool)ok[n] );
+        return out;
+    }
+    /// insert the segments of a polyline, given as a list of point-site handles
+    bool insert_polyline_py(const boost::python::list& handles, bool closed) {
+        std::vector<int> ids;
+        for (int n=0; n<boost::python::len(handles); ++n)
+            ids.push_back( boost::python::extract<int>( handles[n] ) );
+        return insert_polyline(ids, closed);
+    }
+    /// jump-and-walk point location on/off, with default max_steps
+    void use_jump_and_walk1(bool b) {
+        use_jump_and_walk(b);
+    }
     /// 2-parameter point-insert
     //int insert_point_site2(const Point& p, int step) {
     //    return insert_point_site(p,step);
@@ -380,6 +432,25 @@ public:
     }
     /// set number of edge points for parabolic edges
     void set_edge_points(int n) { _edge_points=n; }
+    /// the n_bins constructor argument that gives the search-structure of this diagram
+    unsigned int get_n_bins() const { return using_face_grid() ? n_bins : 0; }
+    /// the diagram, in the binary format of save(), and the drawing settings
+    boost::python::tuple get_state() {
+        std::ostringstream out;
+        save(out);
+        std::string buf = out.str();
+        return boost::python::make_tuple( boost::python::str( buf.data(), buf.size() ), _edge_points, null_edge_offset );
+    }
+    /// restore the diagram and drawing settings from get_state()
+    void set_state(boost::python::tuple state) {
+        std::string buf = boost::python::extract<std::string>( state[0] );
+        if ( !load( buf.data(), buf.size() ) ) {
+            PyErr_SetString(PyExc_ValueError, "invalid VoronoiDiagram state");
+            boost::python::throw_error_already_set();
+        }
+        _edge_points = boost::python::extract<int>( state[1] );
+        null_edge_offset = boost::python::extract<double>( state[2] );
+    }
 
     /// count edges, counting apex-split edges as one
     unsigned int num_face_edges( HEFace f) {
@@ -422,6 +493,19 @@ private:
     double null_edge_offset;
 };
 
+/// the far-radius and number of bins of \a vd
+inline boost::python::tuple voronoidiagram_pickle_suite::getinitargs(VoronoiDiagram_py const& vd) {
+    return boost::python::make_tuple( vd.get_far_radius(), vd.get_n_bins() );
+}
+/// the archive of \a vd
+inline boost::python::tuple voronoidiagram_pickle_suite::getstate(VoronoiDiagram_py& vd) {
+    return vd.get_state();
+}
+/// load the archive into \a vd
+inline void voronoidiagram_pickle_suite::setstate(VoronoiDiagram_py& vd, boost::python::tuple state) {
+    vd.set_state(state);
+}
+
 } // pyovd
 } // end ovd namespace
 // end voronoidiagram_py.h
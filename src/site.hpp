@@ -85,12 +85,22 @@
 
 #include <qd/qd_real.h> 
 #include <sstream>
+#include <limits>
 
 #include "common/point.hpp"
 #include "common/numeric.hpp"
+#include "common/arena.hpp"
+#ifdef OVD_FLAT_HEDI
+#include "common/flat_halfedgediagram.hpp"
+#endif
 
 namespace ovd {
 
+#ifdef OVD_FLAT_HEDI
+// flat index-based graph, see common/flat_halfedgediagram.hpp
+typedef hedi::flat_edge_descriptor HEEdge;
+typedef hedi::flat_vertex_descriptor HEVertex;
+#else
 #define OUT_EDGE_CONTAINER boost::listS 
 #define VERTEX_CONTAINER boost::listS
 #define EDGE_LIST_CONTAINER boost::listS
@@ -105,6 +115,7 @@ typedef boost::adjacency_list_traits<OUT_EDGE_CONTAINER,
                                      VERTEX_CONTAINER, 
                                      boost::bidirectionalS, 
                                      EDGE_LIST_CONTAINER >::vertex_descriptor HEVertex;                                     
+#endif
 
 /// \brief Offset equation parameters of a Site
 ///
@@ -235,107 +246,246 @@ protected:
     double r;     ///< radius
 };
 
-/// Base-class for a voronoi-diagram site, or generator.
+/// \brief geometry of a Site, as a fixed-size record tagged with the kind of site
+///
+/// All kinds of Site store their geometry in the same record, so that the per-site
+/// queries (apex_point(), in_region(), offset(), ...) are a switch on \a type, and
+/// not a virtual call. Sites are created in the VoronoiDiagram site-arena, so the records
+/// of one diagram lie together in a few memory blocks.
+struct SiteRecord {
+    /// kind of site
+    enum Type { POINT, LINE, ARC };
+    Type type;  ///< kind of site
+    Point p1;   ///< position of a point-site, start of a line- or arc-site
+    Point p2;   ///< end of a line- or arc-site
+    Point c;    ///< center of an arc-site
+    double r;   ///< radius of an arc-site
+    bool cw;    ///< true for a CW arc-site
+};
+
+/// in_region_t() values within this distance from 0 or 1 are rounded to 0 or 1
+inline double site_region_eps() { return 1e-7; }
+
+/// \brief the t-value of \a p along site \a s, without rounding
+///
+/// projection of \a p onto the segment of a line-site, or the diangle of \a p between
+/// the start and end of an arc-site. -1 for a point-site.
+inline double in_region_t_raw(const SiteRecord& s, const Point& p) {
+    switch (s.type) {
+        case SiteRecord::LINE: {
+            Point s_p = p-s.p1;
+            Point s_e = s.p2 - s.p1;
+            return s_p.dot(s_e) / s_e.dot(s_e);
+        }
+        case SiteRecord::ARC: {
+            Point cen_start = s.p1 - s.c;
+            Point cen_end   = s.p2 - s.c;
+            Point cen_pt = p - s.c;
+            double diangle_min,diangle_max;
+            if (!s.cw) {
+                diangle_min = numeric::diangle( cen_start.x, cen_start.y );
+                diangle_max = numeric::diangle( cen_end.x, cen_end.y );
+            } else {
+                diangle_max = numeric::diangle( cen_start.x, cen_start.y );
+                diangle_min = numeric::diangle( cen_end.x, cen_end.y );
+            }
+            double diangle_pt = numeric::diangle(cen_pt.x, cen_pt.y);
+            return (diangle_pt - diangle_min) / (diangle_max-diangle_min);
+        }
+        default:
+            return -1;
+    }
+}
+
+/// the t-value of \a p along site \a s, see in_region_t_raw(). values near 0 and 1 are rounded.
+inline double in_region_t(const SiteRecord& s, const Point& p) {
+    if (s.type == SiteRecord::POINT)
+        return -1;
+    double t = in_region_t_raw(s, p);
+    double eps = site_region_eps();
+    if (fabs(t) < eps)  // rounding... UGLY
+        t = 0.0;
+    else if ( fabs(t-1.0) < eps )
+        t = 1.0;
+    return t;
+}
+
+/// \brief true if \a p is in the region of site \a s
+///
+/// everywhere for a point-site. For a line-site, the projection of \a p onto the line
+/// falls on the segment, i.e. 0 <= in_region_t(p) <= 1.
+/// The line test is done without division, as -eps*den < num < (1+eps)*den, where
+/// t=num/den. The double result is used if num is further than a static error
+/// bound from the thresholds, otherwise num and den are recomputed in qd_real.
+inline bool in_region(const SiteRecord& s, const Point& p) {
+    switch (s.type) {
+        case SiteRecord::LINE: {
+            const double eps = site_region_eps();
+            Point s_p = p-s.p1;
+            Point s_e = s.p2 - s.p1;
+            double num = s_p.dot(s_e);
+            double den = s_e.dot(s_e);
+            double bound = 4.0*std::numeric_limits<double>::epsilon()*
+                           ( fabs(s_p.x*s_e.x) + fabs(s_p.y*s_e.y) + den );
+            double lo = -eps*den;
+            double hi = (1+eps)*den;
+            if ( (num - lo > bound) && (hi - num > bound) )
+                return true;
+            if ( (lo - num > bound) || (num - hi > bound) )
+                return false;
+            // too close to call in double
+            qd_real qspx = qd_real(p.x) - s.p1.x;
+            qd_real qspy = qd_real(p.y) - s.p1.y;
+            qd_real qsex = qd_real(s.p2.x) - s.p1.x;
+            qd_real qsey = qd_real(s.p2.y) - s.p1.y;
+            qd_real qnum = qspx*qsex + qspy*qsey;
+            qd_real qden = qsex*qsex + qsey*qsey;
+            return ( (qnum > -eps*qden) && (qnum < (1+eps)*qden) );
+        }
+        case SiteRecord::ARC: {
+            if (p==s.c)
+                return true;
+            double t = in_region_t(s, p);
+            return ( (t>=0) && (t<=1) );
+        }
+        default:
+            return true;
+    }
+}
+
+/// \brief the closest point on site \a s to \a p
+///
+/// for a line-site, the projection onto the segment or one endpoint of the segment.
+/// for an arc-site, the projection onto the arc or the closer endpoint of the arc.
+inline Point apex_point(const SiteRecord& s, const Point& p) {
+    switch (s.type) {
+        case SiteRecord::LINE: {
+            Point s_p = p-s.p1;
+            Point s_e = s.p2 - s.p1;
+            double t = s_p.dot(s_e) / s_e.dot(s_e);
+            if (t<0)
+                return s.p1;
+            if (t>1)
+                return s.p2;
+            return s.p1 + t*(s.p2-s.p1);
+        }
+        case SiteRecord::ARC: {
+            if ( in_region(s, p) ) {
+                if ( p == s.c )
+                    return s.p1;
+                Point dir = (p-s.c);
+                dir.normalize();
+                return s.c + s.r*dir; // this point should lie on the arc
+            }
+            return ( (s.p1-p).norm() < (s.p2-p).norm() ) ? s.p1 : s.p2;
+        }
+        default:
+            return s.p1;
+    }
+}
+
+/// offset-element of site \a s from \a p1 to \a p2, created in \a arena
+inline Ofs* offset(const SiteRecord& s, Point p1, Point p2, Arena& arena) {
+    switch (s.type) {
+        case SiteRecord::LINE:
+            return arena.create<LineOfs>(p1, p2);
+        case SiteRecord::ARC:
+            return arena.create<ArcOfs>(p1, p2, s.c, -1.0); //FIXME: radius
+        default:
+            return arena.create<ArcOfs>(p1, p2, s.p1, (p1-s.p1).norm());
+    }
+}
+
+/// \brief Base-class for a voronoi-diagram site, or generator.
+///
+/// The geometry is held in a SiteRecord, and the queries below are non-virtual
+/// views of it. Only the string output and the vertex()/edge() handles are virtual.
 class Site {
 public:
     /// ctor
     Site() {}
     /// dtor
     virtual ~Site() {}
+    /// the geometry of this site
+    const SiteRecord& record() const {return rec;}
     /// return closest point on site to given point p
-    virtual Point apex_point(const Point& p) = 0;
-    /// return offset of site
-    virtual Ofs* offset(Point, Point) = 0;
+    Point apex_point(const Point& p) const {return ovd::apex_point(rec, p);}
+    /// return offset of site, created in the given Arena
+    Ofs* offset(Point p1, Point p2, Arena& arena) const {return ovd::offset(rec, p1, p2, arena);}
     /// position of site for PointSite
-    inline virtual const Point position() const {assert(0); return Point(0,0);}
+    const Point position() const {assert( isPoint() ); return rec.p1;}
     /// start point of site (for LineSite and ArcSite)
-    virtual const Point start() const {assert(0); return Point(0,0);}
+    const Point start() const {assert( !isPoint() ); return rec.p1;}
     /// end point of site (for LineSite and ArcSite)
-    virtual const Point end() const {assert(0); return Point(0,0);}
+    const Point end() const {assert( !isPoint() ); return rec.p2;}
     /// return equation parameters
-    Eq<double> eqp() {return eq;} 
-    /// return equation parameters
-    Eq<double> eqp(double kk) {
-        Eq<double> eq2(eq);
-        eq2.k *= kk;
-        return eq2;
+    const Eq<double>& eqp() const {return eq;} 
+    /// return equation parameters for offset direction \a kk, which is +1 or -1
+    const Eq<double>& eqp(double kk) const {
+        assert( kk == 1 || kk == -1 );
+        return eq_k[ kk > 0 ? 0 : 1 ];
     } 
-    /// return equation parameters
-    Eq<qd_real> eqp_qd(double kk) const {
-        Eq<qd_real> eq2;
-        eq2=eq;
-        eq2.k *= kk;
-        return eq2;
+    /// return equation parameters for offset direction \a kk in qd_real, see eqp()
+    const Eq<qd_real>& eqp_qd(double kk) const {
+        assert( kk == 1 || kk == -1 );
+        return eq_qd[ kk > 0 ? 0 : 1 ];
     }
     /// true for LineSite
-    bool is_linear() {return isLine(); }
+    bool is_linear() const {return isLine(); }
     /// true for PointSite and ArcSite
-    bool is_quadratic() {return isPoint();}
-    /// x position
-    virtual double x() const {
-        std::cout << " WARNING: never call Site !\n";
-        assert(0); 
-        return 0;
+    bool is_quadratic() const {return isPoint();}
+    /// x position of PointSite, or center of ArcSite
+    double x() const {
+        assert( !isLine() );
+        return isPoint() ? rec.p1.x : rec.c.x;
     }
-    /// y position
-    virtual double y() const {
-        std::cout << " WARNING: never call Site !\n";
-        assert(0); 
-        return 0;
+    /// y position of PointSite, or center of ArcSite
+    double y() const {
+        assert( !isLine() );
+        return isPoint() ? rec.p1.y : rec.c.y;
     }
     /// radius (zero for PointSite)
-    virtual double r() const {
-        std::cout << " WARNING: never call Site !\n";
-        assert(0); 
-        return 0;
+    double r() const {
+        assert( !isLine() );
+        return isPoint() ? 0 : rec.r;
     }
     /// offset direction
-    virtual double k() const {
-        std::cout << " WARNING: never call Site !\n";
-        assert(0); 
-        return 0;
+    double k() const {
+        switch (rec.type) {
+            case SiteRecord::LINE:
+                assert( eq.k==1 || eq.k==-1 );
+                return eq.k;
+            case SiteRecord::ARC:
+                return 1;
+            default:
+                return 0;
+        }
     }
     /// LineSite a parameter
-    virtual double a() const {
-        std::cout << " WARNING: never call Site !\n";
-        assert(0); 
-        return 0;
-    }
+    double a() const {assert( isLine() ); return eq.a;}
     /// LineSite b parameter
-    virtual double b() const {
-        std::cout << " WARNING: never call Site !\n";
-        assert(0); 
-        return 0;
-    }
+    double b() const {assert( isLine() ); return eq.b;}
     /// LineSite c parameter
-    virtual double c() const {
-        std::cout << " WARNING: never call Site !\n";
-        assert(0); 
-        return 0;
-    }
+    double c() const {assert( isLine() ); return eq.c;}
 
     /// string output
-    virtual std::string str() const =0; //{assert(0); return "Site";}
+    virtual std::string str() const =0;
     /// alternative string output
-    virtual std::string str2() const =0; //{assert(0); return "Site";}
+    virtual std::string str2() const =0;
     /// true for PointSite
-    inline virtual bool isPoint() const { return false;}
+    bool isPoint() const {return rec.type == SiteRecord::POINT;}
     /// true for LineSite
-    inline virtual bool isLine() const  { return false;}
+    bool isLine() const {return rec.type == SiteRecord::LINE;}
     /// true for ArcSite
-    inline virtual bool isArc() const  { return false;}
+    bool isArc() const {return rec.type == SiteRecord::ARC;}
     /// true for CW oriented ArcSite
-    virtual bool cw() {return false;}
+    bool cw() const {return rec.cw;}
     /// is given Point in_region ?
-    virtual bool in_region(const Point& ) const =0; 
-    /*{
-        std::cout << " WARNING: never call Site !\n";
-        return false;
-    }*/
-    /// is given Point in region?
-    virtual double in_region_t(const Point& ) const { std::cout << " WARNING: never call Site !\n"; return 0; } 
-    /// in-region t-valye
-    virtual double in_region_t_raw(const Point&) const { assert(0); return -99; }
+    bool in_region(const Point& p) const {return ovd::in_region(rec, p);}
+    /// in-region t-value, rounded near 0 and 1. -1 for PointSite
+    double in_region_t(const Point& p) const {return ovd::in_region_t(rec, p);}
+    /// in-region t-value
+    double in_region_t_raw(const Point& p) const {return ovd::in_region_t_raw(rec, p);}
     /// return edge (if this is a LineSite or ArcSite
     virtual HEEdge edge() {return HEEdge();}
     /// return vertex, if this is a PointSite
@@ -349,69 +499,83 @@ public:
     /// the HEFace of this Site
     HEFace face;
 protected:
+    /// \brief fill the equation caches from eq
+    ///
+    /// called at the end of each constructor. The solvers read the equations of a site
+    /// many times over the life of a diagram, so the k=+1 and k=-1 equations are built
+    /// here once, and in qd_real as well as in double.
+    void cache_equations() {
+        for (int n=0; n<2; n++) {
+            eq_k[n] = eq;
+            eq_k[n].k *= ( n==0 ? 1 : -1 );
+            eq_qd[n] = eq_k[n];
+        }
+    }
     /// equation parameters
     Eq<double> eq;
+    /// eq for k=+1 and k=-1, see eqp()
+    Eq<double> eq_k[2];
+    /// eq_k in qd_real, see eqp_qd()
+    Eq<qd_real> eq_qd[2];
+    /// geometry
+    SiteRecord rec;
 };
 
 /// vertex Site
 class PointSite : public Site {
 public:
     /// ctor
-    PointSite( const Point& p, HEFace f=0): _p(p)  {
+    PointSite( const Point& p, HEFace f=0) {
         face = f;
-        eq.q = true;
-        eq.a = -2*p.x;
-        eq.b = -2*p.y;
-        eq.k = 0;
-        eq.c = p.x*p.x + p.y*p.y;
+        set(p);
     }
     /// ctor
-    PointSite( const Point& p, HEFace f, HEVertex vert):  v(vert), _p(p) {
+    PointSite( const Point& p, HEFace f, HEVertex vert):  v(vert) {
         face = f;
-        eq.q = true;
-        eq.a = -2*p.x;
-        eq.b = -2*p.y;
-        eq.k = 0;
-        eq.c = p.x*p.x + p.y*p.y;
+        set(p);
     }
     ~PointSite() {}
-    virtual Point apex_point(const Point& ) { return _p; }
-    virtual Ofs* offset(Point p1,Point p2) {
-        double rad = (p1-_p).norm();
-        return new ArcOfs(p1, p2, _p, rad); 
-    }
-    inline virtual const Point position() const { return _p; }
-    virtual double x() const {return _p.x;}
-    virtual double y() const {return _p.y;}
-    virtual double r() const {return 0;}
-    virtual double k() const {return 0;}
-    inline virtual bool isPoint() const {return true;}
     virtual std::string str() const {return "PointSite";}
     virtual std::string str2() const {
         std::string out = "PointSite: ";
-        out.append( _p.str() );
+        out.append( rec.p1.str() );
         return out;
     }
-    virtual bool in_region(const Point& ) const {return true;}
-    virtual double in_region_t(const Point& p) const {return -1;}
     virtual HEVertex vertex() {return v;}
     HEVertex v; ///< vertex descriptor of this PointSite
 private:
     PointSite() {} // don't use!
-    Point _p; ///< position
+    /// set record and equation for a point at \a p
+    void set(const Point& p) {
+        rec.type = SiteRecord::POINT;
+        rec.p1 = p;
+        rec.r = 0;
+        rec.cw = false;
+        eq.q = true;
+        eq.a = -2*p.x;
+        eq.b = -2*p.y;
+        eq.k = 0;
+        eq.c = p.x*p.x + p.y*p.y;
+        cache_equations();
+    }
 };
 
 /// line segment Site
 class LineSite : public Site {
 public:
     /// create line-site between start and end Point.
-    LineSite( const Point& st, const Point& en, double koff, HEFace f = 0): _start(st), _end(en) {
+    LineSite( const Point& st, const Point& en, double koff, HEFace f = 0) {
         face = f;
+        rec.type = SiteRecord::LINE;
+        rec.p1 = st;
+        rec.p2 = en;
+        rec.r = 0;
+        rec.cw = false;
         eq.q = false;
-        eq.a = _end.y - _start.y;
-        eq.b = _start.x - _end.x;
+        eq.a = en.y - st.y;
+        eq.b = st.x - en.x;
         eq.k = koff; // ??
-        eq.c = _end.x*_start.y - _start.x*_end.y;
+        eq.c = en.x*st.y - st.x*en.y;
         // now normalize
         double d = sqrt( eq.a*eq.a + eq.b*eq.b );
         eq.a /= d;
@@ -419,231 +583,74 @@ public:
         eq.c /= d;
         e = HEEdge();
         assert( fabs( eq.a*eq.a + eq.b*eq.b -1.0 ) < 1e-5);
+        cache_equations();
     }
     /// copy ctor
     LineSite( Site& s ) { // "downcast" like constructor? required??
         eq = s.eqp();
         face = s.face;
-        _start = s.start();
-        _end = s.end();
+        rec = s.record();
+        cache_equations();
     }
     ~LineSite() {}
-    virtual Ofs* offset(Point p1,Point p2) {return new LineOfs(p1, p2); }
-    
-    /// closest point on start-end segment to given point.
-    /// project onto line and return either the projected point
-    /// or one endpoint of the linesegment
-    virtual Point apex_point(const Point& p) {
-        Point s_p = p-_start;
-        Point s_e = _end - _start;
-        double t = s_p.dot(s_e) / s_e.dot(s_e);
-        if (t<0)
-            return _start;
-        if (t>1)
-            return _end;
-        else {
-            return _start + t*(_end-_start);
-        }
-    }
     virtual std::string str() const {return "LineSite";}
     virtual std::string str2() const {
         std::string out = "LineSite: ";
-        out.append( _start.str() );
+        out.append( rec.p1.str() );
         out.append( " - " );
-        out.append( _end.str() );
+        out.append( rec.p2.str() );
         return out;
     }
-    virtual bool in_region(const Point& p) const{
-        double t = in_region_t(p);
-        return ( (t>=0) && (t<=1) );
-    }
-    virtual double in_region_t(const Point& p) const {
-        Point s_p = p-_start;
-        Point s_e = _end - _start;
-        double t = s_p.dot(s_e) / s_e.dot(s_e);
-        double eps = 1e-7;
-        if (fabs(t) < eps)  // rounding... UGLY
-            t = 0.0;
-        else if ( fabs(t-1.0) < eps )
-            t = 1.0;
-        return t;
-    }
-    virtual double in_region_t_raw(const Point& p) const {
-        Point s_p = p-_start;
-        Point s_e = _end - _start;
-        double t = s_p.dot(s_e) / s_e.dot(s_e);
-        return t;
-    }
-    inline virtual bool isLine() const {return true;}
-    virtual double a() const { return eq.a; }
-    virtual double b() const { return eq.b; }
-    virtual double c() const { return eq.c; }
-    virtual double k() const {
-        assert( eq.k==1 || eq.k==-1 );
-        return eq.k;
-    }
-    virtual const Point start() const {return _start;}
-    virtual const Point end() const {return _end;}
     virtual HEEdge edge() {return e;}
     
     HEEdge e; ///< edge_descriptor to the ::LINESITE pseudo-edge
 private:
     LineSite() {} // don't use!
-    Point _start; ///< start Point of LineSite
-    Point _end; ///< end Point of LineSite
 };
 
 /// circular arc Site
 class ArcSite : public Site {
 public:
     /// create arc-site
-    ArcSite( const Point& startpt, const Point& endpt, const Point& centr, bool dir) : 
-        _start(startpt), _end(endpt), _center(centr), _dir(dir) {
-        _radius = (_center - _start).norm();
+    ArcSite( const Point& startpt, const Point& endpt, const Point& centr, bool dir) {
+        rec.type = SiteRecord::ARC;
+        rec.p1 = startpt;
+        rec.p2 = endpt;
+        rec.c = centr;
+        rec.cw = dir;
+        rec.r = (centr - startpt).norm();
+        double k = 1; // offset-direction. +1 for enlarging, -1 for shrinking circle
         eq.q = true;
-        eq.a = -2*_center.x;
-        eq.b = -2*_center.y;
-        _k = 1;
-        eq.k = -2*_k*_radius; 
-        eq.c = _center.x*_center.x + _center.y*_center.y - _radius*_radius;
+        eq.a = -2*centr.x;
+        eq.b = -2*centr.y;
+        eq.k = -2*k*rec.r; 
+        eq.c = centr.x*centr.x + centr.y*centr.y - rec.r*rec.r;
+        cache_equations();
     }
     ~ArcSite() {}
-    virtual Ofs* offset(Point p1,Point p2) {return new ArcOfs(p1,p2,_center,-1); } //FIXME: radius
-    
-    virtual bool in_region(const Point& p) const {
-        /*
-        if (_dir) {
-            return p.is_right(_center,_start) && !p.is_right(_center,_end);
-        } else {
-            return !p.is_right(_center,_start) && p.is_right(_center,_end);
-        }
-        */
-        if (p==_center)
-            return true;
-            
-        double t = in_region_t(p);
-        return ( (t>=0) && (t<=1) );
-        
-    }
-    
-    /// \todo fix arc-site in_region_t test!!
-    virtual double in_region_t(const Point& pt) const {
-        // projection onto circle
-        /*
-        Point cen_start = _start - _center;
-        Point cen_end   = _end - _center;
-        Point cen_pt = pt - _center;
-        Point proj = _center + ( _radius/cen_pt.norm())*cen_pt;
-        
-        double diangle_min,diangle_max;
-        if (!_dir) {
-            diangle_min = numeric::diangle( cen_start.x, cen_start.y );
-            diangle_max = numeric::diangle( cen_end.x, cen_end.y );
-        } else {
-            diangle_max = numeric::diangle( cen_start.x, cen_start.y );
-            diangle_min = numeric::diangle( cen_end.x, cen_end.y );
-        }
-        //double fuzz(0.01);
-        double diangle_pt = numeric::diangle(cen_pt.x, cen_pt.y);
-        */
-        double t = in_region_t_raw(pt); //(diangle_pt - diangle_min) / (diangle_max-diangle_min);
-        double eps = 1e-7;
-        if (fabs(t) < eps)  // rounding... UGLY
-            t = 0.0;
-        else if ( fabs(t-1.0) < eps )
-            t = 1.0;
-        return t;
-        
-        /// find t-value along arc
-        //return 0.5; // FIXME
-    }
-    virtual double in_region_t_raw(const Point& pt) const {
-        // projection onto circle
-        Point cen_start = _start - _center;
-        Point cen_end   = _end - _center;
-        Point cen_pt = pt - _center;
-        Point proj = _center + ( _radius/cen_pt.norm())*cen_pt;
-        
-        double diangle_min,diangle_max;
-        if (!_dir) {
-            diangle_min = numeric::diangle( cen_start.x, cen_start.y );
-            diangle_max = numeric::diangle( cen_end.x, cen_end.y );
-        } else {
-            diangle_max = numeric::diangle( cen_start.x, cen_start.y );
-            diangle_min = numeric::diangle( cen_end.x, cen_end.y );
-        }
-        //double fuzz(0.01);
-        double diangle_pt = numeric::diangle(cen_pt.x, cen_pt.y);
-        
-        double t = (diangle_pt - diangle_min) / (diangle_max-diangle_min);
-        return t;
-    }
-    Point apex_point(const Point& p) {
-        if (in_region(p))
-            return projection_point(p);
-        else
-            return closer_endpoint(p);
-    }
-    
-    virtual double x() const {return _center.x;}
-    virtual double y() const {return _center.y;}
-    virtual double r() const {return _radius;}
-    virtual double k() const {return _k;} // ?
-
     
     virtual std::string str() const {return "ArcSite";}
     virtual std::string str2() const {
         std::string out = "ArcSite: ";
-        out.append( _start.str() );
+        out.append( rec.p1.str() );
         out.append( " - " );
-        out.append( _end.str() );
+        out.append( rec.p2.str() );
         out.append( " c=" );
-        out.append( _center.str() );
+        out.append( rec.c.str() );
         out.append( " cw=" );
-        out.append( (_dir ? "1" : "0" ) );
+        out.append( (rec.cw ? "1" : "0" ) );
 
         return out;
     }
     HEEdge e; ///< edge_descriptor to ::ARCSITE pseudo-edge
-    /// return start Point of ArcSite
-    const Point start() const {return _start;}
-    /// return end Point of ArcSite
-    const Point end() const {return _end;}
+    virtual HEEdge edge() {return e;}
     /// return center Point of ArcSite
-    Point center() {return _center;}
+    Point center() const {return rec.c;}
     /// return radius of ArcSite
-    double radius() {return _radius;}
-    /// return true for CW ArcSite and false for CCW
-    bool cw() {return _dir;}
-    inline virtual bool isArc() const  { return true;}
+    double radius() const {return rec.r;}
 
 private:
-    /// projection of given Point onto the ArcSite
-    Point projection_point(const Point& p) const {
-        if ( p == _center ) {
-            return _start;
-        } else {
-            Point dir = (p-_center);
-            dir.normalize();
-            return _center + _radius*dir; // this point should lie on the arc
-        }
-    }
-    /// return the end Point (either _start or _end) that is closest to the given Point 
-    Point closer_endpoint(const Point& p) const {
-        double d_start = (_start-p).norm();
-        double d_end = (_end-p).norm();
-        if (d_start < d_end)
-            return _start;
-        else
-            return _end;
-    }
     ArcSite() {} // don't use!
-    Point _start;  ///< start Point of arc
-    Point _end;    ///< end Point of arc
-    Point _center; ///< center Point of arc
-    bool _dir;     ///< CW or CCW direction flag
-    double _radius;///< radius of arc
-    double _k; ///< offset-direction. +1 for enlarging, -1 for shrinking circle
 };
 
 
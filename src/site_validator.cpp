@@ -0,0 +1,436 @@
+/*
+ *  Copyright (c) 2010-2012 Anders Wallin (anders.e.e.wallin "at" gmail.com).
+ *
+ *  This file is part of Openvoronoi
+ *  (see https://github.com/aewallin/openvoronoi).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cmath>
+#include <cassert>
+#include <map>
+#include <set>
+#include <algorithm>
+
+#include <boost/foreach.hpp>
+#include <boost/unordered_map.hpp>
+
+#include "site_validator.hpp"
+
+namespace ovd
+{
+
+/// lexicographic order of points, by x and then by y. this is the order of sweep events.
+struct LexLess {
+    /// true if \a a is before \a b
+    bool operator()(const Point& a, const Point& b) const {
+        if (a.x != b.x)
+            return a.x < b.x;
+        return a.y < b.y;
+    }
+};
+
+/// \brief Bentley-Ottmann sweep over line-segments, from left to right
+///
+/// The status holds the non-vertical segments that cross the sweep line, from below to above.
+/// At each event point the segments that contain the point are taken out of the status, and
+/// put back together with the segments that start at the point, in their order just right of the point.
+/// Segments are placed with orientation tests against the segments of the status, and segments
+/// through the event point are ordered by slope, so no y-coordinates are interpolated.
+///
+/// Neighbours in the status are tested, and a proper crossing of two neighbours
+/// schedules an event at the crossing point. The computed crossing point is rounded, so the
+/// two segments of a crossing event are treated as passing through the event point. At each
+/// event point, all segments that contain the point are also tested against each other. This
+/// reports pairs that touch or overlap, which do not need to change order. Vertical segments
+/// are not put in the status, they are tested against the status segments they span when they start.
+/// Vertical segments at the x of the sweep point are kept by their upper y, until the sweep passes it.
+class SegmentSweep {
+public:
+    /// sweep over the segments of \a segs that are not marked in \a skip
+    SegmentSweep(const std::vector<Point>& points, const std::vector< std::pair<int,int> >& segs,
+                 const std::vector<bool>& skip) : status( Order(this) ), pos( segs.size() ),
+                 active( segs.size(), false ), at_point( segs.size(), false ), inserting(PROBE) {
+        for (unsigned int n=0; n<segs.size(); ++n) {
+            Point p1, p2;
+            if (!skip[n]) {
+                p1 = points[ segs[n].first ];
+                p2 = points[ segs[n].second ];
+                if ( LexLess()(p2,p1) )
+                    std::swap(p1,p2);
+                events[p1].start.push_back(n);
+                events[p2].end.push_back(n);
+            }
+            left.push_back(p1);
+            right.push_back(p2);
+        }
+    }
+    /// run the sweep, and append the intersecting pairs to \a out
+    void run(std::vector<SiteConflict>& out) {
+        conflicts = &out;
+        while ( !events.empty() ) {
+            EventQueue::iterator it = events.begin();
+            sweep_pt = it->first;
+            Event ev = it->second;
+            events.erase(it);
+            if ( !verticals.empty() && left[ verticals.begin()->second ].x != sweep_pt.x )
+                verticals.clear(); // the sweep has moved to a new x
+            // events at one x come by increasing y, so a vertical segment that ends below the point is done
+            while ( !verticals.empty() && verticals.begin()->first < sweep_pt.y )
+                verticals.erase( verticals.begin() );
+            process(ev);
+        }
+    }
+private:
+    /// the segments that start, end, or cross at an event point
+    struct Event {
+        std::vector<int> start; ///< segments with this left endpoint
+        std::vector<int> end;   ///< segments with this right endpoint
+        std::vector<int> cross; ///< pairs of segments that cross at this point
+    };
+    typedef std::map<Point, Event, LexLess> EventQueue;
+
+    /// stands for the sweep point in Order
+    enum { PROBE = -1 };
+
+    /// order of segments along the sweep line
+    struct Order {
+        /// ctor
+        explicit Order(const SegmentSweep* s) : sweep(s) {}
+        /// true if segment \a a is below segment \a b
+        bool operator()(int a, int b) const { return sweep->below(a,b); }
+        const SegmentSweep* sweep; ///< the sweep, for the sweep point and the segment being inserted
+    };
+    typedef std::set<int, Order> Status;
+    /// a vertical segment, keyed by the y of its upper end
+    typedef std::pair<double,int> Vertical;
+
+    /// update the status at the event point
+    void process(const Event& ev) {
+        // segments of the status that pass through, or end at, the event point. they are
+        // next to each other in the status, but a rounded crossing point need not be on them.
+        std::vector<int> through;
+        Status::iterator first = status.lower_bound(PROBE);
+        if ( first != status.end() && contains(*first) )
+            mark( *first, through );
+        BOOST_FOREACH( int s, ev.cross ) {
+            if ( active[s] )
+                mark( s, through );
+        }
+        BOOST_FOREACH( int s, ev.end ) {
+            if ( active[s] )
+                mark( s, through );
+        }
+        bool rounded = !ev.cross.empty();
+        for (unsigned int n=0; n<through.size(); ++n) {
+            Status::iterator it = pos[ through[n] ];
+            if ( it != status.begin() ) {
+                --it;
+                if ( contains(*it) || (rounded && near(*it)) )
+                    mark( *it, through );
+                ++it;
+            }
+            ++it;
+            if ( it != status.end() && ( contains(*it) || (rounded && near(*it)) ) )
+                mark( *it, through );
+        }
+        // test all segments at the point against each other. this finds pairs that touch or overlap,
+        // which need not be neighbours.
+        std::vector<int> all( through );
+        all.insert( all.end(), ev.start.begin(), ev.start.end() );
+        BOOST_FOREACH( const Vertical& v, verticals ) // they all contain the point, see run()
+            all.push_back(v.second);
+        for (unsigned int i=0; i<all.size(); ++i) {
+            for (unsigned int j=i+1; j<all.size(); ++j)
+                check( all[i], all[j] );
+        }
+        // take the segments out, and put back the ones that continue right of the point, and the new ones
+        BOOST_FOREACH( int s, through ) {
+            status.erase( pos[s] );
+            active[s] = false;
+        }
+        std::vector<int> after;
+        BOOST_FOREACH( int s, through ) {
+            if ( right[s] != sweep_pt )
+                after.push_back(s);
+        }
+        BOOST_FOREACH( int s, ev.start ) {
+            if ( left[s].x == right[s].x ) {
+                add_vertical(s);
+            } else {
+                at_point[s] = true;
+                after.push_back(s);
+            }
+        }
+        BOOST_FOREACH( int s, after )
+            insert(s);
+        BOOST_FOREACH( int s, through )
+            at_point[s] = false;
+        BOOST_FOREACH( int s, after )
+            at_point[s] = false;
+        if ( !after.empty() ) {
+            // the segments right of the point are in slope order, and have new neighbours
+            std::sort( after.begin(), after.end(), SlopeLess(this) );
+            Status::iterator lo = pos[ after.front() ];
+            Status::iterator hi = pos[ after.back() ];
+            for (unsigned int n=0; n+1<after.size(); ++n)
+                check( after[n], after[n+1] );
+            if ( lo != status.begin() ) {
+                Status::iterator below_lo = lo;
+                --below_lo;
+                check( *below_lo, *lo );
+            }
+            Status::iterator above_hi = hi;
+            ++above_hi;
+            if ( above_hi != status.end() )
+                check( *hi, *above_hi );
+        } else {
+            // the segments below and above the event point are now neighbours
+            Status::iterator above = status.lower_bound(PROBE);
+            if ( above != status.begin() && above != status.end() ) {
+                Status::iterator below = above;
+                --below;
+                check( *below, *above );
+            }
+        }
+    }
+    /// add \a s to \a through, once
+    void mark(int s, std::vector<int>& through) {
+        if ( !at_point[s] ) {
+            at_point[s] = true;
+            through.push_back(s);
+        }
+    }
+    /// \brief true if segment \a a is below segment \a b
+    ///
+    /// the std::set only compares the segment being inserted, or the sweep point, to segments in the status.
+    /// the sweep point is below all segments that contain it.
+    bool below(int a, int b) const {
+        if ( a == b )
+            return false;
+        if ( a == PROBE )
+            return orient( left[b], right[b], sweep_pt ) <= 0;
+        if ( b == PROBE )
+            return orient( left[a], right[a], sweep_pt ) > 0;
+        if ( a == inserting )
+            return new_below(a,b);
+        assert( b == inserting );
+        return !new_below(b,a);
+    }
+    /// \brief true if segment \a s, which passes through the sweep point, is below segment \a t of the status, just right of the point
+    ///
+    /// segments that both pass through the point are ordered by slope
+    bool new_below(int s, int t) const {
+        if ( at_point[t] )
+            return SlopeLess(this)(s,t);
+        double o = orient( left[t], right[t], sweep_pt );
+        if ( o == 0 ) // t ends at the point, or the point is rounded. compare the directions
+            o = orient( left[t], right[t], right[s] );
+        if ( o == 0 ) // collinear
+            return s < t;
+        return o < 0;
+    }
+    /// put segment \a s in the status
+    void insert(int s) {
+        inserting = s;
+        pos[s] = status.insert(s).first;
+        inserting = PROBE;
+        active[s] = true;
+    }
+    /// order of non-vertical segments by slope, and by index for equal slopes
+    struct SlopeLess {
+        /// ctor
+        explicit SlopeLess(const SegmentSweep* s) : sweep(s) {}
+        /// true if segment \a a has a smaller slope than \a b
+        bool operator()(int a, int b) const {
+            const std::vector<Point>& l = sweep->left;
+            const std::vector<Point>& r = sweep->right;
+            double sa = (r[a].y-l[a].y)*(r[b].x-l[b].x); // dx>0, so compare dy_a/dx_a < dy_b/dx_b without division
+            double sb = (r[b].y-l[b].y)*(r[a].x-l[a].x);
+            if ( sa != sb )
+                return sa < sb;
+            return a < b;
+        }
+        const SegmentSweep* sweep; ///< the sweep, for the segment endpoints
+    };
+    /// \brief test vertical segment \a v against the segments of the status that it spans, and the other vertical segments at this x
+    ///
+    /// the other vertical segments contain the start of \a v, so each of them overlaps \a v, or ends where \a v starts
+    void add_vertical(int v) {
+        for (Status::iterator it=status.lower_bound(PROBE); it!=status.end(); ++it) {
+            if ( orient( left[*it], right[*it], right[v] ) < 0 ) // the top of v is below the segment
+                break;
+            check(v, *it);
+        }
+        BOOST_FOREACH( const Vertical& w, verticals )
+            check(v, w.second);
+        verticals.insert( Vertical( right[v].y, v ) );
+    }
+    /// true if segment \a s contains the sweep point
+    bool contains(int s) const {
+        const Point& l = left[s];
+        const Point& r = right[s];
+        return orient(l, r, sweep_pt) == 0 && !LexLess()(sweep_pt, l) && !LexLess()(r, sweep_pt);
+    }
+    /// \brief true if the sweep point is within rounding distance of segment \a s
+    ///
+    /// a crossing point is rounded to double, so segments through the same crossing
+    /// need not contain the rounded point
+    bool near(int s) const {
+        const Point& l = left[s];
+        const Point& r = right[s];
+        if ( sweep_pt.x < l.x || r.x < sweep_pt.x )
+            return false;
+        double scale = 1.0 + fabs(sweep_pt.x) + fabs(sweep_pt.y);
+        return fabs( orient(l, r, sweep_pt) ) <= 1e-12 * scale * (r-l).norm();
+    }
+    /// sign of the turn a-b-c: positive for a left turn
+    static double orient(const Point& a, const Point& b, const Point& c) {
+        return (b-a).cross(c-a);
+    }
+    /// report \a a and \a b if they intersect, and schedule an event if they cross
+    void check(int a, int b) {
+        std::pair<int,int> key( std::min(a,b), std::max(a,b) );
+        if ( found.count(key) )
+            return;
+        const Point& a1 = left[a];
+        const Point& a2 = right[a];
+        const Point& b1 = left[b];
+        const Point& b2 = right[b];
+        // segments with a common endpoint only conflict if they overlap
+        if ( (a1 == b1 && a2 == b2) ) {
+            report(key);
+            return;
+        }
+        if ( a1 == b1 || a1 == b2 || a2 == b1 || a2 == b2 ) {
+            Point c  = ( a1 == b1 || a1 == b2 ) ? a1 : a2;
+            Point ao = ( c == a1 ) ? a2 : a1;
+            Point bo = ( c == b1 ) ? b2 : b1;
+            if ( orient(c,ao,bo) == 0 && (ao-c).dot(bo-c) > 0 )
+                report(key);
+            return;
+        }
+        double o1 = orient(a1,a2,b1);
+        double o2 = orient(a1,a2,b2);
+        double o3 = orient(b1,b2,a1);
+        double o4 = orient(b1,b2,a2);
+        if ( (o1>0 && o2>0) || (o1<0 && o2<0) || (o3>0 && o4>0) || (o3<0 && o4<0) )
+            return;
+        if ( o1 == 0 && o2 == 0 ) { // collinear
+            LexLess lex;
+            if ( !lex(a2,b1) && !lex(b2,a1) )
+                report(key);
+            return;
+        }
+        report(key);
+        if ( o1 != 0 && o2 != 0 && o3 != 0 && o4 != 0 && a1.x != a2.x && b1.x != b2.x ) {
+            // proper crossing. the two change order at the crossing point, but never behind the sweep.
+            Point da = a2-a1;
+            Point db = b2-b1;
+            double t = (b1-a1).cross(db) / da.cross(db);
+            Point q = a1 + t*da;
+            if ( LexLess()(q, sweep_pt) )
+                q = sweep_pt;
+            events[q].cross.push_back(a);
+            events[q].cross.push_back(b);
+        }
+    }
+    /// record an intersecting pair
+    void report(const std::pair<int,int>& key) {
+        found.insert(key);
+        conflicts->push_back( SiteConflict( SiteConflict::INTERSECTION, key.first, key.second ) );
+    }
+// DATA
+    EventQueue events;             ///< future events, in sweep order
+    Status status;                 ///< segments that cross the sweep line, from below to above
+    std::vector<Status::iterator> pos; ///< position of each segment in status
+    std::vector<bool> active;      ///< segment is in status
+    std::vector<bool> at_point;    ///< segment passes through the event point
+    int inserting;                 ///< segment being inserted into status
+    std::vector<Point> left;       ///< lexicographically smaller endpoint of each segment
+    std::vector<Point> right;      ///< lexicographically larger endpoint of each segment
+    Point sweep_pt;                ///< the current event point
+    std::set<Vertical> verticals;  ///< vertical segments at the x of the sweep point that reach its y, by their upper y
+    std::set< std::pair<int,int> > found;   ///< pairs already reported
+    std::vector<SiteConflict>* conflicts; ///< output
+};
+
+std::vector<SiteConflict> SiteValidator::validate(const std::vector<Point>& points,
+                                                  const std::vector< std::pair<int,int> >& segments) const {
+    std::vector<SiteConflict> out = intersections(points, segments);
+    std::vector<SiteConflict> dups = duplicate_points(points);
+    // bad segments first, then duplicates, then intersections
+    std::vector<SiteConflict>::iterator it = out.begin();
+    while ( it != out.end() && it->type == SiteConflict::BAD_SEGMENT )
+        ++it;
+    out.insert( it, dups.begin(), dups.end() );
+    return out;
+}
+
+/// points are put in square cells of side \a tolerance, so that a point
+/// only needs to be compared to points in its own cell and the eight neighbouring cells.
+/// with zero tolerance the cell is the position itself.
+std::vector<SiteConflict> SiteValidator::duplicate_points(const std::vector<Point>& points) const {
+    typedef std::pair<double,double> Cell;
+    typedef boost::unordered_map< Cell, std::vector<int> > Grid;
+    std::vector<SiteConflict> out;
+    Grid grid;
+    for (unsigned int n=0; n<points.size(); ++n) {
+        const Point& p = points[n];
+        if ( tolerance <= 0 ) {
+            std::vector<int>& same = grid[ Cell(p.x,p.y) ];
+            BOOST_FOREACH( int m, same )
+                out.push_back( SiteConflict( SiteConflict::DUPLICATE_POINT, m, n ) );
+            same.push_back(n);
+            continue;
+        }
+        double cx = std::floor( p.x/tolerance );
+        double cy = std::floor( p.y/tolerance );
+        for (int dx=-1; dx<=1; ++dx) {
+            for (int dy=-1; dy<=1; ++dy) {
+                Grid::const_iterator it = grid.find( Cell(cx+dx, cy+dy) );
+                if ( it == grid.end() )
+                    continue;
+                BOOST_FOREACH( int m, it->second ) {
+                    if ( (points[m]-p).norm() <= tolerance )
+                        out.push_back( SiteConflict( SiteConflict::DUPLICATE_POINT, m, n ) );
+                }
+            }
+        }
+        grid[ Cell(cx,cy) ].push_back(n);
+    }
+    return out;
+}
+
+std::vector<SiteConflict> SiteValidator::intersections(const std::vector<Point>& points,
+                                                       const std::vector< std::pair<int,int> >& segments) const {
+    std::vector<SiteConflict> out;
+    std::vector<bool> skip( segments.size(), false );
+    for (unsigned int n=0; n<segments.size(); ++n) {
+        int i1 = segments[n].first;
+        int i2 = segments[n].second;
+        if ( i1 < 0 || i2 < 0 || i1 >= (int)points.size() || i2 >= (int)points.size() ||
+             points[i1] == points[i2] ) {
+            out.push_back( SiteConflict( SiteConflict::BAD_SEGMENT, n, -1 ) );
+            skip[n] = true;
+        }
+    }
+    SegmentSweep sweep(points, segments, skip);
+    sweep.run(out);
+    return out;
+}
+
+} // end namespace
+// end file site_validator.cpp
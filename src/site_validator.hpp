@@ -0,0 +1,73 @@
+/*
+ *  Copyright (c) 2010-2012 Anders Wallin (anders.e.e.wallin "at" gmail.com).
+ *
+ *  This file is part of Openvoronoi
+ *  (see https://github.com/aewallin/openvoronoi).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <vector>
+#include <utility>
+
+#include "common/point.hpp"
+
+namespace ovd
+{
+
+/// \brief a problem with the input sites, found by SiteValidator
+struct SiteConflict {
+    /// kind of problem
+    enum Type {
+        DUPLICATE_POINT, ///< \a first and \a second are points at the same position
+        INTERSECTION,    ///< \a first and \a second are segments that cross, overlap, or touch away from a common endpoint
+        BAD_SEGMENT      ///< segment \a first has an invalid point index, or zero length. \a second is -1
+    };
+    /// ctor
+    SiteConflict(Type t, int i, int j): type(t), first(i), second(j) {}
+    Type type;  ///< kind of problem
+    int first;  ///< index of the first point or segment
+    int second; ///< index of the second point or segment, larger than \a first. -1 for a single-segment (degenerate) BAD_SEGMENT conflict
+};
+
+/// \brief check point- and line-sites before they are inserted into a VoronoiDiagram
+///
+/// VoronoiDiagram requires that point-sites are distinct and that line-sites
+/// do not intersect, except at a common endpoint. Input that breaks these rules
+/// can crash the insertion. This class finds the offending pairs:
+/// - duplicate points are found with a hash-grid, in O(n) expected time.
+/// - intersecting segments are found with a Bentley-Ottmann sweep, in O((n+k) log n)
+///   time for n segments and k intersecting pairs.
+///
+/// Segments are pairs of indices into the point vector, as in BatchSites.
+class SiteValidator {
+public:
+    /// points closer than \a tol are duplicates. with tol==0 only identical points are.
+    explicit SiteValidator(double tol=0.0) : tolerance(tol) {}
+    /// all problems: bad segments, then duplicate points, then intersecting segments
+    std::vector<SiteConflict> validate(const std::vector<Point>& points,
+                                       const std::vector< std::pair<int,int> >& segments) const;
+    /// pairs of points closer than the tolerance
+    std::vector<SiteConflict> duplicate_points(const std::vector<Point>& points) const;
+    /// pairs of intersecting segments, and bad segments
+    std::vector<SiteConflict> intersections(const std::vector<Point>& points,
+                                            const std::vector< std::pair<int,int> >& segments) const;
+private:
+    double tolerance; ///< distance below which points are duplicates
+};
+
+} // end namespace
+// end file site_validator.hpp
@@ -19,6 +19,8 @@
 */
 #pragma once
 
+#include <boost/container/static_vector.hpp>
+
 #include "common/point.hpp"
 
 namespace ovd {
@@ -40,5 +42,14 @@ struct Solution {
     double k3;
 };
 
+/// \brief capacity of a SolutionBuffer
+///
+/// VertexPositioner::position() collects the solutions for k3=+1 and k3=-1.
+/// QLLSolver, which finds the most, returns at most two roots for each of its three permutations.
+const unsigned int MAX_SOLUTIONS = 16;
+
+/// \brief fixed-capacity list of Solution, stored inline without heap allocation
+typedef boost::container::static_vector<Solution, MAX_SOLUTIONS> SolutionBuffer;
+
 } // solvers
 } //end ovd namespace
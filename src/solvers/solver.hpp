@@ -20,6 +20,8 @@
 
 #pragma once
 
+#include "solution.hpp"
+
 namespace ovd {
 
 class Site;
@@ -52,7 +54,7 @@ public:
     /// \param slns Solution vector, will be updated by Solver
     virtual int solve(Site* s1, double k1, 
                            Site* s2, double k2, 
-                           Site* s3, double k3, std::vector<Solution>& slns ) =0;
+                           Site* s3, double k3, SolutionBuffer& slns ) =0;
 
     /// used by alt_sep_solver
     virtual void set_type(int t) {type=t;}
@@ -73,7 +73,7 @@ public:
 //virtual void set_type(int t) {type=t;}
 int solve( Site* s1, double k1, 
            Site* s2, double k2, 
-           Site* s3, double k3, std::vector<Solution>& slns ) {
+           Site* s3, double k3, SolutionBuffer& slns ) {
     if (debug && !silent) 
         std::cout << "ALTSEPSolver.\n";
     Site* lsite;
@@ -21,6 +21,7 @@
 #pragma once
 
 #include "solvers/solver_lll_para.hpp"
+#include "solvers/tiered_solver.hpp"
 
 #include "common/point.hpp"
 #include "common/numeric.hpp"
@@ -33,8 +34,10 @@ namespace solvers {
 /// \brief line-line-line Solver
 ///
 /// solves 3x3 system.
-class LLLSolver : public Solver {
-public:
+/// This runs in double first, see TieredSolver.
+class LLLSolver : public TieredSolver<LLLSolver> {
+    friend class TieredSolver<LLLSolver>;
+protected:
 // distance from the sought point (x,y) to the line
 // sites is t
 // this gives three equations
@@ -54,48 +57,65 @@ public:
 //  the case when det(A) = 0  cannot be handled here
 //  see LLLPARASolver 
             
-int solve( Site* s1, double k1, 
-           Site* s2, double k2, 
-           Site* s3, double k3, std::vector<Solution>& slns ) {
+int solve_tier( SolverTier tier,
+                Site* s1, double k1, 
+                Site* s2, double k2, 
+                Site* s3, double k3, SolutionBuffer& slns ) {
+    switch (tier) {
+        case DOUBLE_TIER: return solve_in< bounded<double> >(s1,k1,s2,k2,s3,k3,slns);
+        case DD_TIER:     return solve_in< bounded<dd_real> >(s1,k1,s2,k2,s3,k3,slns);
+        default:          return solve_in< qd_real >(s1,k1,s2,k2,s3,k3,slns);
+    }
+}
+
+private:
+template<class Scalar>
+int solve_in( Site* s1, double k1, 
+              Site* s2, double k2, 
+              Site* s3, double k3, SolutionBuffer& slns ) {
     if (debug && !silent)
         std::cout << "LLLSolver.\n";
     
     assert( s1->isLine() && s2->isLine() && s3->isLine() );
     
-    std::vector< Eq<qd_real> > eq; // equation-parameters, in quad-precision
     boost::array<Site*,3> sites = {{s1,s2,s3}};    
     boost::array<double,3> kvals = {{k1,k2,k3}};
-    for (unsigned int i=0;i<3;i++)
-        eq.push_back( sites[i]->eqp_qd( kvals[i] ) );
+    // equation-parameters, in the precision of this tier
+    typename site_equation<Scalar>::type eq1 = site_equation<Scalar>::get(s1,k1);
+    typename site_equation<Scalar>::type eq2 = site_equation<Scalar>::get(s2,k2);
+    typename site_equation<Scalar>::type eq3 = site_equation<Scalar>::get(s3,k3);
+    boost::array<const Eq<Scalar>*,3> eq = {{&eq1,&eq2,&eq3}};
     
     unsigned int i = 0, j=1, k=2;
-    qd_real detA = chop( determinant( eq[i].a, eq[i].b, eq[i].k, 
-                                      eq[j].a, eq[j].b, eq[j].k, 
-                                      eq[k].a, eq[k].b, eq[k].k ) ); 
+    Scalar detA = chop( determinant( eq[i]->a, eq[i]->b, eq[i]->k, 
+                                      eq[j]->a, eq[j]->b, eq[j]->k, 
+                                      eq[k]->a, eq[k]->b, eq[k]->k ) ); 
     double det_eps = 1e-6;
-    if ( fabs(detA) > det_eps ) {
-        qd_real sol_t = determinant(  eq[i].a, eq[i].b, -eq[i].c, 
-                                      eq[j].a, eq[j].b, -eq[j].c, 
-                                      eq[k].a, eq[k].b, -eq[k].c ) / detA ; 
-        if (sol_t >= 0) {
-            qd_real sol_x = determinant(  -eq[i].c, eq[i].b, eq[i].k, 
-                                          -eq[j].c, eq[j].b, eq[j].k, 
-                                          -eq[k].c, eq[k].b, eq[k].k ) / detA ; 
-            qd_real sol_y = determinant(  eq[i].a, -eq[i].c, eq[i].k, 
-                                          eq[j].a, -eq[j].c, eq[j].k, 
-                                          eq[k].a, -eq[k].c, eq[k].k ) / detA ; 
+    if ( !below(detA, det_eps) ) {
+        Scalar sol_t = determinant(  eq[i]->a, eq[i]->b, -eq[i]->c, 
+                                      eq[j]->a, eq[j]->b, -eq[j]->c, 
+                                      eq[k]->a, eq[k]->b, -eq[k]->c ) / detA ; 
+        if ( sign(sol_t) >= 0 && !ambiguous ) {
+            Scalar sol_x = determinant(  -eq[i]->c, eq[i]->b, eq[i]->k, 
+                                          -eq[j]->c, eq[j]->b, eq[j]->k, 
+                                          -eq[k]->c, eq[k]->b, eq[k]->k ) / detA ; 
+            Scalar sol_y = determinant(  eq[i]->a, -eq[i]->c, eq[i]->k, 
+                                          eq[j]->a, -eq[j]->c, eq[j]->k, 
+                                          eq[k]->a, -eq[k]->c, eq[k]->k ) / detA ; 
+            if ( !accurate(sol_x) || !accurate(sol_y) || !accurate(sol_t) )
+                return 0;
             if (debug && !silent ) 
                 std::cout << " solution: " << Point( to_double(sol_x), to_double(sol_y) ) << " t=" << to_double(sol_t) << " k3=" << k3 << " detA=" << to_double(detA) << "\n";
             
             slns.push_back( Solution( Point( to_double(sol_x), to_double(sol_y) ), to_double(sol_t), k3 ) ); // k3 just passes through without any effect!?
             return 1;
         }
-    } else {
+    } else if (!ambiguous) {
         // Try parallel solver as fallback, if the small determinant is due to nearly parallel edges
         for (i = 0; i < 3; i++)
         {
             j = (i+1)%3;
-            double delta = to_double(fabs(eq[i].a*eq[j].b - eq[j].a*eq[i].b));
+            double delta = fabs( to_double(eq[i]->a*eq[j]->b - eq[j]->a*eq[i]->b) );
             if (delta <= 1024.0*std::numeric_limits<double>::epsilon())
             {
                 s1 = sites[i];
@@ -112,9 +132,9 @@ int solve( Site* s1, double k1,
         }
         if (debug && !silent) {
             std::cout << "WARNING: LLLSolver small determinant! no solutions. detA= " << detA <<"\n";
-            std::cout << " s1 : " << eq[0].a << " " << eq[0].b << " " << eq[0].c << " " << eq[0].k << "\n";
-            std::cout << " s2 : " << eq[1].a << " " << eq[1].b << " " << eq[1].c << " " << eq[1].k << "\n";
-            std::cout << " s3 : " << eq[2].a << " " << eq[2].b << " " << eq[2].c << " " << eq[2].k << "\n";
+            std::cout << " s1 : " << eq[0]->a << " " << eq[0]->b << " " << eq[0]->c << " " << eq[0]->k << "\n";
+            std::cout << " s2 : " << eq[1]->a << " " << eq[1]->b << " " << eq[1]->c << " " << eq[1]->k << "\n";
+            std::cout << " s3 : " << eq[2]->a << " " << eq[2]->b << " " << eq[2]->c << " " << eq[2]->k << "\n";
         }
         
     }
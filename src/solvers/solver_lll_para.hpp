@@ -66,7 +66,7 @@ public:
 
 int solve( Site* s1, double k1, 
            Site* s2, double k2, 
-           Site* s3, double k3, std::vector<Solution>& slns ) {
+           Site* s3, double k3, SolutionBuffer& slns ) {
     if (debug)
         std::cout << "LLLPARASolver.\n";    
     assert( s1->isLine() && s2->isLine() && s3->isLine() );
@@ -132,7 +132,7 @@ int solve( Site* s1, double k1,
 private:
 /*
 void circle_line_intersection(double a, double b, double c, 
-         double cx, double cy, double r, double tb, std::vector<Solution>& slns) {
+         double cx, double cy, double r, double tb, SolutionBuffer& slns) {
     // line ax+by+c = 0
     // circle (cx,cy) radius r
 }*/
@@ -22,7 +22,7 @@
 #include <vector>
 #include <cassert>
 
-#include "solver.hpp"
+#include "tiered_solver.hpp"
 #include "site.hpp"
 #include "common/numeric.hpp"
 
@@ -31,65 +31,27 @@ using namespace ovd::numeric; // sq() chop()
 namespace ovd {
 namespace solvers {
     
-/// \brief templated point-class, so we can use qd_real as the coordinate type.
-template<class Scalar>
-struct scalar_pt {
-    scalar_pt<Scalar>() : x(0), y(0) {}
-    /// \param xi x coordinate
-    /// \param yi y coordinate
-    scalar_pt<Scalar>(Scalar xi, Scalar yi) : x(xi), y(yi) {}
-    
-    /// x coordinate
-    Scalar x;
-    /// y coordinate
-    Scalar y;
-    /// return x coordinate
-    double getx() { return x; }
-    /// return y coordinate
-    double gety() { return y; }
-    /// assignment operator
-    scalar_pt<Scalar> &operator=(const Point& p) {
-        x = p.x;
-        y = p.y;
-        return *this;
-    }
-};
-
-// with the qd_real number-type we need to_double() to get the solution coordinates as double type.
-/// \brief template-specialization for qd_real
-template<>
-struct scalar_pt<qd_real> {
-    scalar_pt<qd_real>() : x(qd_real(0)), y(qd_real(0)) {}
-    /// \param xi x coordinate
-    /// \param yi y coordinate
-    scalar_pt<qd_real>(qd_real xi, qd_real yi) : x(xi), y(yi) {}
-    
-    /// x coordinate
-    qd_real x;
-    /// y coordinate
-    qd_real y;
-    /// return x coordinate as double
-    double getx() { return to_double(x); }
-    /// return y coordinate as double
-    double gety() { return to_double(y); }
-    /// assignment
-    scalar_pt<qd_real> &operator=(const Point& p) {
-        x = p.x;
-        y = p.y;
-        return *this;
-    }
-};
-
-
 /// point-point-point Solver, based on Sugihara & Iri paper
 /// Construction of the Voronoi Diagram for “One Million’’ Generators in
 /// Single-Precision Arithmetic, PROCEEDINGS OF THE IEEE, VOL. 80, NO. 9, SEPTEMBER 1992
 ///
-template<class Scalar>
-class PPPSolver : public solvers::Solver {
-public:
+/// The vertex position is computed from three determinants J2, J3, J4.
+/// This runs in double first, see TieredSolver.
+class PPPSolver : public TieredSolver<PPPSolver> {
+    friend class TieredSolver<PPPSolver>;
+protected:
 
-int solve( Site* s1, double, Site* s2, double, Site* s3, double, std::vector<Solution>& slns ) {
+int solve_tier( SolverTier tier, Site* s1, double, Site* s2, double, Site* s3, double, SolutionBuffer& slns ) {
+    switch (tier) {
+        case DOUBLE_TIER: return solve_in< bounded<double> >(s1,s2,s3,slns);
+        case DD_TIER:     return solve_in< bounded<dd_real> >(s1,s2,s3,slns);
+        default:          return solve_in< qd_real >(s1,s2,s3,slns);
+    }
+}
+
+private:
+template<class Scalar>
+int solve_in( Site* s1, Site* s2, Site* s3, SolutionBuffer& slns ) {
     assert( s1->isPoint() && s2->isPoint() && s3->isPoint() );
     Point pi = s1->position();
     Point pj = s2->position();
@@ -118,26 +80,29 @@ int solve( Site* s1, double, Site* s2, double, Site* s3, double, std::vector<Sol
     assert( (pi - pj).norm() >=  (pj - pk).norm() );
     assert( (pi - pj).norm() >=  (pk - pi).norm() );
     
-    // we now convert to a higher precision number-type to do the calculations
-    scalar_pt<Scalar> spi,spj,spk;
-    spi = pi;
-    spj = pj;
-    spk = pk;
-    Scalar J2 = (spi.y-spk.y)*( sq(spj.x-spk.x)+sq(spj.y-spk.y) )/2.0 - 
-                (spj.y-spk.y)*( sq(spi.x-spk.x)+sq(spi.y-spk.y) )/2.0;
-    Scalar J3 = (spi.x-spk.x)*( sq(spj.x-spk.x)+sq(spj.y-spk.y) )/2.0 - 
-                (spj.x-spk.x)*( sq(spi.x-spk.x)+sq(spi.y-spk.y) )/2.0;
-    Scalar J4 = (spi.x-spk.x)*(spj.y-spk.y) - (spj.x-spk.x)*(spi.y-spk.y);
-    assert( J4 != 0.0 );
-    if (J4==0.0) {
+    // we now convert to the number-type of this tier to do the calculations
+    Scalar xi(pi.x), yi(pi.y);
+    Scalar xj(pj.x), yj(pj.y);
+    Scalar xk(pk.x), yk(pk.y);
+    Scalar J2 = (yi-yk)*( sq(xj-xk)+sq(yj-yk) )/2.0 - 
+                (yj-yk)*( sq(xi-xk)+sq(yi-yk) )/2.0;
+    Scalar J3 = (xi-xk)*( sq(xj-xk)+sq(yj-yk) )/2.0 - 
+                (xj-xk)*( sq(xi-xk)+sq(yi-yk) )/2.0;
+    Scalar J4 = (xi-xk)*(yj-yk) - (xj-xk)*(yi-yk);
+    if ( sign(J4) == 0 ) {
+        if (ambiguous) // J4 may be zero, try again in higher precision
+            return 0;
         std::cout << " PPPSolver: Warning divide-by-zero!!\n";
         std::cout << " pi = " << pi << "\n";
         std::cout << " pj = " << pj << "\n";
         std::cout << " pk = " << pk << "\n";
         exit(-1);
     }
-    scalar_pt<Scalar> pt( -J2/J4 + spk.x, J3/J4 + spk.y );
-    Point sln_pt = Point( pt.getx(), pt.gety()); // convert back to double coordinate type
+    Scalar x = -J2/J4 + xk;
+    Scalar y =  J3/J4 + yk;
+    if ( !accurate(x) || !accurate(y) )
+        return 0;
+    Point sln_pt = Point( to_double(x), to_double(y) ); // convert back to double coordinate type
     double dist = (sln_pt-pi).norm();
     slns.push_back( Solution(  sln_pt , dist , +1) );
     return 1;
@@ -21,30 +21,58 @@
 
 #include <qd/qd_real.h> // http://crd.lbl.gov/~dhbailey/mpdist/
 
-#include "solver.hpp"
+#include "tiered_solver.hpp"
 #include "common/numeric.hpp"
 
-using namespace ovd::numeric; // sq() chop() quadratic_roots()
+using namespace ovd::numeric; // sq()
 
 namespace ovd {
 namespace solvers {
 
  
 /// \brief quadratic-linear-linear Solver
-class QLLSolver : public Solver {
+///
+/// The two linear equations are solved for two of (x,y,t) in terms of the third, and
+/// substituted into the quadratic. This can be done in three ways (permutations of x,y,t).
+/// By default only the best-conditioned permutation is solved, see set_all_permutations().
+///
+/// This runs in double first, see TieredSolver.
+class QLLSolver : public TieredSolver<QLLSolver> {
+    friend class TieredSolver<QLLSolver>;
 public:
+    QLLSolver() : all_perms(false) {}
+    /// \brief solve along all three permutations if \a b is true, or only along the best-conditioned one
+    ///
+    /// VertexPositioner::position() turns this on when the solution of the best permutation
+    /// fails its checks.
+    void set_all_permutations(bool b) {all_perms = b;}
+protected:
 
-int solve( Site* s1, double k1, 
+int solve_tier( SolverTier tier,
+                Site* s1, double k1, 
                 Site* s2, double k2, 
-                Site* s3, double k3, std::vector<Solution>& slns ) {
+                Site* s3, double k3, SolutionBuffer& slns ) {
+    switch (tier) {
+        case DOUBLE_TIER: return solve_in< bounded<double> >(s1,k1,s2,k2,s3,k3,slns);
+        case DD_TIER:     return solve_in< bounded<dd_real> >(s1,k1,s2,k2,s3,k3,slns);
+        default:          return solve_in< qd_real >(s1,k1,s2,k2,s3,k3,slns);
+    }
+}
+
+private:
+template<class Scalar>
+int solve_in( Site* s1, double k1, 
+              Site* s2, double k2, 
+              Site* s3, double k3, SolutionBuffer& slns ) {
     if (debug && !silent) 
         std::cout << "QLLSolver.\n";
     
-    std::vector< Eq<qd_real> > quads,lins; // equation-parameters, in quad-precision
+    // equation-parameters, in the precision of this tier. at most three of each, stored inline.
+    boost::container::static_vector< Eq<Scalar>, 3 > quads,lins;
     boost::array<Site*,3> sites = {{s1,s2,s3}};
     boost::array<double,3> kvals = {{k1,k2,k3}};
     for (unsigned int i=0;i<3;i++) {
-        Eq<qd_real> eqn = sites[i]->eqp_qd( kvals[i] );
+        Eq<Scalar> eqn = site_equation<Scalar>::get( sites[i], kvals[i] );
         if (sites[i]->is_linear() ) // store site-equations in lins or quads
             lins.push_back( eqn ); 
         else
@@ -61,21 +89,57 @@ int solve( Site* s1, double k1,
     }
     assert( lins.size() == 2);  // At this point, we should have exactly two linear equations.
    
-    // TODO:  pick the solution appraoch with the best numerical stability.    
-    // call all three permutations
     // index shuffling determines if we solve:
     // x and y in terms of t
     // y and t in terms of x
     // t and x in terms of y
-    qll_solver( lins, 0, 1, 2, quads[0], k3, slns);
-    qll_solver( lins, 2, 0, 1, quads[0], k3, slns);
-    qll_solver( lins, 1, 2, 0, quads[0], k3, slns);
-    
+    static const int perms[3][3] = { {0,1,2}, {2,0,1}, {1,2,0} };
+    if (all_perms) {
+        for (int n=0; n<3; n++)
+            qll_solver( lins, perms[n][0], perms[n][1], perms[n][2], quads[0], k3, slns);
+        return slns.size();
+    }
+    // try the permutations from best to worst conditioned. the next one is only
+    // needed if the 2x2 system of a permutation is singular.
+    int order[3] = {0, 1, 2};
+    double cond[3];
+    for (int n=0; n<3; n++)
+        cond[n] = conditioning( lins, perms[n][0], perms[n][1] );
+    std::sort( order, order+3, by_conditioning(cond) );
+    for (int n=0; n<3; n++) {
+        const int* pm = perms[ order[n] ];
+        if ( qll_solver( lins, pm[0], pm[1], pm[2], quads[0], k3, slns) >= 0 || ambiguous )
+            break;
+    }
     return slns.size();
 }
 
+/// \brief conditioning of the 2x2 system of permutation (xi,yi)
+///
+/// the sine of the angle between the rows (ai,bi) and (aj,bj) of qll_solver(), in [0,1].
+/// 0 for a singular system.
+template<class Scalar>
+double conditioning( const boost::container::static_vector< Eq<Scalar>, 3 >& lins, int xi, int yi) {
+    double ai = to_double( lins[0][xi] );
+    double bi = to_double( lins[0][yi] );
+    double aj = to_double( lins[1][xi] );
+    double bj = to_double( lins[1][yi] );
+    double norms = sqrt( (ai*ai + bi*bi)*(aj*aj + bj*bj) );
+    if ( norms == 0 )
+        return 0;
+    return fabs( ai*bj - aj*bi ) / norms;
+}
+
+/// orders permutation indices by decreasing conditioning
+struct by_conditioning {
+    /// \param c conditioning of each permutation
+    by_conditioning(const double* c) : cond(c) {}
+    /// true if permutation \a a is better conditioned than \a b
+    bool operator()(int a, int b) const { return cond[a] > cond[b]; }
+    /// conditioning of each permutation
+    const double* cond;
+};
 
-private:
 /// \brief qll solver
 // l0 first linear eqn
 // l1 second linear eqn
@@ -83,31 +147,32 @@ private:
 // xk, yk, kk, rk = params of one ('last') quadratic site (point or arc)
 // solns = output solution triplets (x,y,t) or (u,v,t)
 // returns number of solutions found
-int qll_solver( const std::vector< Eq<qd_real> >& lins, int xi, int yi, int ti, 
-      const Eq<qd_real>& quad, qd_real k3, std::vector<Solution>& solns) { 
+template<class Scalar>
+int qll_solver( const boost::container::static_vector< Eq<Scalar>, 3 >& lins, int xi, int yi, int ti, 
+      const Eq<Scalar>& quad, double k3, SolutionBuffer& solns) { 
     assert( lins.size() == 2 );
-    qd_real ai = lins[0][xi]; // first linear 
-    qd_real bi = lins[0][yi];
-    qd_real ki = lins[0][ti];
-    qd_real ci = lins[0].c;
+    Scalar ai = lins[0][xi]; // first linear 
+    Scalar bi = lins[0][yi];
+    Scalar ki = lins[0][ti];
+    Scalar ci = lins[0].c;
     
-    qd_real aj = lins[1][xi]; // second linear
-    qd_real bj = lins[1][yi];
-    qd_real kj = lins[1][ti];
-    qd_real cj = lins[1].c;
+    Scalar aj = lins[1][xi]; // second linear
+    Scalar bj = lins[1][yi];
+    Scalar kj = lins[1][ti];
+    Scalar cj = lins[1].c;
     
-    qd_real d = chop( ai*bj - aj*bi ); // chop! (determinant for 2 linear eqns (?))
-    if (d == 0) // no solution can be found!
+    Scalar d = chop( ai*bj - aj*bi ); // chop! (determinant for 2 linear eqns (?))
+    if ( sign(d) == 0 ) // no solution can be found! (or d may be zero, if ambiguous)
         return -1;
     // these are the w-equations for qll_solve()
     // (2) u = a1 w + b1
     // (3) v = a2 w + b2
-    qd_real a0 =  (bi*kj - bj*ki) / d;
-    qd_real a1 = -(ai*kj - aj*ki) / d;
-    qd_real b0 =  (bi*cj - bj*ci) / d;
-    qd_real b1 = -(ai*cj - aj*ci) / d;
+    Scalar a0 =  (bi*kj - bj*ki) / d;
+    Scalar a1 = -(ai*kj - aj*ki) / d;
+    Scalar b0 =  (bi*cj - bj*ci) / d;
+    Scalar b1 = -(ai*cj - aj*ci) / d;
     // based on the 'last' quadratic of (s1,s2,s3)
-    qd_real aargs[3][2];
+    Scalar aargs[3][2];
     aargs[0][0] = 1.0;
     aargs[0][1] = quad.a;
     aargs[1][0] = 1.0;
@@ -115,7 +180,7 @@ int qll_solver( const std::vector< Eq<qd_real> >& lins, int xi, int yi, int ti,
     aargs[2][0] = -1.0;
     aargs[2][1] = quad.k;
     
-    qd_real isolns[2][3];
+    Scalar isolns[2][3];
     // this solves for w, and returns either 0, 1, or 2 triplets of (u,v,t) in isolns
     // NOTE: indexes of aargs shuffled depending on (xi,yi,ti) !
     int scount = qll_solve( aargs[xi][0], aargs[xi][1],
@@ -126,11 +191,13 @@ int qll_solver( const std::vector< Eq<qd_real> >& lins, int xi, int yi, int ti,
                             a1, b1, isolns);
     double tsolns[2][3];
     for (int i=0; i<scount; i++) {
+        if ( !accurate(isolns[i][0]) || !accurate(isolns[i][1]) || !accurate(isolns[i][2]) )
+            return 0;
         tsolns[i][xi] = to_double(isolns[i][0]);       // u       x
         tsolns[i][yi] = to_double(isolns[i][1]);       // v       y
         tsolns[i][ti] = to_double(isolns[i][2]);       // t       t  chop!
         solns.push_back( Solution( Point( tsolns[i][0], tsolns[i][1] ), 
-                         tsolns[i][2], to_double(k3) ) );
+                         tsolns[i][2], k3 ) );
     }
     //std::cout << " k3="<<kk3<<" qqq_solve found " << scount << " roots\n";
     return scount;
@@ -143,31 +210,79 @@ int qll_solver( const std::vector< Eq<qd_real> >& lins, int xi, int yi, int ti,
 /// (3) v = a2 w + b2
 /// solve (1) for w (can have 0, 1, or 2 roots)
 /// then substitute into (2) and (3) to find (u, v, t)
-int qll_solve( qd_real a0, qd_real b0, qd_real c0, qd_real d0, 
-                      qd_real e0, qd_real f0, qd_real g0, 
-                      qd_real a1, qd_real b1, 
-                      qd_real a2, qd_real b2, 
-                      qd_real soln[][3])
+template<class Scalar>
+int qll_solve( Scalar a0, Scalar b0, Scalar c0, Scalar d0, 
+                      Scalar e0, Scalar f0, Scalar g0, 
+                      Scalar a1, Scalar b1, 
+                      Scalar a2, Scalar b2, 
+                      Scalar soln[][3])
 {
     //std::cout << "qll_solver()\n";
     // TODO:  optimize using abs(a0) == abs(c0) == abs(d0) == 1
-    qd_real a = chop( (a0*(a1*a1) + c0*(a2*a2) + e0) ); 
-    qd_real b = chop( (2*a0*a1*b1 + 2*a2*b2*c0 + a1*b0 + a2*d0 + f0) ); 
-    qd_real c = a0*(b1*b1) + c0*(b2*b2) + b0*b1 + b2*d0 + g0;
-    std::vector<qd_real> roots = quadratic_roots(a, b, c); // solves a*w^2 + b*w + c = 0
-    if ( roots.empty() ) { // No roots, no solutions
+    Scalar a = chop( (a0*(a1*a1) + c0*(a2*a2) + e0) ); 
+    Scalar b = chop( (2*a0*a1*b1 + 2*a2*b2*c0 + a1*b0 + a2*d0 + f0) ); 
+    Scalar c = a0*(b1*b1) + c0*(b2*b2) + b0*b1 + b2*d0 + g0;
+    Scalar roots[2];
+    int nroots = quadratic_roots(a, b, c, roots); // solves a*w^2 + b*w + c = 0
+    if ( nroots == 0 ) { // No roots, no solutions
         return 0;
     } else {
-        for (unsigned int i=0; i<roots.size(); i++) {
-            qd_real w = roots[i];
+        for (int i=0; i<nroots; i++) {
+            Scalar w = roots[i];
             soln[i][0] = a1*w + b1; // u
             soln[i][1] = a2*w + b2; // v
             soln[i][2] = w;         // t
         }
-        return roots.size();
+        return nroots;
+    }
+}
+
+/// solve quadratic eqn: a*x*x + b*x + c = 0
+/// the branch-decisions are made with sign() so that an uncertain decision
+/// in the double or dd_real tier is flagged.
+/// returns the number of real roots (0, 1, or 2), which are written to \a roots
+template<class Scalar>
+int quadratic_roots(const Scalar& a, const Scalar& b, const Scalar& c, Scalar roots[2]) {
+    int sa = sign(a);
+    int sb = sign(b);
+    if ( (sa == 0) && (sb == 0) )
+        return 0;
+    if (sa == 0) {
+        roots[0] = -c / b;
+        return 1;
+    }
+    if (sb == 0) {
+        Scalar sqr = -c / a;
+        int ssqr = sign(sqr);
+        if (ssqr > 0) {
+            roots[0] = sqrt(sqr);
+            roots[1] = -roots[0];
+            return 2;
+        } else if (ssqr == 0) {
+            roots[0] = Scalar(0);
+            return 1;
+        } 
+        return 0;
+    }
+    Scalar disc = chop(b*b - 4*a*c); // discriminant, chop!
+    int sdisc = sign(disc);
+    if (sdisc > 0) {
+        Scalar q;
+        if (sb > 0)
+            q = (b + sqrt(disc)) / -2;
+        else
+            q = (b - sqrt(disc)) / -2;
+        roots[0] = q / a;
+        roots[1] = c / q;
+        return 2;
+    } else if (sdisc == 0) {
+        roots[0] = -b / (2*a);
+        return 1;
     }
+    return 0;
 }
 
+    bool all_perms; ///< solve along all three permutations, see set_all_permutations()
 };
 
 } // solvers
@@ -74,7 +74,7 @@ public:
 
 int solve( Site* s1, double k1, 
            Site* s2, double k2, 
-           Site* s3, double k3, std::vector<Solution>& slns ) {
+           Site* s3, double k3, SolutionBuffer& slns ) {
     assert( s1->isLine() && s2->isPoint() );
     assert( s3->isLine() ); // LineSites always inserted after PointSites. 
                             // Thus we can only have s3=LineSite
@@ -0,0 +1,266 @@
+/*
+ *  Copyright (c) 2010-2012 Anders Wallin (anders.e.e.wallin "at" gmail.com).
+ *  
+ *  This file is part of Openvoronoi 
+ *  (see https://github.com/aewallin/openvoronoi).
+ *  
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *  
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <iostream>
+
+#include <qd/qd_real.h> // http://crd.lbl.gov/~dhbailey/mpdist/
+#include <qd/dd_real.h>
+
+#include "solver.hpp"
+#include "solution.hpp"
+#include "site.hpp"
+
+namespace ovd {
+namespace solvers {
+
+/// \brief properties of the number-types used by the lower tiers of a TieredSolver
+template<class Scalar>
+struct precision;
+
+/// \brief hardware double
+template<>
+struct precision<double> {
+    /// relative error of one arithmetic operation, including the rounding of the bound itself
+    static double eps() { return std::numeric_limits<double>::epsilon(); }
+    /// value as double
+    static double dbl(double x) { return x; }
+    /// square root
+    static double root(double x) { return std::sqrt(x); }
+};
+
+/// \brief double-double
+template<>
+struct precision<dd_real> {
+    /// dd_real operations are accurate to a few units of 2^-104 (~4.9e-32). we use a conservative value.
+    static double eps() { return 1e-30; }
+    /// value as double
+    static double dbl(const dd_real& x) { return to_double(x); }
+    /// square root
+    static dd_real root(const dd_real& x) { return sqrt(x); }
+};
+
+/// \brief a floating-point value together with a forward error bound
+///
+/// The bound \a e is propagated through +,-,*,/ and sqrt with a running
+/// error analysis, so that |exact - v| <= e holds for the computed value \a v,
+/// assuming the inputs (constructed from double) are exact.
+template<class Scalar>
+struct bounded {
+    bounded() : v(0), e(0) {}
+    /// an exact input value
+    bounded(double x) : v(x), e(0) {}
+    /// \param x value
+    /// \param err error bound
+    bounded(const Scalar& x, double err) : v(x), e(err) {}
+    
+    /// computed value
+    Scalar v;
+    /// bound on the absolute error of v
+    double e;
+    
+    /// magnitude of the value
+    double mag() const { return std::fabs( precision<Scalar>::dbl(v) ); }
+    
+    /// negation is exact
+    friend bounded operator-(const bounded& a) { return bounded( -a.v, a.e ); }
+    /// sum
+    friend bounded operator+(const bounded& a, const bounded& b) {
+        bounded r( a.v+b.v, 0 );
+        r.e = a.e + b.e + precision<Scalar>::eps()*r.mag();
+        return r;
+    }
+    /// difference
+    friend bounded operator-(const bounded& a, const bounded& b) {
+        bounded r( a.v-b.v, 0 );
+        r.e = a.e + b.e + precision<Scalar>::eps()*r.mag();
+        return r;
+    }
+    /// product
+    friend bounded operator*(const bounded& a, const bounded& b) {
+        bounded r( a.v*b.v, 0 );
+        r.e = a.mag()*b.e + b.mag()*a.e + a.e*b.e + precision<Scalar>::eps()*r.mag();
+        return r;
+    }
+    /// quotient. the bound is infinite if the interval of b contains zero
+    friend bounded operator/(const bounded& a, const bounded& b) {
+        double bmin = b.mag() - b.e;
+        if ( bmin <= 0 )
+            return bounded( Scalar(0), std::numeric_limits<double>::infinity() );
+        bounded r( a.v/b.v, 0 );
+        r.e = (a.e + r.mag()*b.e)/bmin + precision<Scalar>::eps()*r.mag();
+        return r;
+    }
+    /// square root, |sqrt(x)-sqrt(v)| <= min( sqrt(e), e/sqrt(v) )
+    friend bounded sqrt(const bounded& a) {
+        if ( precision<Scalar>::dbl(a.v) <= 0 )
+            return bounded( Scalar(0), std::sqrt(a.e) );
+        bounded r( precision<Scalar>::root(a.v), 0 );
+        r.e = std::min( std::sqrt(a.e), a.e/r.mag() ) + precision<Scalar>::eps()*r.mag();
+        return r;
+    }
+    /// add \a b
+    bounded& operator+=(const bounded& b) { return *this = *this + b; }
+    /// subtract \a b
+    bounded& operator-=(const bounded& b) { return *this = *this - b; }
+    /// multiply by \a b
+    bounded& operator*=(const bounded& b) { return *this = *this * b; }
+    /// the value as double
+    friend double to_double(const bounded& a) { return precision<Scalar>::dbl(a.v); }
+    /// print value and bound
+    friend std::ostream& operator<<(std::ostream& stream, const bounded& a) {
+        stream << a.v << "(+/-" << a.e << ")";
+        return stream;
+    }
+};
+
+/// \brief the equation of a Site, in the number-type \a Scalar of a tier
+///
+/// the double and dd_real tiers convert the Eq<double> cached by the Site.
+template<class Scalar>
+struct site_equation {
+    /// a converted copy
+    typedef Eq<Scalar> type;
+    /// equation of site \a s in offset direction \a k
+    static type get(const Site* s, double k) {
+        Eq<Scalar> e;
+        e = s->eqp(k);
+        return e;
+    }
+};
+
+/// \brief the qd_real tier reads the Eq<qd_real> cached by the Site, without a copy
+template<>
+struct site_equation<qd_real> {
+    /// a reference to the cache
+    typedef const Eq<qd_real>& type;
+    /// equation of site \a s in offset direction \a k
+    static type get(const Site* s, double k) { return s->eqp_qd(k); }
+};
+
+/// \brief precision tiers of a TieredSolver, in the order they are tried
+enum SolverTier { DOUBLE_TIER = 0, DD_TIER = 1, QD_TIER = 2 };
+/// number of SolverTier values
+const int NUM_SOLVER_TIERS = 3;
+
+/// \brief base-class for solvers that run in double first, and in higher precision only on demand
+///
+/// The derived solver is written once, as a template on the number-type, and
+/// is run with bounded<double>, then bounded<dd_real>, and finally qd_real.
+/// The first tier where all branch-decisions were certain (see sign() and chop())
+/// and all solution coordinates are within the tolerance (see accurate()) is accepted.
+/// qd_real, the last tier, is always accepted as before.
+/// The number of accepted solves per tier is counted.
+///
+/// \a Derived is the solver class itself. It implements solve_tier(), with the arguments
+/// of solve() after the SolverTier, by calling its templated solver with the number-type
+/// of the tier. Derived declares this class a friend, so solve_tier() can stay protected. The call
+/// from solve() is resolved at compile time, so that a call to Derived::solve()
+/// (see VertexPositioner::solver_dispatch()) has no virtual calls.
+template<class Derived>
+class TieredSolver : public Solver {
+public:
+    TieredSolver() : tolerance(1e-12), ambiguous(false) { reset_tier_counts(); }
+    
+    /// \brief solve in each tier in turn, until the result is certain
+    ///
+    /// arguments as in Solver::solve()
+    int solve( Site* s1, double k1, 
+               Site* s2, double k2, 
+               Site* s3, double k3, SolutionBuffer& slns ) {
+        std::size_t n = slns.size();
+        for (int tier=DOUBLE_TIER; tier<=QD_TIER; tier++) {
+            ambiguous = false;
+            int count = static_cast<Derived*>(this)->solve_tier( (SolverTier)tier, s1, k1, s2, k2, s3, k3, slns );
+            if ( !ambiguous || tier == QD_TIER ) {
+                tier_hits[tier]++;
+                return count;
+            }
+            if (debug && !silent)
+                std::cout << " TieredSolver: tier " << tier << " is not accurate enough.\n";
+            slns.erase( slns.begin()+n, slns.end() ); // discard solutions of this tier
+        }
+        return 0;
+    }
+    /// return the number of solves accepted in tier \a tier
+    unsigned int tier_count(int tier) const { return tier_hits[tier]; }
+    /// set all tier counters to zero
+    void reset_tier_counts() { std::fill( tier_hits, tier_hits+NUM_SOLVER_TIERS, 0u ); }
+    /// set the (relative) accuracy required from the double and dd_real tiers
+    void set_tolerance(double tol) { tolerance = tol; }
+protected:
+    /// certain sign of \a x. flags the tier as ambiguous if the error bound straddles zero
+    template<class Scalar>
+    int sign(const bounded<Scalar>& x) {
+        double val = to_double(x);
+        if ( val > x.e )
+            return 1;
+        if ( -val > x.e )
+            return -1;
+        if ( !(val == 0 && x.e == 0) )
+            ambiguous = true;
+        return 0;
+    }
+    /// sign of \a x in the qd_real tier
+    int sign(const qd_real& x) { return (x > 0) ? 1 : ( (x < 0) ? -1 : 0 ); }
+    
+    /// true if |x| < tol. flags the tier as ambiguous if this cannot be decided.
+    template<class Scalar>
+    bool below(const bounded<Scalar>& x, double tol) {
+        if ( x.mag() + x.e < tol )
+            return true;
+        if ( x.mag() - x.e >= tol )
+            return false;
+        ambiguous = true;
+        return false;
+    }
+    /// |x| < tol in the qd_real tier
+    bool below(const qd_real& x, double tol) { return fabs(x) < tol; }
+    
+    /// same as numeric::chop(qd_real), for all tiers.
+    template<class Scalar>
+    Scalar chop(const Scalar& x) { return below(x, 1e-20) ? Scalar(0) : x; }
+    
+    /// true if the error bound of \a x is within the tolerance.
+    /// flags the tier as ambiguous otherwise.
+    template<class Scalar>
+    bool accurate(const bounded<Scalar>& x) {
+        if ( x.e <= tolerance*std::max(1.0, x.mag()) )
+            return true;
+        ambiguous = true;
+        return false;
+    }
+    /// the qd_real tier is always accurate
+    bool accurate(const qd_real& ) { return true; }
+    
+    /// required accuracy of the solution coordinates
+    double tolerance;
+    /// set when a decision or a solution in the current tier could not be certified
+    bool ambiguous;
+    /// number of accepted solves, per tier
+    unsigned int tier_hits[NUM_SOLVER_TIERS];
+};
+
+} // solvers
+} // ovd
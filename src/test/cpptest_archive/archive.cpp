@@ -0,0 +1,209 @@
+// OpenVoronoi save() and load() example
+#include <string>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+
+#include "voronoidiagram.hpp"
+#include "offset.hpp"
+#include "medial_axis_filter.hpp"
+#include "medial_axis_walk.hpp"
+#include "polygon_interior_filter.hpp"
+#include "version.hpp"
+
+#include <boost/random.hpp>
+#include <boost/foreach.hpp>
+#include <boost/program_options.hpp>
+
+namespace po = boost::program_options;
+
+/// the vertices of a random star-shaped polygon with \a n vertices, followed by \a n random points inside it
+std::vector<ovd::Point> random_points(int n, unsigned int seed) {
+    boost::mt19937 rng(seed);
+    boost::uniform_01<boost::mt19937> rnd(rng);
+    std::vector<ovd::Point> pts;
+    for (int m=0; m<n; ++m) {
+        double a = 2*M_PI*m/n;
+        double r = 0.5+0.4*rnd();
+        pts.push_back( ovd::Point( r*cos(a), r*sin(a) ) );
+    }
+    for (int m=0; m<n; ++m) {
+        double a = 2*M_PI*rnd();
+        double r = 0.3*rnd();
+        pts.push_back( ovd::Point( r*cos(a), r*sin(a) ) );
+    }
+    return pts;
+}
+
+/// \brief vertex positions and clearance radii, and edge types and faces, in sorted order
+///
+/// sorted, since the flat graph re-uses the slots of removed vertices and edges, so after further
+/// insertions the graph order of a loaded diagram differs from the original.
+std::vector< std::vector<double> > signature(ovd::VoronoiDiagram& vd) {
+    ovd::HEGraph& g = vd.get_graph_reference();
+    std::vector< std::vector<double> > out;
+    BOOST_FOREACH( ovd::HEVertex v, g.vertices() ) {
+        std::vector<double> item;
+        item.push_back( g[v].position.x );
+        item.push_back( g[v].position.y );
+        item.push_back( g[v].dist() );
+        out.push_back(item);
+    }
+    BOOST_FOREACH( ovd::HEEdge e, g.edges() ) {
+        std::vector<double> item;
+        item.push_back( g[e].type );
+        item.push_back( g[e].face );
+        item.push_back( g[g[e].next].face );
+        item.push_back( g[g.source(e)].position.x );
+        item.push_back( g[g.target(e)].position.x );
+        out.push_back(item);
+    }
+    std::sort( out.begin(), out.end() );
+    return out;
+}
+
+/// number of offset-vertices at a few offset distances
+std::vector<int> offset_signature(ovd::VoronoiDiagram& vd) {
+    ovd::Offset of( vd.get_graph_reference() );
+    std::vector<int> out;
+    for (double d=0.01; d<0.3; d+=0.05) {
+        ovd::OffsetLoops loops = of.offset(d);
+        out.push_back( loops.size() );
+        BOOST_FOREACH( const ovd::OffsetLoop& l, loops )
+            out.push_back( l.vertices.size() );
+    }
+    return out;
+}
+
+/// number of medial-axis points of the polygon interior
+int medial_axis_points(ovd::VoronoiDiagram& vd) {
+    ovd::polygon_interior_filter pi(true);
+    vd.filter(&pi);
+    ovd::medial_axis_filter ma;
+    vd.filter(&ma);
+    ovd::MedialAxisWalk maw( vd.get_graph_reference() );
+    ovd::MedialChainList chains = maw.walk();
+    vd.filter_reset();
+    int out = 0;
+    BOOST_FOREACH( const ovd::MedialChain& chain, chains ) {
+        BOOST_FOREACH( const ovd::MedialPointList& pt_list, chain )
+            out += pt_list.size();
+    }
+    return out;
+}
+
+/// true if \a loaded is a copy of \a vd
+bool same(ovd::VoronoiDiagram& vd, ovd::VoronoiDiagram& loaded) {
+    if ( loaded.num_point_sites() != vd.num_point_sites() || loaded.num_line_sites() != vd.num_line_sites() ||
+         loaded.num_vertices() != vd.num_vertices() || loaded.num_faces() != vd.num_faces() ) {
+        std::cout << "ERROR: loaded diagram has different number of sites, vertices, or faces\n";
+        return false;
+    }
+    if ( signature(loaded) != signature(vd) || !loaded.check() ) {
+        std::cout << "ERROR: loaded diagram differs\n";
+        return false;
+    }
+    if ( offset_signature(loaded) != offset_signature(vd) ) {
+        std::cout << "ERROR: offsets of loaded diagram differ\n";
+        return false;
+    }
+    if ( medial_axis_points(loaded) != medial_axis_points(vd) ) {
+        std::cout << "ERROR: medial axis of loaded diagram differs\n";
+        return false;
+    }
+    return true;
+}
+
+/// \brief save a diagram, load it from a buffer and from a file, and insert more sites into the loaded diagrams
+///
+/// point-sites must be inserted before line-sites, so the point-sites are saved and loaded first,
+/// and then the polygon is inserted into both the saved and the loaded diagram.
+bool save_and_load(int n, bool grid, unsigned int seed) {
+    ovd::VoronoiDiagram vd(1, grid ? 10 : 0);
+    std::vector<int> ids = vd.insert_point_sites( random_points(n, seed) );
+    std::ostringstream out;
+    vd.save(out);
+    std::string buf = out.str();
+    std::cout << vd.num_point_sites() << " point-sites, " << vd.num_vertices() << " vertices saved in "
+              << buf.size() << " bytes\n";
+    
+    ovd::VoronoiDiagram loaded(2, grid ? 5 : 0);
+    loaded.set_silent(true);
+    std::vector< std::vector<double> > empty = signature(loaded);
+    if ( loaded.load( buf.data(), buf.size()-1 ) || loaded.load( buf.data()+1, buf.size()-1 ) ||
+         signature(loaded) != empty ) {
+        std::cout << "ERROR: a truncated archive was loaded, or modified the diagram\n";
+        return false;
+    }
+    if ( !loaded.load( buf.data(), buf.size() ) || signature(loaded) != signature(vd) || !loaded.check() ) {
+        std::cout << "ERROR: loaded diagram differs\n";
+        return false;
+    }
+    
+    // the loaded diagram continues where the saved one stopped
+    std::vector<int> polygon( ids.begin(), ids.begin()+n );
+    if ( !vd.insert_polyline(polygon, true) || !loaded.insert_polyline(polygon, true) ) {
+        std::cout << "ERROR: insertion into loaded diagram failed\n";
+        return false;
+    }
+    if ( !same(vd, loaded) )
+        return false;
+    
+    const std::string filename = "cpptest_archive.ovdb";
+    ovd::VoronoiDiagram mapped(1, 0);
+    mapped.use_face_grid(grid);
+    if ( !vd.save_file(filename) || !mapped.load_file(filename) || !same(vd, mapped) ) {
+        std::cout << "ERROR: save_file() or load_file() failed\n";
+        return false;
+    }
+    std::remove( filename.c_str() );
+    if ( mapped.load_file(filename) ) {
+        std::cout << "ERROR: missing file was loaded\n";
+        return false;
+    }
+    if ( !vd.insert_line_site( ids[n], ids[n+1] ) || !mapped.insert_line_site( ids[n], ids[n+1] ) ||
+         signature(mapped) != signature(vd) || !mapped.check() ) {
+        std::cout << "ERROR: insertion into memory-mapped diagram gives a different diagram\n";
+        return false;
+    }
+    std::cout << vd.num_line_sites() << " line-sites inserted after loading\n";
+    return true;
+}
+
+/// \test save a diagram, and compare it to the loaded copy
+int main(int argc,char *argv[]) {
+    po::options_description desc("This program checks VoronoiDiagram::save() and load()\n Allowed options");
+    desc.add_options()
+        ("help", "produce help message")
+        ("n", po::value<int>(), "set number of polygon vertices and random point-sites")
+        ("s", po::value<int>(), "seed for random number generator")
+        ("g", "use the bucket-grid for point location, instead of the kd-tree")
+    ;
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (vm.count("help")) {
+        std::cout << desc << "\n";
+        return 1;
+    }
+
+    int n = 50;
+    unsigned int seed = 42;
+    if (vm.count("n"))
+        n = vm["n"].as<int>();
+    if (vm.count("s"))
+        seed = vm["s"].as<int>();
+
+    std::cout << "version: " << ovd::version() << "\n";
+    if ( !save_and_load(n, vm.count("g")>0, seed) ) {
+        std::cout << "ERROR: save() and load() failed\n";
+        return -1;
+    }
+    std::cout << "save() and load() OK\n";
+    return 0;
+}
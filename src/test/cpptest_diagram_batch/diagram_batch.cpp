@@ -0,0 +1,106 @@
+// OpenVoronoi DiagramBatch example
+#include <string>
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#include "voronoidiagram.hpp"
+#include "diagram_batch.hpp"
+#include "version.hpp"
+
+#include <boost/random.hpp>
+#include <boost/timer.hpp>
+#include <boost/program_options.hpp>
+
+namespace po = boost::program_options;
+
+/// a random star-shaped polygon around the origin, as point-sites and closing segments
+ovd::BatchSites random_polygon(boost::uniform_01<boost::mt19937>& rnd, unsigned int n) {
+    ovd::BatchSites s;
+    std::vector<double> angles;
+    for (unsigned int m=0;m<n;m++)
+        angles.push_back( 2*M_PI*rnd() );
+    std::sort( angles.begin(), angles.end() );
+    for (unsigned int m=0;m<n;m++) {
+        double r = 0.2+0.2*rnd();
+        s.points.push_back( ovd::Point( r*cos(angles[m]), r*sin(angles[m]) ) );
+        s.segments.push_back( std::make_pair( (int)m, (int)((m+1)%n) ) );
+    }
+    return s;
+}
+
+/// \test build many polygons with DiagramBatch, and compare to a serial build
+int main(int argc,char *argv[]) {
+    po::options_description desc("This program builds many random polygons on a thread pool\n Allowed options");
+    desc.add_options()
+        ("help", "produce help message")
+        ("n", po::value<int>(), "set number of vertices per polygon")
+        ("k", po::value<int>(), "set number of polygons")
+        ("t", po::value<int>(), "set number of threads (0 uses one per hardware thread)")
+        ("o", "compute offsets as a follow-on task")
+    ;
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (vm.count("help")) {
+        std::cout << desc << "\n";
+        return 1;
+    }
+
+    unsigned int nmax = 20;
+    unsigned int kmax = 16;
+    unsigned int threads = 4;
+    if (vm.count("n"))
+        nmax = vm["n"].as<int>();
+    if (vm.count("k"))
+        kmax = vm["k"].as<int>();
+    if (vm.count("t"))
+        threads = vm["t"].as<int>();
+
+    std::cout << "version: " << ovd::version() << "\n";
+    boost::mt19937 rng(42);
+    boost::uniform_01<boost::mt19937> rnd(rng);
+
+    std::vector<ovd::BatchSites> inputs;
+    for (unsigned int k=0;k<kmax;k++) {
+        inputs.push_back( random_polygon(rnd, nmax) );
+        if (vm.count("o"))
+            inputs.back().offsets.push_back(0.05);
+    }
+
+    ovd::DiagramBatch batch(threads);
+    std::cout << kmax << " polygons with " << nmax << " vertices on " << batch.num_threads() << " threads\n";
+    boost::timer tmr;
+    std::vector<ovd::DiagramBatch::Handle> handles;
+    for (unsigned int k=0;k<kmax;k++)
+        handles.push_back( batch.add( inputs[k] ) );
+    batch.wait();
+    std::cout << tmr.elapsed() << " seconds \n";
+
+    for (unsigned int k=0;k<kmax;k++) {
+        ovd::VoronoiDiagram* vd = batch.diagram( handles[k] );
+        // the same polygon built serially must give the same diagram
+        ovd::VoronoiDiagram serial(inputs[k].far, std::max( 1, (int)sqrt( (double)nmax ) ) );
+        serial.set_silent(true);
+        std::vector<int> ids;
+        for (unsigned int m=0;m<nmax;m++)
+            ids.push_back( serial.insert_point_site( inputs[k].points[m] ) );
+        for (unsigned int m=0;m<nmax;m++)
+            serial.insert_line_site( ids[m], ids[(m+1)%nmax] );
+        if ( !batch.ok( handles[k] ) || !vd->check() ||
+             vd->num_vertices() != serial.num_vertices() ||
+             vd->num_faces() != serial.num_faces() ) {
+            std::cout << "ERROR: polygon " << k << " differs from the serial build\n";
+            return -1;
+        }
+        if ( vm.count("o") && batch.offsets( handles[k] ).size() != 1 ) {
+            std::cout << "ERROR: polygon " << k << " has no offsets\n";
+            return -1;
+        }
+    }
+    std::cout << "all " << kmax << " diagrams OK\n";
+    return 0;
+}
@@ -5,6 +5,7 @@
 #include <iostream>
 #include <vector>
 #include <cmath>
+#include <algorithm>
 
 #include "voronoidiagram.hpp"
 #include "version.hpp"
@@ -24,6 +25,7 @@ int main(int argc,char *argv[]) {
         ("help", "produce help message")
         //("n", po::value<int>(), "set number of line-segments")
         ("d",  "run in debug-mode")
+        ("p",  "insert the line-segments with insert_polyline()")
     ;
 
     po::variables_map vm;
@@ -69,11 +71,44 @@ int main(int argc,char *argv[]) {
     }
     
     // now we insert line-segments
-    for (unsigned int n=0;n<vertex_ids.size();n++) {
-        int next=n+1;
-        if (n==(vertex_ids.size()-1))
-            next=0;
-        vd->insert_line_site( vertex_ids[n], vertex_ids[next]);
+    if (vm.count("p")) {
+        // the whole closed polygon in one call
+        if ( !vd->insert_polyline( vertex_ids, true ) || !vd->check() )
+            return -1;
+        // insert_polyline() reuses the null-face and seed candidates of the previous segment.
+        // the diagram must be the same as with one insert_line_site() call for each segment
+        ovd::VoronoiDiagram vd2(1,10);
+        std::vector<int> ids2;
+        BOOST_FOREACH(ovd::Point p, vertices )
+            ids2.push_back( vd2.insert_point_site(p) );
+        for (unsigned int n=0;n<ids2.size();n++)
+            vd2.insert_line_site( ids2[n], ids2[ (n+1) % ids2.size() ] );
+        ovd::DiagramSnapshot s1 = vd->snapshot();
+        ovd::DiagramSnapshot s2 = vd2.snapshot();
+        if ( s1.num_vertices() != s2.num_vertices() || s1.num_edges() != s2.num_edges() ) {
+            std::cout << "ERROR: insert_polyline() " << s1.num_vertices() << " vertices, insert_line_site() " << s2.num_vertices() << "\n";
+            return -1;
+        }
+        std::vector< std::pair<double,double> > pos1, pos2;
+        for (unsigned int v=0; v<s1.num_vertices(); v++) {
+            pos1.push_back( std::make_pair( s1.position(v).x, s1.position(v).y ) );
+            pos2.push_back( std::make_pair( s2.position(v).x, s2.position(v).y ) );
+        }
+        std::sort( pos1.begin(), pos1.end() );
+        std::sort( pos2.begin(), pos2.end() );
+        for (unsigned int v=0; v<pos1.size(); v++) {
+            if ( fabs(pos1[v].first-pos2[v].first) > 1e-9 || fabs(pos1[v].second-pos2[v].second) > 1e-9 ) {
+                std::cout << "ERROR: insert_polyline() and insert_line_site() vertices differ\n";
+                return -1;
+            }
+        }
+    } else {
+        for (unsigned int n=0;n<vertex_ids.size();n++) {
+            int next=n+1;
+            if (n==(vertex_ids.size()-1))
+                next=0;
+            vd->insert_line_site( vertex_ids[n], vertex_ids[next]);
+        }
     }
     
     std::cout << " Correctness-check: " << vd->check() << "\n";
@@ -0,0 +1,215 @@
+// OpenVoronoi snapshot publishing example
+#include <string>
+#include <iostream>
+#include <vector>
+#include <cmath>
+
+#include "voronoidiagram.hpp"
+#include "diagram_snapshot.hpp"
+#include "offset.hpp"
+#include "version.hpp"
+
+#include <boost/random.hpp>
+#include <boost/foreach.hpp>
+#include <boost/bind/bind.hpp>
+#include <boost/thread.hpp>
+#include <boost/weak_ptr.hpp>
+#include <boost/program_options.hpp>
+
+namespace po = boost::program_options;
+
+/// the vertices of a random star-shaped polygon with \a n vertices, followed by \a n random points inside it
+std::vector<ovd::Point> random_points(int n, unsigned int seed) {
+    boost::mt19937 rng(seed);
+    boost::uniform_01<boost::mt19937> rnd(rng);
+    std::vector<ovd::Point> pts;
+    for (int m=0; m<n; ++m) {
+        double a = 2*M_PI*m/n;
+        double r = 0.5+0.4*rnd();
+        pts.push_back( ovd::Point( r*cos(a), r*sin(a) ) );
+    }
+    for (int m=0; m<n; ++m) {
+        double a = 2*M_PI*rnd();
+        double r = 0.3*rnd();
+        pts.push_back( ovd::Point( r*cos(a), r*sin(a) ) );
+    }
+    return pts;
+}
+
+/// true if the offset loops are equal
+bool same_offsets(const ovd::OffsetLoops& a, const ovd::OffsetLoops& b) {
+    if ( a.size() != b.size() )
+        return false;
+    for (unsigned int n=0; n<a.size(); ++n) {
+        if ( a[n].vertices.size() != b[n].vertices.size() )
+            return false;
+        std::list<ovd::OffsetVertex>::const_iterator ia = a[n].vertices.begin();
+        std::list<ovd::OffsetVertex>::const_iterator ib = b[n].vertices.begin();
+        for ( ; ia != a[n].vertices.end(); ++ia, ++ib ) {
+            if ( ia->p != ib->p || ia->r != ib->r || ia->c != ib->c || ia->cw != ib->cw || ia->f != ib->f )
+                return false;
+        }
+    }
+    return true;
+}
+
+/// state shared by the writer and the readers
+struct Shared {
+    Shared(): done(false), reads(0), errors(0) {}
+    boost::mutex mutex; ///< protects the members below
+    bool done;          ///< the writer has finished
+    int reads;          ///< snapshots read
+    int errors;         ///< inconsistent snapshots
+};
+
+/// \brief reader thread: take the published snapshot, check it and compute an offset, until the writer is done
+///
+/// the versions must not decrease, and each snapshot must be a valid diagram.
+/// the reader pauses between snapshots, so that it does not starve the writer of cpu.
+void reader(ovd::VoronoiDiagram* vd, Shared* sh) {
+    unsigned int last_version = 0;
+    int reads = 0, errors = 0;
+    for (;;) {
+        {
+            boost::mutex::scoped_lock lock(sh->mutex);
+            if (sh->done)
+                break;
+        }
+        ovd::SnapshotPtr s = vd->published();
+        if (!s) {
+            errors++;
+            break;
+        }
+        if ( s->version() < last_version )
+            errors++;
+        last_version = s->version();
+        for (unsigned int e=0; e<s->num_edges(); ++e) {
+            unsigned int tw = s->twin(e);
+            if ( tw != ovd::DiagramSnapshot::NONE && s->twin(tw) != e )
+                errors++;
+        }
+        // a diagram with few sites may have no offset at this distance, so only
+        // check that each offset vertex refers to a face of the snapshot
+        ovd::OffsetLoops loops = s->offset(0.05);
+        BOOST_FOREACH( const ovd::OffsetLoop& loop, loops ) {
+            BOOST_FOREACH( const ovd::OffsetVertex& ov, loop.vertices ) {
+                if ( ov.f >= s->num_faces() )
+                    errors++;
+            }
+        }
+        reads++;
+        boost::this_thread::sleep( boost::posix_time::milliseconds(1) );
+    }
+    boost::mutex::scoped_lock lock(sh->mutex);
+    sh->reads += reads;
+    sh->errors += errors;
+}
+
+/// \brief build a diagram while \a n_threads readers query the published snapshots
+bool concurrent_readers(int n, int n_threads, unsigned int interval, unsigned int seed) {
+    std::vector<ovd::Point> pts = random_points(n, seed);
+    ovd::VoronoiDiagram vd(1, 0);
+    vd.set_silent(true);
+    vd.use_snapshot_publishing(true, interval);
+    Shared sh;
+    boost::thread_group threads;
+    for (int m=0; m<n_threads; ++m)
+        threads.create_thread( boost::bind( reader, &vd, &sh ) );
+    std::vector<int> ids;
+    BOOST_FOREACH( const ovd::Point& p, pts ) {
+        ids.push_back( vd.insert_point_site(p) );
+    }
+    ids.resize(n);
+    vd.insert_polyline(ids, true);
+    {
+        boost::mutex::scoped_lock lock(sh.mutex);
+        sh.done = true;
+    }
+    threads.join_all();
+    std::cout << n_threads << " readers took " << sh.reads << " snapshots during " << vd.num_changes() << " changes\n";
+    if ( sh.errors ) {
+        std::cout << "ERROR: readers found " << sh.errors << " errors\n";
+        return false;
+    }
+    // insert_polyline() publishes its last segment, whatever the interval
+    ovd::SnapshotPtr last = vd.published();
+    if ( !last || last->version() != vd.num_changes() || last->num_edges() != vd.get_graph_reference().num_edges() ) {
+        std::cout << "ERROR: the last change was not published\n";
+        return false;
+    }
+    
+    // offsets of a snapshot are the same as the offsets of the diagram
+    ovd::Offset of( vd.get_graph_reference() );
+    for (double t=0.01; t<0.3; t+=0.03) {
+        if ( !same_offsets( last->offset(t), of.offset(t) ) ) {
+            std::cout << "ERROR: offset of snapshot at t=" << t << " differs\n";
+            return false;
+        }
+    }
+    
+    // old versions are deleted when the last holder drops them
+    boost::weak_ptr<const ovd::DiagramSnapshot> dropped = vd.published();
+    ovd::SnapshotPtr held = vd.published();
+    last.reset();
+    held.reset();
+    vd.publish();
+    if ( !dropped.expired() ) {
+        std::cout << "ERROR: snapshot without readers was not deleted\n";
+        return false;
+    }
+    held = vd.published();
+    dropped = held;
+    vd.publish();
+    if ( dropped.expired() || held->version() != vd.num_changes() ) {
+        std::cout << "ERROR: snapshot was deleted while held by a reader\n";
+        return false;
+    }
+    vd.use_snapshot_publishing(false);
+    if ( vd.published() ) {
+        std::cout << "ERROR: snapshot published after publishing was turned off\n";
+        return false;
+    }
+    return true;
+}
+
+/// \test publish snapshots while reader threads query them
+int main(int argc,char *argv[]) {
+    po::options_description desc("This program checks VoronoiDiagram::use_snapshot_publishing()\n Allowed options");
+    desc.add_options()
+        ("help", "produce help message")
+        ("n", po::value<int>(), "set number of polygon vertices and random point-sites")
+        ("t", po::value<int>(), "number of reader threads")
+        ("i", po::value<int>(), "publish every i changes")
+        ("s", po::value<int>(), "seed for random number generator")
+    ;
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (vm.count("help")) {
+        std::cout << desc << "\n";
+        return 1;
+    }
+
+    int n = 100;
+    int n_threads = 2;
+    unsigned int interval = 1;
+    unsigned int seed = 42;
+    if (vm.count("n"))
+        n = vm["n"].as<int>();
+    if (vm.count("t"))
+        n_threads = vm["t"].as<int>();
+    if (vm.count("i"))
+        interval = vm["i"].as<int>();
+    if (vm.count("s"))
+        seed = vm["s"].as<int>();
+
+    std::cout << "version: " << ovd::version() << "\n";
+    if ( !concurrent_readers(n, n_threads, interval, seed) ) {
+        std::cout << "ERROR: snapshot publishing failed\n";
+        return -1;
+    }
+    std::cout << "snapshot publishing OK\n";
+    return 0;
+}
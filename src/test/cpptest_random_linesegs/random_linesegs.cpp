@@ -3,6 +3,7 @@
 #include <iostream>
 #include <vector>
 #include <cmath>
+#include <algorithm>
 
 #include "voronoidiagram.hpp"
 #include "version.hpp"
@@ -83,6 +84,50 @@ std::vector<segment> random_segments(double far,int Nmax) {
     return segs;
 }
 
+// insert the segments into a new diagram, with the given QLLSolver mode
+ovd::VoronoiDiagram* build_diagram(std::vector<segment>& segs, int bins, ovd::QLLMode mode) {
+    ovd::VoronoiDiagram* vd = new ovd::VoronoiDiagram(1,10*bins);
+    vd->set_qll_mode(mode);
+    std::vector< std::pair<int,int> > ids;
+    BOOST_FOREACH(segment s, segs )
+        ids.push_back( std::make_pair( vd->insert_point_site(s.first), vd->insert_point_site(s.second) ) );
+    for (unsigned int n=0; n<ids.size(); n++)
+        vd->insert_line_site(ids[n].first, ids[n].second);
+    return vd;
+}
+
+// build the diagram with forced QLLSolver escalation, and with all permutations always solved.
+// escalation must have happened, and the two diagrams must be the same.
+int check_escalation(std::vector<segment>& segs, int bins) {
+    ovd::VoronoiDiagram* vd_esc = build_diagram(segs, bins, ovd::QLL_FORCE_ESCALATION);
+    ovd::VoronoiDiagram* vd_all = build_diagram(segs, bins, ovd::QLL_ALL_PERMUTATIONS);
+    int errors = 0;
+    std::cout << "QLL escalations: " << vd_esc->num_qll_escalations() << " forced, " 
+              << vd_all->num_qll_escalations() << " with all permutations\n";
+    if ( vd_esc->num_qll_escalations() == 0 || vd_all->num_qll_escalations() != 0 )
+        errors++;
+    if ( !vd_esc->check() || !vd_all->check() )
+        errors++;
+    ovd::DiagramSnapshot esc = vd_esc->snapshot();
+    ovd::DiagramSnapshot all = vd_all->snapshot();
+    if ( esc.num_vertices() != all.num_vertices() || esc.num_edges() != all.num_edges() ) {
+        std::cout << "ERROR: " << esc.num_vertices() << " vertices with forced escalation, " 
+                  << all.num_vertices() << " with all permutations\n";
+        errors++;
+    } else {
+        for (unsigned int v=0; v<esc.num_vertices(); v++) {
+            if ( (esc.position(v) - all.position(v)).norm() > 1e-9 ) {
+                std::cout << "ERROR: vertex " << esc.vertex_index(v) << " at " << esc.position(v) 
+                          << " with forced escalation, " << all.position(v) << " with all permutations\n";
+                errors++;
+            }
+        }
+    }
+    delete vd_esc;
+    delete vd_all;
+    return errors;
+}
+
 // random points
 int main(int argc,char *argv[]) {
     // Declare the supported options.
@@ -91,6 +136,8 @@ int main(int argc,char *argv[]) {
         ("help", "produce help message")
         ("n", po::value<int>(), "set number of line-segments")
         ("d",  "run in debug-mode")
+        ("s",  "insert all line-sites with one insert_line_sites() call (chains in Hilbert order)")
+        ("e",  "check that forced QLLSolver escalation gives the same diagram as solving all permutations")
     ;
 
     po::variables_map vm;
@@ -131,6 +178,12 @@ int main(int argc,char *argv[]) {
     std::vector<segment> segs = random_segments(1,nmax); // creante nmax random non-intersecting segments.
     std::cout << "done in " << tmr.elapsed() << " seconds\n" << std::flush;
     std::cout << "number of segs: " << segs.size() << "\n" << std::flush;
+    if (vm.count("e")) {
+        delete vd;
+        int errors = check_escalation(segs, bins);
+        std::cout << errors << " errors\n";
+        return errors ? -1 : 0;
+    }
     typedef std::pair<int,int> IdSeg; // the int-handles for a segment
     typedef std::vector< IdSeg > IdSegments; // all the segments stored in this vector
     IdSegments segment_ids;
@@ -146,8 +199,16 @@ int main(int argc,char *argv[]) {
     std::cout << "all point-sites inserted !\n"<< std::flush;
     // now we insert line-segments
     tmr.restart();
-    BOOST_FOREACH(IdSeg id, segment_ids ) {
-        vd->insert_line_site(id.first,id.second); // NOTE: arguments are the int-handles we got from VoronoiDiagram::insert_point_site() above!
+    if (vm.count("s")) {
+        std::vector<bool> ok = vd->insert_line_sites(segment_ids);
+        if ( std::count( ok.begin(), ok.end(), true ) != (int)segment_ids.size() || !vd->check() ) {
+            std::cout << "ERROR: insert_line_sites() failed\n";
+            return -1;
+        }
+    } else {
+        BOOST_FOREACH(IdSeg id, segment_ids ) {
+            vd->insert_line_site(id.first,id.second); // NOTE: arguments are the int-handles we got from VoronoiDiagram::insert_point_site() above!
+        }
     }
     double t_lines = tmr.elapsed();
     std::cout << "all line-sites inserted !\n"<< std::flush;
@@ -157,6 +218,7 @@ int main(int argc,char *argv[]) {
     double norm = 2*nmax*log(2*(double)nmax)/log(2.0);
     std::cout << "Points: " << 1e6*t_points/norm << " us * n*log2(n)\n";
     std::cout << "Lines: " << 1e6*t_lines/norm << " us * n*log2(n)\n";
+    std::cout << "QLL escalations: " << vd->num_qll_escalations() << "\n";
     std::cout << vd->print();
     vd2svg("random_segments.svg", vd);
     delete vd;
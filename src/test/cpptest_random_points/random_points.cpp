@@ -3,6 +3,7 @@
 #include <iostream>
 #include <vector>
 #include <cmath>
+#include <algorithm>
 
 #include "voronoidiagram.hpp"
 #include "version.hpp"
@@ -22,7 +23,10 @@ int main(int argc,char *argv[]) {
     desc.add_options()
         ("help", "produce help message")
         ("n", po::value<int>(), "set number of points")
-        ("b", po::value<int>(), "set bin-count multiplier")
+        ("b", po::value<int>(), "set bin-count multiplier (0 uses a kd-tree instead of the bucket-grid)")
+        ("w", "use jump-and-walk point location")
+        ("r", "insert the points, reset() the diagram, and insert them again")
+        ("s", "insert all points with one insert_point_sites() call (BRIO and Hilbert order)")
     ;
 
     po::variables_map vm;
@@ -49,6 +53,10 @@ int main(int argc,char *argv[]) {
     ovd::VoronoiDiagram* vd = new ovd::VoronoiDiagram(1,binmult*bins);
     
     std::cout << "version: " << ovd::version() << "\n";
+    if (vm.count("w")) {
+        std::cout << "using jump-and-walk point location\n";
+        vd->use_jump_and_walk(true);
+    }
     
     boost::mt19937 rng(42); // mersenne-twister random number generator
     boost::uniform_01<boost::mt19937> rnd(rng);
@@ -61,13 +69,37 @@ int main(int argc,char *argv[]) {
         pts.push_back(p);
     }
     boost::timer tmr;
-    BOOST_FOREACH(ovd::Point p, pts ) {
-        vd->insert_point_site(p); // insert each point. This returns an int-handle which we do not use here.
+    if (vm.count("s")) {
+        std::cout << "bulk insertion with insert_point_sites()\n";
+        std::vector<int> ids = vd->insert_point_sites(pts);
+        std::sort( ids.begin(), ids.end() );
+        if ( ids.size() != pts.size() || std::unique( ids.begin(), ids.end() ) != ids.end() ) {
+            std::cout << "ERROR: insert_point_sites() returned duplicate handles\n";
+            return -1;
+        }
+    } else {
+        BOOST_FOREACH(ovd::Point p, pts ) {
+            vd->insert_point_site(p); // insert each point. This returns an int-handle which we do not use here.
+        }
     }
     double t = tmr.elapsed();
     std::cout << t << " seconds \n";
     double norm = nmax*log((double)nmax)/log(2.0);
     std::cout << 1e6*t/norm << " us * n*log2(n)\n";
+    if (vm.count("r")) {
+        int nv = vd->num_vertices();
+        vd->reset(1);
+        BOOST_FOREACH(ovd::Point p, pts ) {
+            vd->insert_point_site(p);
+        }
+        std::cout << "after reset(): " << vd->num_vertices() << " vertices, before: " << nv << "\n";
+        if ( vd->num_vertices() != nv || !vd->check() )
+            return -1;
+    }
+    if ( vm.count("s") && !vd->check() )
+        return -1;
+    std::cout << "solver tiers double/dd_real/qd_real: " << vd->solver_tier_count(0) << "/"
+              << vd->solver_tier_count(1) << "/" << vd->solver_tier_count(2) << "\n";
     std::cout << vd->print();
     vd2svg("random_points.svg", vd);
     delete vd;
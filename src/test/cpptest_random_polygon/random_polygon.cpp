@@ -29,6 +29,7 @@ int main(int argc,char *argv[]) {
         ("help", "produce help message")
         ("n", po::value<int>(), "set number of points")
         ("s", po::value<int>(), "seed for random number generator")
+        ("p", "insert the line-sites with insert_polyline()")
     ;
 
     po::variables_map vm;
@@ -67,11 +68,16 @@ int main(int argc,char *argv[]) {
     
     // now we insert line-segments
     tmr.restart();
-    for( unsigned int n =0; n<point_id.size();n++) {
-        int next = n+1;
-        if (n==point_id.size()-1)
-            next = 0;
-        vd->insert_line_site( point_id[n], point_id[next]); 
+    if (vm.count("p")) {
+        if ( !vd->insert_polyline( point_id, true ) )
+            return -1;
+    } else {
+        for( unsigned int n =0; n<point_id.size();n++) {
+            int next = n+1;
+            if (n==point_id.size()-1)
+                next = 0;
+            vd->insert_line_site( point_id[n], point_id[next]); 
+        }
     }
     double t_lines = tmr.elapsed();
     
@@ -0,0 +1,125 @@
+// OpenVoronoi remove_point_site() example
+#include <string>
+#include <iostream>
+#include <vector>
+#include <cmath>
+
+#include "voronoidiagram.hpp"
+#include "version.hpp"
+
+#include <boost/random.hpp>
+#include <boost/foreach.hpp>
+#include <boost/program_options.hpp>
+
+namespace po = boost::program_options;
+
+/// positions of all vertices in the diagram
+std::vector<ovd::Point> vertex_positions(ovd::VoronoiDiagram& vd) {
+    ovd::HEGraph& g = vd.get_graph_reference();
+    std::vector<ovd::Point> out;
+    BOOST_FOREACH( ovd::HEVertex v, g.vertices() )
+        out.push_back( g[v].position );
+    return out;
+}
+
+/// true if each vertex of \a a matches a different vertex of \a b
+bool same_vertices(std::vector<ovd::Point> a, std::vector<ovd::Point> b) {
+    if ( a.size() != b.size() )
+        return false;
+    BOOST_FOREACH( const ovd::Point& p, a ) {
+        unsigned int best = 0;
+        for (unsigned int n=1; n<b.size(); n++) {
+            if ( (b[n]-p).norm() < (b[best]-p).norm() )
+                best = n;
+        }
+        if ( (b[best]-p).norm() > 1e-6 ) {
+            std::cout << " no match for vertex at " << p << "\n";
+            return false;
+        }
+        b.erase( b.begin()+best );
+    }
+    return true;
+}
+
+/// insert \a n random points, remove every \a r:th of them, and compare with a diagram of the remaining points.
+/// then insert new points where the removed ones were, as when sites move.
+bool random_removal(int n, int r, bool grid, unsigned int seed) {
+    boost::mt19937 rng(seed);
+    boost::uniform_01<boost::mt19937> rnd(rng);
+    std::vector<ovd::Point> pts;
+    for (int m=0; m<n; ++m)
+        pts.push_back( ovd::Point( -0.7+1.4*rnd(), -0.7+1.4*rnd() ) );
+    ovd::VoronoiDiagram vd(1, grid ? 10 : 0);
+    vd.use_face_grid(grid);
+    std::vector<int> ids = vd.insert_point_sites(pts);
+    std::vector<ovd::Point> kept;
+    for (int m=0; m<n; ++m) {
+        if ( m % r == 0 ) {
+            if ( !vd.remove_point_site( ids[m] ) || !vd.check() ) {
+                std::cout << "ERROR: removal of site " << m << " failed\n";
+                return false;
+            }
+        } else {
+            kept.push_back( pts[m] );
+        }
+    }
+    if ( vd.remove_point_site( ids[0] ) ) {
+        std::cout << "ERROR: a removed site was removed again\n";
+        return false;
+    }
+    ovd::VoronoiDiagram ref(1, grid ? 10 : 0);
+    ref.insert_point_sites(kept);
+    std::cout << n-(int)kept.size() << " of " << n << " point-sites removed, "
+              << vd.num_point_sites() << " remain, " << vd.num_vertices() << " vertices\n";
+    if ( vd.num_point_sites() != ref.num_point_sites() || vd.num_faces() != ref.num_faces() ||
+         !same_vertices( vertex_positions(vd), vertex_positions(ref) ) ) {
+        std::cout << "ERROR: diagram differs from a diagram of the remaining sites\n";
+        return false;
+    }
+    for (int m=0; m<n; m+=r) {
+        if ( vd.insert_point_site( pts[m] + ovd::Point(1e-3,1e-3) ) == -1 ) {
+            std::cout << "ERROR: insertion after removal failed\n";
+            return false;
+        }
+    }
+    return vd.check();
+}
+
+/// \test remove point-sites from a diagram, and compare with a diagram built without them
+int main(int argc,char *argv[]) {
+    po::options_description desc("This program checks remove_point_site()\n Allowed options");
+    desc.add_options()
+        ("help", "produce help message")
+        ("n", po::value<int>(), "set number of random point-sites")
+        ("r", po::value<int>(), "remove every r:th site")
+        ("s", po::value<int>(), "seed for random number generator")
+        ("g", "use the bucket-grid for point location, instead of the kd-tree")
+    ;
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (vm.count("help")) {
+        std::cout << desc << "\n";
+        return 1;
+    }
+
+    int n = 100;
+    int r = 3;
+    unsigned int seed = 42;
+    if (vm.count("n"))
+        n = vm["n"].as<int>();
+    if (vm.count("r"))
+        r = vm["r"].as<int>();
+    if (vm.count("s"))
+        seed = vm["s"].as<int>();
+
+    std::cout << "version: " << ovd::version() << "\n";
+    if ( !random_removal(n, r, vm.count("g")>0, seed) ) {
+        std::cout << "ERROR: remove_point_site() failed\n";
+        return -1;
+    }
+    std::cout << "remove_point_site() OK\n";
+    return 0;
+}
@@ -0,0 +1,179 @@
+// OpenVoronoi rollback example
+#include <string>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+
+#include "voronoidiagram.hpp"
+#include "version.hpp"
+
+#include <boost/random.hpp>
+#include <boost/foreach.hpp>
+#include <boost/program_options.hpp>
+
+namespace po = boost::program_options;
+
+/// \brief a description of the diagram that does not depend on vertex- and edge-descriptors
+///
+/// for each face: its status, and the position, type and status of the vertices around it,
+/// with the type and k-value of the edges, starting at the lowest vertex position.
+std::vector<double> signature(ovd::VoronoiDiagram& vd) {
+    ovd::HEGraph& g = vd.get_graph_reference();
+    std::vector<double> sig;
+    sig.push_back( g.num_vertices() );
+    sig.push_back( g.num_edges() );
+    sig.push_back( g.num_faces() );
+    for (ovd::HEFace f=0; f<g.num_faces(); ++f) {
+        std::vector< std::vector<double> > cycle;
+        ovd::HEEdge start = g[f].edge;
+        ovd::HEEdge e = start;
+        do {
+            ovd::HEVertex v = g.source(e);
+            std::vector<double> item;
+            item.push_back( g[v].position.x );
+            item.push_back( g[v].position.y );
+            item.push_back( g[v].type );
+            item.push_back( g[v].status );
+            item.push_back( g[e].type );
+            item.push_back( g[e].k );
+            item.push_back( g[e].face );
+            cycle.push_back(item);
+            e = g[e].next;
+        } while ( e != start && cycle.size() <= g.num_edges() );
+        std::rotate( cycle.begin(), std::min_element( cycle.begin(), cycle.end() ), cycle.end() );
+        sig.push_back( g[f].status );
+        sig.push_back( cycle.size() );
+        BOOST_FOREACH( const std::vector<double>& item, cycle )
+            sig.insert( sig.end(), item.begin(), item.end() );
+    }
+    return sig;
+}
+
+/// compare points by x-coordinate
+bool x_less(const ovd::Point& a, const ovd::Point& b) {
+    return a.x < b.x;
+}
+
+/// stop each insertion at every step, and check that the diagram is rolled back. then insert it for real.
+bool random_rollback(int n, unsigned int seed) {
+    ovd::VoronoiDiagram vd(1,10);
+    vd.set_silent(true);
+    vd.use_rollback(true);
+    boost::mt19937 rng(seed);
+    boost::uniform_01<boost::mt19937> rnd(rng);
+    std::vector<ovd::Point> pts;
+    for (int m=0; m<n; ++m)
+        pts.push_back( ovd::Point( -0.7+1.4*rnd(), -0.7+1.4*rnd() ) );
+    std::sort( pts.begin(), pts.end(), x_less ); // by x, so that segments between neighbours do not intersect
+    std::vector<int> ids;
+    BOOST_FOREACH( const ovd::Point& p, pts ) {
+        std::vector<double> before = signature(vd);
+        for (int step=1; step<=5; ++step) {
+            if ( vd.insert_point_site(p, step) != -1 || signature(vd) != before ) {
+                std::cout << "ERROR: point-site " << ids.size() << " not rolled back at step " << step << "\n";
+                return false;
+            }
+        }
+        int id = vd.insert_point_site(p);
+        if (id == -1) {
+            std::cout << "ERROR: point-site " << ids.size() << " failed\n";
+            return false;
+        }
+        ids.push_back(id);
+    }
+    for (int m=0; m+1<n; m+=2) {
+        std::vector<double> before = signature(vd);
+        bool inserted = false;
+        for (int step=1; step<=16 && !inserted; ++step) {
+            inserted = vd.insert_line_site(ids[m], ids[m+1], step); // true when step is past the last step
+            if ( !inserted && signature(vd) != before ) {
+                std::cout << "ERROR: line-site " << m/2 << " not rolled back at step " << step << "\n";
+                return false;
+            }
+        }
+        if ( !inserted && !vd.insert_line_site(ids[m], ids[m+1]) ) {
+            std::cout << "ERROR: line-site " << m/2 << " failed\n";
+            return false;
+        }
+    }
+    std::cout << n << " point-sites and " << n/2 << " line-sites rolled back and inserted\n";
+    return vd.check();
+}
+
+/// \brief make each insertion fail with a forced desperate solution, and check that insertion_ok() rolls it back.
+/// then insert it for real.
+bool failed_rollback(int n, unsigned int seed) {
+    ovd::VoronoiDiagram vd(1,10);
+    vd.set_silent(true);
+    vd.use_rollback(true);
+    boost::mt19937 rng(seed);
+    boost::uniform_01<boost::mt19937> rnd(rng);
+    std::vector<ovd::Point> pts;
+    for (int m=0; m<n; ++m)
+        pts.push_back( ovd::Point( -0.7+1.4*rnd(), -0.7+1.4*rnd() ) );
+    std::sort( pts.begin(), pts.end(), x_less );
+    std::vector<int> ids;
+    BOOST_FOREACH( const ovd::Point& p, pts ) {
+        std::vector<double> before = signature(vd);
+        vd.force_desperate(1);
+        if ( vd.insert_point_site(p) != -1 || signature(vd) != before ) {
+            std::cout << "ERROR: failed point-site " << ids.size() << " not rolled back\n";
+            return false;
+        }
+        int id = vd.insert_point_site(p);
+        if (id == -1) {
+            std::cout << "ERROR: point-site " << ids.size() << " failed\n";
+            return false;
+        }
+        ids.push_back(id);
+    }
+    for (int m=0; m+1<n; m+=2) {
+        std::vector<double> before = signature(vd);
+        vd.force_desperate(1);
+        if ( vd.insert_line_site(ids[m], ids[m+1]) || signature(vd) != before ) {
+            std::cout << "ERROR: failed line-site " << m/2 << " not rolled back\n";
+            return false;
+        }
+        if ( !vd.insert_line_site(ids[m], ids[m+1]) ) {
+            std::cout << "ERROR: line-site " << m/2 << " failed\n";
+            return false;
+        }
+    }
+    std::cout << n << " failed point-sites and " << n/2 << " failed line-sites rolled back\n";
+    return vd.check();
+}
+
+/// \test insert sites with use_rollback(), stopped with the step parameter or failing with
+/// a forced desperate solution, and check that the diagram is restored
+int main(int argc,char *argv[]) {
+    po::options_description desc("This program checks that stopped and failed insertions are rolled back\n Allowed options");
+    desc.add_options()
+        ("help", "produce help message")
+        ("n", po::value<int>(), "set number of random point-sites")
+        ("s", po::value<int>(), "seed for random number generator")
+    ;
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (vm.count("help")) {
+        std::cout << desc << "\n";
+        return 1;
+    }
+
+    int n = 20;
+    unsigned int seed = 42;
+    if (vm.count("n"))
+        n = vm["n"].as<int>();
+    if (vm.count("s"))
+        seed = vm["s"].as<int>();
+
+    std::cout << "version: " << ovd::version() << "\n";
+    if ( !random_rollback(n, seed) || !failed_rollback(n, seed) ) {
+        std::cout << "ERROR: rollback failed\n";
+        return -1;
+    }
+    std::cout << "rollback OK\n";
+    return 0;
+}
@@ -0,0 +1,213 @@
+// OpenVoronoi SiteValidator example
+#include <string>
+#include <iostream>
+#include <vector>
+#include <set>
+#include <cmath>
+
+#include "voronoidiagram.hpp"
+#include "site_validator.hpp"
+#include "version.hpp"
+
+#include <boost/random.hpp>
+#include <boost/timer.hpp>
+#include <boost/foreach.hpp>
+#include <boost/program_options.hpp>
+
+namespace po = boost::program_options;
+
+typedef std::set< std::pair<int,int> > PairSet;
+
+/// sign of the turn a-b-c
+double orient(const ovd::Point& a, const ovd::Point& b, const ovd::Point& c) {
+    return (b-a).cross(c-a);
+}
+
+/// true if c lies on the segment a-b
+bool on_segment(const ovd::Point& a, const ovd::Point& b, const ovd::Point& c) {
+    return orient(a,b,c) == 0 &&
+           std::min(a.x,b.x) <= c.x && c.x <= std::max(a.x,b.x) &&
+           std::min(a.y,b.y) <= c.y && c.y <= std::max(a.y,b.y);
+}
+
+/// brute-force test of one pair: any common point, other than one shared endpoint, is a conflict
+bool conflict(const ovd::Point& a1, const ovd::Point& a2, const ovd::Point& b1, const ovd::Point& b2) {
+    int shared = (a1==b1) + (a1==b2) + (a2==b1) + (a2==b2);
+    if (shared == 2)
+        return true;
+    if (shared == 1) {
+        ovd::Point c  = (a1==b1 || a1==b2) ? a1 : a2;
+        ovd::Point ao = (c==a1) ? a2 : a1;
+        ovd::Point bo = (c==b1) ? b2 : b1;
+        return on_segment(c,ao,bo) || on_segment(c,bo,ao);
+    }
+    double o1 = orient(a1,a2,b1), o2 = orient(a1,a2,b2);
+    double o3 = orient(b1,b2,a1), o4 = orient(b1,b2,a2);
+    if ( ((o1>0 && o2<0) || (o1<0 && o2>0)) && ((o3>0 && o4<0) || (o3<0 && o4>0)) )
+        return true;
+    return on_segment(a1,a2,b1) || on_segment(a1,a2,b2) || on_segment(b1,b2,a1) || on_segment(b1,b2,a2);
+}
+
+bool same_as_brute_force(const std::vector<ovd::Point>& pts, const std::vector< std::pair<int,int> >& segs);
+
+/// random segments, optionally with endpoints on a coarse grid so that many are collinear, vertical or share endpoints
+bool random_segments(unsigned int n, int grid, unsigned int seed) {
+    boost::mt19937 rng(seed);
+    boost::uniform_01<boost::mt19937> rnd(rng);
+    std::vector<ovd::Point> pts;
+    std::vector< std::pair<int,int> > segs;
+    for (unsigned int m=0; m<n; ++m) {
+        for (int k=0; k<2; ++k) {
+            double x = -0.5+rnd(), y = -0.5+rnd();
+            if (grid > 0) {
+                x = floor(x*grid)/grid;
+                y = floor(y*grid)/grid;
+            }
+            pts.push_back( ovd::Point(x,y) );
+        }
+        // short segments, so that the number of intersections is moderate
+        pts.back() = pts[pts.size()-2] + 0.1*(pts.back()-pts[pts.size()-2]);
+        if (grid > 0)
+            pts.back() = ovd::Point( floor(pts.back().x*grid*4)/(grid*4), floor(pts.back().y*grid*4)/(grid*4) );
+        segs.push_back( std::make_pair( 2*m, 2*m+1 ) );
+    }
+    return same_as_brute_force(pts, segs);
+}
+
+/// \brief compare SiteValidator::intersections() on \a segs to a brute-force test of all pairs
+bool same_as_brute_force(const std::vector<ovd::Point>& pts, const std::vector< std::pair<int,int> >& segs) {
+    unsigned int n = segs.size();
+    boost::timer tmr;
+    ovd::SiteValidator validator;
+    std::vector<ovd::SiteConflict> conflicts = validator.intersections(pts, segs);
+    double t_sweep = tmr.elapsed();
+
+    std::vector<bool> bad( n, false );
+    PairSet sweep_pairs, brute_pairs;
+    BOOST_FOREACH( const ovd::SiteConflict& c, conflicts ) {
+        if ( c.type == ovd::SiteConflict::BAD_SEGMENT )
+            bad[c.first] = true;
+        else
+            sweep_pairs.insert( std::make_pair(c.first, c.second) );
+    }
+    tmr.restart();
+    for (unsigned int a=0; a<n; ++a) {
+        for (unsigned int b=a+1; b<n; ++b) {
+            if ( !bad[a] && !bad[b] &&
+                 conflict( pts[segs[a].first], pts[segs[a].second], pts[segs[b].first], pts[segs[b].second] ) )
+                brute_pairs.insert( std::make_pair(a,b) );
+        }
+    }
+    double t_brute = tmr.elapsed();
+    std::cout << n << " segments, " << sweep_pairs.size() << " intersecting pairs (sweep), "
+              << brute_pairs.size() << " (brute force)\n";
+    std::cout << "sweep: " << t_sweep << " s, brute force: " << t_brute << " s\n";
+    return sweep_pairs == brute_pairs && sweep_pairs.size() == conflicts.size() - std::count(bad.begin(), bad.end(), true);
+}
+
+/// \brief the edges of a grid with \a m cells per side, and some longer vertical segments that overlap the columns
+///
+/// each column has \a m collinear vertical edges that meet end to end, so the sweep has many verticals at one x
+bool grid_columns(int m) {
+    std::vector<ovd::Point> pts;
+    std::vector< std::pair<int,int> > segs;
+    double d = 1.0/m;
+    for (int i=0; i<=m; ++i) {
+        for (int j=0; j<=m; ++j)
+            pts.push_back( ovd::Point( -0.5+i*d, -0.5+j*d ) );
+    }
+    for (int i=0; i<=m; ++i) {
+        for (int j=0; j<m; ++j) {
+            segs.push_back( std::make_pair( i*(m+1)+j, i*(m+1)+j+1 ) ); // vertical
+            segs.push_back( std::make_pair( j*(m+1)+i, (j+1)*(m+1)+i ) ); // horizontal
+        }
+    }
+    for (int i=0; i<=m; i+=4) // overlaps some edges of column i
+        segs.push_back( std::make_pair( i*(m+1)+1, i*(m+1)+m/2 ) );
+    return same_as_brute_force(pts, segs);
+}
+
+/// a square with a duplicate corner, and a diagonal that crosses an edge, inserted with validation on
+bool diagram_validation() {
+    ovd::VoronoiDiagram vd(1,10);
+    vd.set_silent(true);
+    vd.use_site_validation(true);
+    std::vector<ovd::Point> pts;
+    pts.push_back( ovd::Point(-0.3,-0.3) );
+    pts.push_back( ovd::Point( 0.3,-0.3) );
+    pts.push_back( ovd::Point( 0.3, 0.3) );
+    pts.push_back( ovd::Point(-0.3, 0.3) );
+    pts.push_back( ovd::Point( 0.3, 0.3) ); // duplicate
+    pts.push_back( ovd::Point( 0.0,-0.5) );
+    pts.push_back( ovd::Point( 0.0, 0.1) );
+    std::vector<int> ids = vd.insert_point_sites(pts);
+    if ( ids[4] != -1 || ids[2] == -1 )
+        return false;
+    std::vector<int> square( ids.begin(), ids.begin()+4 );
+    if ( !vd.insert_polyline(square, true) )
+        return false;
+    std::vector< std::pair<int,int> > segs;
+    segs.push_back( std::make_pair( ids[5], ids[6] ) ); // crosses the bottom edge of the square
+    segs.push_back( std::make_pair( ids[0], ids[2] ) ); // a diagonal, which meets the square only at corners
+    segs.push_back( std::make_pair( ids[1], ids[3] ) ); // crosses the diagonal above
+    std::vector<bool> ok = vd.insert_line_sites(segs);
+    std::cout << "inserted: " << ok[0] << ok[1] << ok[2] << "\n";
+    // the two diagonals cross each other, so both are rejected
+    return !ok[0] && !ok[1] && !ok[2] && vd.num_line_sites() == 4 && vd.check();
+}
+
+/// \test compare the Bentley-Ottmann sweep of SiteValidator to a brute-force test of all pairs
+int main(int argc,char *argv[]) {
+    po::options_description desc("This program checks SiteValidator against a brute-force intersection test\n Allowed options");
+    desc.add_options()
+        ("help", "produce help message")
+        ("n", po::value<int>(), "set number of random segments")
+        ("g", po::value<int>(), "snap endpoints to a grid with this many cells (degenerate input). use a power of two, so that the brute force test is exact")
+        ("s", po::value<int>(), "seed for random number generator")
+        ("v", "insert sites into a diagram with use_site_validation()")
+        ("c", po::value<int>(), "the edges of a grid with this many cells per side, instead of random segments")
+    ;
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (vm.count("help")) {
+        std::cout << desc << "\n";
+        return 1;
+    }
+
+    unsigned int nmax = 1000;
+    int grid = 0;
+    unsigned int seed = 42;
+    if (vm.count("n"))
+        nmax = vm["n"].as<int>();
+    if (vm.count("g"))
+        grid = vm["g"].as<int>();
+    if (vm.count("s"))
+        seed = vm["s"].as<int>();
+
+    std::cout << "version: " << ovd::version() << "\n";
+    if (vm.count("v")) {
+        if ( !diagram_validation() ) {
+            std::cout << "ERROR: validation in VoronoiDiagram failed\n";
+            return -1;
+        }
+        std::cout << "diagram validation OK\n";
+        return 0;
+    }
+    if (vm.count("c")) {
+        if ( !grid_columns( vm["c"].as<int>() ) ) {
+            std::cout << "ERROR: sweep and brute force differ\n";
+            return -1;
+        }
+        std::cout << "sweep OK\n";
+        return 0;
+    }
+    if ( !random_segments(nmax, grid, seed) ) {
+        std::cout << "ERROR: sweep and brute force differ\n";
+        return -1;
+    }
+    std::cout << "sweep OK\n";
+    return 0;
+}
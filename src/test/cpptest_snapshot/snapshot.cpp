@@ -0,0 +1,179 @@
+// OpenVoronoi DiagramSnapshot example
+#include <string>
+#include <iostream>
+#include <vector>
+#include <cmath>
+
+#include "voronoidiagram.hpp"
+#include "diagram_snapshot.hpp"
+#include "version.hpp"
+
+#include <boost/random.hpp>
+#include <boost/foreach.hpp>
+#include <boost/bind/bind.hpp>
+#include <boost/thread.hpp>
+#include <boost/program_options.hpp>
+
+namespace po = boost::program_options;
+
+/// \brief build a diagram of a random star-shaped polygon with \a n vertices, and \a n random point-sites inside it
+/// \return the handles of the point-sites
+std::vector<int> build(ovd::VoronoiDiagram& vd, int n, unsigned int seed) {
+    boost::mt19937 rng(seed);
+    boost::uniform_01<boost::mt19937> rnd(rng);
+    std::vector<ovd::Point> pts;
+    for (int m=0; m<n; ++m) {
+        double a = 2*M_PI*m/n;
+        double r = 0.5+0.4*rnd();
+        pts.push_back( ovd::Point( r*cos(a), r*sin(a) ) );
+    }
+    for (int m=0; m<n; ++m) {
+        double a = 2*M_PI*rnd();
+        double r = 0.3*rnd();
+        pts.push_back( ovd::Point( r*cos(a), r*sin(a) ) );
+    }
+    std::vector<int> ids = vd.insert_point_sites(pts);
+    std::vector<int> polygon( ids.begin(), ids.begin()+n );
+    vd.insert_polyline(polygon, true);
+    return ids;
+}
+
+/// true if the edge has bisector parameters
+bool has_params(ovd::EdgeType t) {
+    return t != ovd::OUTEDGE && t != ovd::LINESITE && t != ovd::ARCSITE && t != ovd::NULLEDGE;
+}
+
+/// true if snapshot \a s has the same faces, edges and vertices as the diagram \a vd
+bool same(ovd::VoronoiDiagram& vd, const ovd::DiagramSnapshot& s) {
+    ovd::HEGraph& g = vd.get_graph_reference();
+    if ( s.num_vertices() != g.num_vertices() || s.num_edges() != g.num_edges() || s.num_faces() != g.num_faces() ) {
+        std::cout << "ERROR: snapshot has a different number of vertices, edges or faces\n";
+        return false;
+    }
+    for (ovd::HEFace f=0; f<g.num_faces(); ++f) {
+        ovd::HEEdge ge = g[f].edge;
+        for (unsigned int e=s.face_begin(f); e<s.face_end(f); ++e) {
+            ovd::HEVertex src = g.source(ge);
+            if ( s.position( s.source(e) ) != g[src].position || s.radius( s.source(e) ) != g[src].dist() ||
+                 s.position( s.target(e) ) != g[ g.target(ge) ].position || s.face(e) != f ||
+                 s.edge_type(e) != g[ge].type || s.k(e) != g[ge].k ) {
+                std::cout << "ERROR: edge " << e << " on face " << f << " differs\n";
+                return false;
+            }
+            if ( has_params( s.edge_type(e) ) && s.point(e, g[src].dist()) != g[ge].point( g[src].dist() ) ) {
+                std::cout << "ERROR: bisector of edge " << e << " differs\n";
+                return false;
+            }
+            unsigned int tw = s.twin(e);
+            if ( tw != ovd::DiagramSnapshot::NONE && ( s.twin(tw) != e || s.source(tw) != s.target(e) ) ) {
+                std::cout << "ERROR: twin of edge " << e << " is wrong\n";
+                return false;
+            }
+            ge = g[ge].next;
+        }
+        if ( ge != g[f].edge ) {
+            std::cout << "ERROR: face " << f << " has a different number of edges\n";
+            return false;
+        }
+    }
+    for (unsigned int v=0; v<s.num_vertices(); ++v) {
+        std::pair<const unsigned int*, const unsigned int*> out = s.out_edges(v);
+        for (const unsigned int* e=out.first; e!=out.second; ++e) {
+            if ( s.source(*e) != v ) {
+                std::cout << "ERROR: out-edge " << *e << " of vertex " << v << " has another source\n";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/// a read-only computation on the snapshot: total length of the edges inside the polygon, and the largest clearance
+void measure(const ovd::DiagramSnapshot* s, double* out) {
+    double length = 0;
+    for (unsigned int e=0; e<s->num_edges(); ++e) {
+        if ( s->edge_type(e) != ovd::OUTEDGE && s->position( s->source(e) ).norm() < 0.5 )
+            length += ( s->position( s->target(e) ) - s->position( s->source(e) ) ).norm();
+    }
+    double max_r = 0;
+    for (unsigned int v=0; v<s->num_vertices(); ++v) {
+        if ( s->position(v).norm() < 0.5 )
+            max_r = std::max( max_r, s->radius(v) );
+    }
+    out[0] = length;
+    out[1] = max_r;
+}
+
+/// compare the snapshot with the diagram, read it from \a n_threads threads, and then modify the diagram
+bool check_snapshot(int n, int n_threads, unsigned int seed) {
+    ovd::VoronoiDiagram vd(1, 0);
+    std::vector<int> ids = build(vd, n, seed);
+    ovd::DiagramSnapshot s = vd.snapshot();
+    std::cout << s.num_vertices() << " vertices, " << s.num_edges() << " half-edges, " << s.num_faces() << " faces\n";
+    if ( !same(vd, s) )
+        return false;
+    
+    double expected[2];
+    measure(&s, expected);
+    std::vector<double> results( 2*n_threads );
+    boost::thread_group threads;
+    for (int m=0; m<n_threads; ++m)
+        threads.create_thread( boost::bind( measure, &s, &results[2*m] ) );
+    threads.join_all();
+    for (int m=0; m<n_threads; ++m) {
+        if ( results[2*m] != expected[0] || results[2*m+1] != expected[1] ) {
+            std::cout << "ERROR: thread " << m << " read a different snapshot\n";
+            return false;
+        }
+    }
+    std::cout << "edge length " << expected[0] << ", max clearance " << expected[1] << "\n";
+    
+    // the snapshot is a copy. it does not change with the diagram.
+    unsigned int num_edges = s.num_edges();
+    vd.insert_line_site( ids[n], ids[n+1] );
+    double after[2];
+    measure(&s, after);
+    if ( s.num_edges() != num_edges || after[0] != expected[0] || after[1] != expected[1] ) {
+        std::cout << "ERROR: snapshot changed with the diagram\n";
+        return false;
+    }
+    return same( vd, vd.snapshot() );
+}
+
+/// \test DiagramSnapshot compared with the diagram, and shared by threads
+int main(int argc,char *argv[]) {
+    po::options_description desc("This program checks DiagramSnapshot\n Allowed options");
+    desc.add_options()
+        ("help", "produce help message")
+        ("n", po::value<int>(), "set number of polygon vertices and random point-sites")
+        ("t", po::value<int>(), "number of reader threads")
+        ("s", po::value<int>(), "seed for random number generator")
+    ;
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (vm.count("help")) {
+        std::cout << desc << "\n";
+        return 1;
+    }
+
+    int n = 50;
+    int n_threads = 2;
+    unsigned int seed = 42;
+    if (vm.count("n"))
+        n = vm["n"].as<int>();
+    if (vm.count("t"))
+        n_threads = vm["t"].as<int>();
+    if (vm.count("s"))
+        seed = vm["s"].as<int>();
+
+    std::cout << "version: " << ovd::version() << "\n";
+    if ( !check_snapshot(n, n_threads, seed) ) {
+        std::cout << "ERROR: DiagramSnapshot failed\n";
+        return -1;
+    }
+    std::cout << "DiagramSnapshot OK\n";
+    return 0;
+}
@@ -0,0 +1,153 @@
+/*
+ *  Copyright (c) 2010-2012 Anders Wallin (anders.e.e.wallin "at" gmail.com).
+ *
+ *  This file is part of Openvoronoi
+ *  (see https://github.com/aewallin/openvoronoi).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cassert>
+
+#include "undo_log.hpp"
+
+namespace ovd {
+
+UndoLog::UndoLog(HEGraph& gi) : g(gi), on(false), epoch(0) {}
+
+UndoLog::~UndoLog() {}
+
+/// \brief start the log, and the graph-record of added and removed vertices and edges
+/// \param e the VoronoiDiagram::epoch of the insertion
+void UndoLog::begin(unsigned int e) {
+    clear();
+    epoch = e;
+    on = true;
+    g.begin_undo();
+}
+
+/// \brief save the properties of face \a f, and of the edges and vertices on its boundary
+///
+/// does nothing for a face that is already saved, or that was added after begin().
+/// edges and vertices added after begin() are not saved.
+void UndoLog::save_face(HEFace f) {
+    if ( !on || g.is_new(f) || faces.find(f) != faces.end() )
+        return;
+    faces.insert( std::make_pair( f, g[f] ) );
+    HEEdge start = g[f].edge;
+    HEEdge current = start;
+    do {
+        save_edge( current );
+        save_vertex( g.source(current) );
+        current = g[current].next;
+    } while ( current != start );
+}
+
+/// save_face() for face \a f, and for the faces on the other side of its edges
+void UndoLog::save_face_and_neighbors(HEFace f) {
+    if ( !on || g.is_new(f) || faces.find(f) != faces.end() )
+        return;
+    save_face(f);
+    HEEdge start = g[f].edge;
+    HEEdge current = start;
+    do {
+        save_face( g[ g[current].twin ].face );
+        current = g[current].next;
+    } while ( current != start );
+}
+
+/// save the properties of vertex \a v, unless it is already saved or was added after begin()
+void UndoLog::save_vertex(HEVertex v) {
+    if ( !on || g.is_new(v) || vertices.find(v) != vertices.end() )
+        return;
+    vertices.insert( std::make_pair( v, g[v] ) );
+}
+
+/// save the properties of edge \a e, unless it is already saved or was added after begin()
+void UndoLog::save_edge(HEEdge e) {
+    if ( g.is_new(e) || edges.find(e) != edges.end() )
+        return;
+    edges.insert( std::make_pair( e, g[e] ) );
+}
+
+/// the insertion succeeded. forget the log.
+void UndoLog::commit() {
+    g.end_undo();
+    clear();
+}
+
+/// \brief restore the graph to its state at begin()
+///
+/// call VoronoiDiagram::reset_status() before this, while the vertices in
+/// VoronoiDiagram::modified_vertices still exist.
+void UndoLog::rollback() {
+    assert( on );
+    g.undo( vmap, emap );
+    std::map<HEVertex, VoronoiVertex>::const_iterator vit;
+    for (vit = vertices.begin(); vit != vertices.end(); ++vit) {
+        VoronoiVertex& vv = g[ mapped(vit->first) ];
+        vv = vit->second;
+        if ( vv.modified_epoch == epoch ) // the status was changed before the vertex was saved
+            vv.reset_status();
+    }
+    std::map<HEEdge, EdgeProps>::const_iterator eit;
+    for (eit = edges.begin(); eit != edges.end(); ++eit) {
+        EdgeProps& ep = g[ mapped(eit->first) ];
+        ep = eit->second; // EdgeProps::operator= does not copy next, twin, and inserted_direction
+        ep.next = mapped( eit->second.next );
+        ep.twin = mapped( eit->second.twin );
+        ep.inserted_direction = eit->second.inserted_direction;
+    }
+    std::map<HEFace, FaceProps>::const_iterator fit;
+    for (fit = faces.begin(); fit != faces.end(); ++fit) {
+        FaceProps& fp = g[ fit->first ];
+        fp = fit->second;
+        fp.edge = mapped( fit->second.edge );
+        fp.status = NONINCIDENT; // saved while the insertion had it INCIDENT
+    }
+    clear();
+}
+
+FaceVector UndoLog::saved_faces() const {
+    FaceVector out;
+    std::map<HEFace, FaceProps>::const_iterator it;
+    for (it = faces.begin(); it != faces.end(); ++it)
+        out.push_back( it->first );
+    return out;
+}
+
+/// the current descriptor of edge \a e, which may have been re-created by rollback()
+HEEdge UndoLog::mapped(HEEdge e) const {
+    std::map<HEEdge, HEEdge>::const_iterator it = emap.find(e);
+    return ( it == emap.end() ) ? e : it->second;
+}
+
+/// the current descriptor of vertex \a v, which may have been re-created by rollback()
+HEVertex UndoLog::mapped(HEVertex v) const {
+    std::map<HEVertex, HEVertex>::const_iterator it = vmap.find(v);
+    return ( it == vmap.end() ) ? v : it->second;
+}
+
+/// forget saved properties and descriptor maps
+void UndoLog::clear() {
+    on = false;
+    vertices.clear();
+    edges.clear();
+    faces.clear();
+    vmap.clear();
+    emap.clear();
+}
+
+} // end ovd namespace
+// end undo_log.cpp
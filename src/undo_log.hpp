@@ -0,0 +1,74 @@
+/*
+ *  Copyright (c) 2010-2012 Anders Wallin (anders.e.e.wallin "at" gmail.com).
+ *
+ *  This file is part of Openvoronoi
+ *  (see https://github.com/aewallin/openvoronoi).
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <map>
+
+#include "graph.hpp"
+
+namespace ovd {
+
+/// \brief undo-log for one site insertion, see VoronoiDiagram::use_rollback()
+///
+/// The graph records which vertices and edges are added and removed, see HEGraph::begin_undo().
+/// This class records the properties that the insertion modifies: before the first change
+/// to a face, save_face() copies the properties of the face and of the edges and vertices on
+/// its boundary. rollback() reverts the graph changes and then copies the saved properties back,
+/// with descriptors of re-created vertices and edges mapped to their new values.
+///
+/// The insertion must call save_face() (or save_vertex()) before it modifies a face or vertex
+/// that existed before begin(). Vertex status changes made before the save are undone by
+/// the epoch stamp: a vertex that was modified in this insertion is restored as ::UNDECIDED,
+/// just as VoronoiDiagram::reset_status() would leave it.
+class UndoLog {
+public:
+    /// \param gi input graph
+    UndoLog(HEGraph& gi);
+    ~UndoLog();
+
+    void begin(unsigned int epoch);
+    void save_face(HEFace f);
+    void save_face_and_neighbors(HEFace f);
+    void save_vertex(HEVertex v);
+    void commit();
+    void rollback();
+    /// true between begin() and commit() or rollback()
+    bool active() const {return on;}
+    /// the faces saved with save_face()
+    FaceVector saved_faces() const;
+private:
+    void save_edge(HEEdge e);
+    HEEdge mapped(HEEdge e) const;
+    HEVertex mapped(HEVertex v) const;
+    void clear();
+
+    HEGraph& g; ///< vd-graph
+    bool on; ///< recording
+    unsigned int epoch; ///< VoronoiDiagram::epoch of the insertion
+    std::map<HEVertex, VoronoiVertex> vertices; ///< saved vertex properties
+    std::map<HEEdge, EdgeProps> edges; ///< saved edge properties
+    std::map<HEFace, FaceProps> faces; ///< saved face properties
+    std::map<HEVertex, HEVertex> vmap; ///< old to new descriptor, for vertices re-created by rollback()
+    std::map<HEEdge, HEEdge> emap; ///< old to new descriptor, for edges re-created by rollback()
+};
+
+} // end ovd namespace
+
+// end undo_log.hpp
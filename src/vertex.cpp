@@ -20,25 +20,13 @@
 #include <cassert>
 #include <limits>
 
-#include <boost/assign.hpp>
+#include <qd/qd_real.h>
 
 #include "vertex.hpp"
 #include "common/numeric.hpp"
 
 namespace ovd {
 
-int VoronoiVertex::count = 0;
-
-// the expected degree of a vertex. checked by topology-checker
-VoronoiVertex::VertexDegreeMap VoronoiVertex::expected_degree = boost::assign::map_list_of 
-    (OUTER,4)     // special outer vertices
-    (NORMAL,6)    // normal vertex in the graph
-    (POINTSITE,0) // point site
-    (ENDPOINT,6)  // end-point of line or arc
-    (SEPPOINT,6)  // end-point of separator
-    (SPLIT,4)     // split point, to avoid loops in delete-tree
-    (APEX,4) ;    // apex point on quadratic bisector
-    
 /// ctor with given status and type
 VoronoiVertex::VoronoiVertex( Point p, VertexStatus st, VertexType t) {
     init(p,st,t);
@@ -58,11 +46,12 @@ VoronoiVertex::VoronoiVertex( Point p, VertexStatus st, VertexType t, double ini
 }
 VoronoiVertex::~VoronoiVertex() {}
 
-/// set index, increase count, initialize in_queue to false.
+/// clear the epoch-stamps. the index is set when the vertex is added to a VoronoiDiagram.
 void VoronoiVertex::init() {
-    index = count;
-    count++;
-    in_queue = false;
+    index = -1;
+    queue_epoch = 0;
+    modified_epoch = 0;
+    modified_slot = 0;
     alfa=-1; // invalid/non-initialized alfa value
     null_face = std::numeric_limits<HEFace>::quiet_NaN();    
     type = NORMAL;
@@ -92,9 +81,8 @@ void VoronoiVertex::init(Point p, VertexStatus st, VertexType t, Point initDist,
     k3 = lk3;
 }
 
-/// set in_queue false, and status to ::UNDECIDED
+/// set status to ::UNDECIDED. the epoch-stamps are made stale by VoronoiDiagram instead.
 void VoronoiVertex::reset_status() {
-    in_queue = false;
     status = UNDECIDED;
 }
 void VoronoiVertex::set_alfa(const Point& dir) {
@@ -108,15 +96,42 @@ double VoronoiVertex::dist(const Point& p) const { return (position-p).norm(); }
 void VoronoiVertex::zero_dist() {r=0;}
 /// return clearance disk-radius
 double VoronoiVertex::dist() const { return r; }
-/// in-circle predicate 
+/// \brief in-circle predicate 
+///
+/// negative if \a p is inside the clearance-disk, positive if outside, zero if on the disk.
+/// The returned value is dist(p)^2 - r^2, so no square-root is needed.
+/// The sign is filtered: the double result is returned if it is larger than 
+/// a static error bound, otherwise the value is recomputed in qd_real.
 double VoronoiVertex::in_circle(const Point& p) const {
-    //if ( r==0 && dist(p) == 0 ) 
-    //    return -1;
-    //else
-        return dist(p) - r; 
+    double dx = position.x - p.x;
+    double dy = position.y - p.y;
+    double d2 = dx*dx + dy*dy;
+    double r2 = r*r;
+    double h = d2 - r2;
+    // each term carries at most a few roundings. 3*eps covers them (with margin).
+    double bound = 3.0*std::numeric_limits<double>::epsilon()*(d2+r2);
+    if ( fabs(h) > bound )
+        return h;
+    // sign not certain, fall back to quad-double arithmetic.
+    // the differences and squares of doubles are (nearly) exact in qd_real.
+    qd_real qdx = qd_real(position.x) - p.x;
+    qd_real qdy = qd_real(position.y) - p.y;
+    qd_real qr = qd_real(r);
+    return to_double( qdx*qdx + qdy*qdy - qr*qr );
+}
+/// \brief the expected degree of a vertex of type \a t. checked by topology-checker
+unsigned int VoronoiVertex::expected_degree(VertexType t) {
+    switch (t) {
+        case OUTER:     return 4; // special outer vertices
+        case NORMAL:    return 6; // normal vertex in the graph
+        case POINTSITE: return 0; // point site
+        case ENDPOINT:  return 6; // end-point of line or arc
+        case SEPPOINT:  return 6; // end-point of separator
+        case SPLIT:     return 4; // split point, to avoid loops in delete-tree
+        case APEX:      return 4; // apex point on quadratic bisector
+        default:        return 0;
+    }
 }
-/// reset the index count
-void VoronoiVertex::reset_count() { count = 0; }
 
 
 } // end ovd namespace
@@ -72,15 +72,19 @@ public:
     void zero_dist();
     double dist() const; 
     double in_circle(const Point& p) const; 
-    static void reset_count(); 
+    static unsigned int expected_degree(VertexType t);
     void set_alfa(const Point& dir); ///< set alfa. This is only for debug-drawing of null-face vertices.
 // DATA
     
-    int index; ///< unique integer index of vertex
+    int index; ///< unique integer index of vertex, assigned by the VoronoiDiagram. -1 if not assigned.
     VertexStatus status; ///< vertex status. updated/changed during an incremental graph update
     VertexType type; ///< The type of the vertex. Never(?) changes
     double max_error; ///< \todo what is this? remove?
-    bool in_queue; ///< flag for indicating whether vertex is in the vertexQueue
+    /// the vertex is in the vertexQueue if queue_epoch equals VoronoiDiagram::epoch
+    unsigned int queue_epoch;
+    /// the vertex is in VoronoiDiagram::modified_vertices if modified_epoch equals VoronoiDiagram::epoch
+    unsigned int modified_epoch;
+    unsigned int modified_slot; ///< position in VoronoiDiagram::modified_vertices, valid in modified_epoch
     Point position; ///< the position of the vertex.
     double k3;  ///< the offset-direction {-1,+1} of this vertex to the newly inserted site.
     double alfa; ///< diangle for a null-vertex. only for debug-drawing
@@ -92,11 +96,6 @@ protected:
     void init(Point p, VertexStatus st, VertexType t);
     void init(Point p, VertexStatus st, VertexType t, Point initDist);
     void init(Point p, VertexStatus st, VertexType t, Point initDist, double k3);
-    static int count; ///< global vertex count \todo hold this in hedigraph instead?
-    /// A map of this type is used by VoronoiDiagramChecker to check that all vertices
-    /// have the expected (correct) degree (i.e. number of edges)
-    typedef std::map<VertexType, unsigned int> VertexDegreeMap;
-    static VertexDegreeMap expected_degree; ///< map for checking topology correctness
     double r; ///< clearance-disk radius, i.e. the closest Site is at this distance
 private:
     VoronoiVertex();
@@ -40,14 +40,18 @@ namespace ovd {
 
 /// create positioner, set graph.
 VertexPositioner::VertexPositioner(HEGraph& gi): g(gi) {
-    //ppp_solver = new solvers::PPPSolver<double>(); // faster, but inaccurate
-    ppp_solver =      new solvers::PPPSolver<qd_real>(); // slower, more accurate
+    ppp_solver =      new solvers::PPPSolver(); // double first, qd_real only if needed
     lll_solver =      new solvers::LLLSolver();
     qll_solver =      new solvers::QLLSolver();
     sep_solver =      new solvers::SEPSolver();
     alt_sep_solver =  new solvers::ALTSEPSolver();
     lll_para_solver = new solvers::LLLPARASolver();
     silent = false;
+    desperate_count = 0;
+    qll_dispatched = false;
+    qll_mode = QLL_BEST_FIRST;
+    qll_escalation_count = 0;
+    forced_desperate = 0;
     solver_debug(false);
     errstat.clear();
 }
@@ -124,42 +128,95 @@ solvers::Solution VertexPositioner::position(HEEdge e, Site* s3) {
     return sl;
 }
 
+/// \brief the point equidistant to the three PointSite:s \a s1, \a s2 and \a s3
+///
+/// used by VoronoiDiagram::remove_point_site(), where the new vertices do not lie on an existing edge.
+/// \return false if there is no solution, i.e. the sites are collinear
+bool VertexPositioner::circumcenter(Site* s1, Site* s2, Site* s3, solvers::Solution& sl) {
+    assert( s1->isPoint() && s2->isPoint() && s3->isPoint() );
+    solvers::SolutionBuffer solutions;
+    if ( ppp_solver->solve(s1,+1,s2,+1,s3,+1, solutions) == 0 )
+        return false;
+    sl = solutions[0];
+    return true;
+}
+
 /// position a new voronoi vertex
 /// find vertex that is equidistant from s1, s2, s3
 /// should lie on the k1 side of s1, k2 side of s2
 /// we try both k3=-1 and k3=+1 for s3
+///
+/// QLLSolver first solves only along its best-conditioned permutation. If that
+/// gives no solution, or one that fails the distance checks, we solve again along all three.
+/// set_qll_mode() can force this escalation, or skip it by always solving all three.
 solvers::Solution VertexPositioner::position(Site* s1, double k1, Site* s2, double k2, Site* s3) {
     assert( (k1==1) || (k1 == -1) );
     assert( (k2==1) || (k2 == -1) );
-    std::vector<solvers::Solution> solutions;
-        
-    solver_dispatch(s1,k1,s2,k2,s3,+1, solutions); // a single k3=+1 call for s3->isPoint()
+    solvers::SolutionBuffer solutions;
+    solvers::Solution sl( Point(0,0), 0, 0 );
     
+    if ( forced_desperate > 0 ) { // see force_desperate()
+        forced_desperate--;
+        desperate_count++;
+    }
+    qll_dispatched = false;
+    qll_solver->set_all_permutations( qll_mode == QLL_ALL_PERMUTATIONS );
+    solver_dispatch(s1,k1,s2,k2,s3,+1, solutions); // a single k3=+1 call for s3->isPoint()
     if (!s3->isPoint()) 
         solver_dispatch(s1,k1,s2,k2,s3,-1, solutions); // for lineSite or ArcSite we try k3=-1 also    
     
-    if ( solutions.size() == 1 && (t_min<=solutions[0].t) && (t_max>=solutions[0].t) && (s3->in_region( solutions[0].p)) )
-        return solutions[0];
+    if ( !qll_dispatched || qll_mode == QLL_ALL_PERMUTATIONS )
+        return select_solution(solutions, s1, s2, s3, true, sl) ? sl : failed_solution(s1, k1, s2, k2, s3);
+    if ( qll_mode == QLL_BEST_FIRST && select_solution(solutions, s1, s2, s3, false, sl) && acceptable(sl, s1, s2, s3) )
+        return sl;
+    
+    // escalate to all three permutations of QLLSolver
+    qll_escalation_count++;
+    solutions.clear();
+    qll_solver->set_all_permutations(true);
+    solver_dispatch(s1,k1,s2,k2,s3,+1, solutions);
+    if (!s3->isPoint()) 
+        solver_dispatch(s1,k1,s2,k2,s3,-1, solutions);
+    qll_solver->set_all_permutations(false);
+    return select_solution(solutions, s1, s2, s3, true, sl) ? sl : failed_solution(s1, k1, s2, k2, s3);
+}
+
+/// \brief choose one of the candidate \a solutions for a vertex equidistant from \a s1, \a s2, \a s3
+///
+/// filters the candidates by in_region(), by t_min < t < t_max, and by their equidistance,
+/// and picks the one closest to the edge if more than one remain.
+/// \param warn write warnings about empty candidate sets (unless silent)
+/// \param sl the chosen Solution
+/// \return false if no candidate remains
+bool VertexPositioner::select_solution(solvers::SolutionBuffer& solutions, Site* s1, Site* s2, Site* s3, 
+                                       bool warn, solvers::Solution& sl) {
+    warn = warn && !silent;
+    if ( solutions.size() == 1 && (t_min<=solutions[0].t) && (t_max>=solutions[0].t) && (s3->in_region( solutions[0].p)) ) {
+        sl = solutions[0];
+        return true;
+    }
             
-    if (solutions.empty() && !silent ) 
+    if (solutions.empty() && warn ) 
         std::cout << "WARNING empty solution set!!\n";
     
     // choose only in_region() solutions
     solutions.erase( std::remove_if(solutions.begin(),solutions.end(), in_region_filter(s3) ), solutions.end() );
-    if (solutions.empty() && !silent ) 
+    if (solutions.empty() && warn ) 
         std::cout << "WARNING in_region_filter() results in empty solution set!!\n";
     
     
     // choose only t_min < t < t_max solutions 
     solutions.erase( std::remove_if(solutions.begin(),solutions.end(), t_filter(t_min,t_max) ), solutions.end() );
-    if (solutions.empty() && !silent ) 
+    if (solutions.empty() && warn ) 
         std::cout << "WARNING t_filter() results in empty solution set!!\n";
 
-    if ( solutions.size() == 1) // if only one solution is found, return that.
-        return solutions[0];
+    if ( solutions.size() == 1) { // if only one solution is found, return that.
+        sl = solutions[0];
+        return true;
+    }
     
     if (solutions.size()>1) {
-        std::vector<solvers::Solution> equidistant_solutions;
+        solvers::SolutionBuffer equidistant_solutions;
         // If s3 is a linesite or arcsite, we look for a solution in both halfspaces delimited by s3
         // Usually, the t_min / t_max should take care of filtering out the invalid solution, but in some
         // cases, t remains nearly constant (e.g. if s1 and s2 are nearly parallel) and the out-of-region solution slips through. 
@@ -172,11 +229,13 @@ solvers::Solution VertexPositioner::position(Site* s1, double k1, Site* s2, doub
             double err = std::max(std::abs(d1-d2), std::max(std::abs(d2-d3), std::abs(d3-d1)));
             double mindist = std::min(d1, std::min(d2, d3));
             if (err/mindist > 0.01) {
-                std::cout << "VertexPositioner::position() Warning:\n";
-                std::cout << " Solution "<<i<<" violates equidistance constraint. Distances of solution were:\n";
-                std::cout << "  p-s1: "<<sqrt(d1)<<"\n";
-                std::cout << "  p-s2: "<<sqrt(d2)<<"\n";
-                std::cout << "  p-s3: "<<sqrt(d3)<<"\n";
+                if (warn) {
+                    std::cout << "VertexPositioner::position() Warning:\n";
+                    std::cout << " Solution "<<i<<" violates equidistance constraint. Distances of solution were:\n";
+                    std::cout << "  p-s1: "<<sqrt(d1)<<"\n";
+                    std::cout << "  p-s2: "<<sqrt(d2)<<"\n";
+                    std::cout << "  p-s3: "<<sqrt(d3)<<"\n";
+                }
             }
             else {
                 equidistant_solutions.push_back(s);
@@ -184,40 +243,45 @@ solvers::Solution VertexPositioner::position(Site* s1, double k1, Site* s2, doub
         }
         solutions = equidistant_solutions;
     }
-    if ( solutions.size() == 1) // if only one solution is found, return that.
-        return solutions[0];
+    if ( solutions.size() == 1) { // if only one solution is found, return that.
+        sl = solutions[0];
+        return true;
+    }
 
     if (solutions.size()>1) {
         // two or more points remain so we must further filter here!
         // filter further using edge_error
         double min_error=100;
         solvers::Solution min_solution(Point(0,0),0,0);
-        //std::cout << " edge_error filter: \n";
         BOOST_FOREACH(solvers::Solution s, solutions) {
             double err = edge_error(s); //g[edge].error(s);
-            //std::cout << s.p << " k3=" << s.k3 << " t=" <<  s.t << " err=" << err << "\n";
             if ( err < min_error) {
                 min_solution = s;
                 min_error = err;
             }
         }
-        if (min_error >= 1e-6) {
-            /*
-            std::cout << "WARNING: EDGE ERROR TOO LARGE\n";
-            std::cout << " s1 = " << s1->str2() << " k1= " << k1 << "\n";
-            std::cout << " s2 = " << s2->str2() << " k2= " << k2 << "\n";
-            std::cout << " s3 = " << s3->str2() << "\n";
-            std::cout << " sln=" << min_solution.p << " err=" << min_error << "\n";
-            std::cout << " edge: " << g[ g.source(edge) ].position << " - " << g[ g.target(edge) ].position;
-            std::cout << " edge-point(t="<<min_solution.t << ")= " << g[edge].point(min_solution.t) << "\n";
-            */
-            //assert(0);
-        }
-        //assert( min_error < 1e-6 );
-        return min_solution;
+        sl = min_solution;
+        return true;
     }
-    
+    return false;
+}
 
+/// \brief true if \a sl passes the checks that position(HEEdge,Site*) asserts
+///
+/// \a sl lies on the edge, and is at distance sl.t from \a s1, \a s2 and \a s3.
+/// Like check_dist() and solution_on_edge(), but without output.
+bool VertexPositioner::acceptable(solvers::Solution& sl, Site* s1, Site* s2, Site* s3) {
+    if ( edge_error(sl) >= 9E-4 )
+        return false;
+    double d1 = (sl.p - s1->apex_point(sl.p) ).norm();
+    double d2 = (sl.p - s2->apex_point(sl.p) ).norm();  
+    double d3 = (sl.p - s3->apex_point(sl.p) ).norm(); 
+    return equal(d1,d2) && equal(d1,d3) && equal(d2,d3) &&
+           equal(sl.t,d1) && equal(sl.t,d2) && equal(sl.t,d3);
+}
+
+/// \brief no solution was found for the sites \a s1, \a s2, \a s3. print debug output, and return desperate_solution()
+solvers::Solution VertexPositioner::failed_solution(Site* s1, double k1, Site* s2, double k2, Site* s3) {
     // either 0, or >= 2 solutions found. This is an error.
     // std::cout << " None, or too many solutions found! solutions.size()=" << solutions.size() << "\n";
      
@@ -237,7 +301,7 @@ solvers::Solution VertexPositioner::position(Site* s1, double k1, Site* s2, doub
     }
     solver_debug(true);
     // run the solver(s) one more time in order to print out un-filtered solution points for debugging
-    std::vector<solvers::Solution> solutions2;
+    solvers::SolutionBuffer solutions2;
     solver_dispatch(s1,k1,s2,k2,s3,+1, solutions2);
     if (!s3->isPoint()) // for points k3=+1 always
         solver_dispatch(s1,k1,s2,k2,s3,-1, solutions2); // for lineSite or ArcSite we try k3=-1 also    
@@ -263,6 +327,7 @@ solvers::Solution VertexPositioner::position(Site* s1, double k1, Site* s2, doub
     //assert(0); // in Debug mode, stop here.
     
     solvers::Solution desp = desperate_solution(s3);  // ( p_mid, t_mid, desp_k3 ); 
+    desperate_count++;
     
     VertexError s1_err_functor(g, edge, s1);
     VertexError s2_err_functor(g, edge, s2);
@@ -363,18 +428,74 @@ void VertexPositioner::set_silent(bool b) {
     alt_sep_solver->set_silent(b);
 }
     
-/// dispatch to the correct solver based on the sites
+/// \brief return the number of vertices positioned in the given precision tier
+///
+/// summed over the point-point-point, line-line-line, and qll solvers, 
+/// which run in double first and escalate to dd_real and qd_real.
+/// \param tier solvers::DOUBLE_TIER, solvers::DD_TIER, or solvers::QD_TIER
+unsigned int VertexPositioner::solver_tier_count(int tier) const {
+    assert( (tier >= 0) && (tier < solvers::NUM_SOLVER_TIERS) );
+    return ppp_solver->tier_count(tier) + lll_solver->tier_count(tier) + qll_solver->tier_count(tier);
+}
+
+/// set the counters of solver_tier_count() to zero
+void VertexPositioner::reset_solver_tier_counts() {
+    ppp_solver->reset_tier_counts();
+    lll_solver->reset_tier_counts();
+    qll_solver->reset_tier_counts();
+}
+
+namespace {
+
+/// site-type tags, the digits of a dispatch key
+enum { P = 0, L = 1, A = 2 };
+
+/// the site-type tag of \a s
+inline int site_tag(const Site* s) {
+    return s->isPoint() ? P : ( s->isLine() ? L : A );
+}
+
+/// \brief dispatch key of the site-type triple (T1,T2,T3), as a compile-time constant
+template<int T1, int T2, int T3>
+struct triple {
+    /// key value, a base-3 number
+    enum { key = 9*T1 + 3*T2 + T3 };
+};
+
+/// dispatch key of the site-types \a t1, \a t2, \a t3
+inline int triple_key(int t1, int t2, int t3) {
+    return 9*t1 + 3*t2 + t3;
+}
+
+/// \brief call TSolver::solve() directly
+///
+/// the qualified call is resolved at compile time, and not through the vtable of Solver.
+template<class TSolver>
+inline int solve_with( TSolver* solver, Site* s1, double k1, Site* s2, double k2, 
+                       Site* s3, double k3, solvers::SolutionBuffer& slns ) {
+    return solver->TSolver::solve( s1, k1, s2, k2, s3, k3, slns );
+}
+
+} // end anonymous namespace
+
+/// \brief dispatch to the correct solver based on the sites
+///
+/// the site-types are looked up once, and the solver is chosen by a switch on
+/// the (s1,s2,s3) type-triple, except on ::SEPARATOR and ::PARA_LINELINE edges
+/// where the edge-type decides.
 int VertexPositioner::solver_dispatch(Site* s1, double k1, 
                                       Site* s2, double k2, 
                                       Site* s3, double k3, 
-                    std::vector<solvers::Solution>& solns) {
-
-
+                    solvers::SolutionBuffer& solns) {
+    int t1 = site_tag(s1);
+    int t2 = site_tag(s2);
+    int t3 = site_tag(s3);
+    
     if ( g[edge].type == SEPARATOR ) {
         // this is a SEPARATOR edge with two LineSites adjacent.
         // find the PointSite that defines the SEPARATOR, so that one LineSite and one PointSite
         // can be submitted to the Solver.
-        if ( s1->isLine() && s2->isLine() ) {
+        if ( t1 == L && t2 == L ) {
             // the parallel lineseg case      v0 --s1 --> pt -- s2 --> v1
             // find t
             if ( g[edge].has_null_face ) {
@@ -386,53 +507,51 @@ int VertexPositioner::solver_dispatch(Site* s1, double k1,
                 assert( s2->isPoint() );
                 k2 = +1;
             }
-        } else if ( s1->isPoint() && s2->isLine() ) {
+        } else if ( t1 == P && t2 == L ) {
             // a normal SEPARATOR edge, defined by a PointSite and a LineSite 
             // swap sites, so SEPSolver can assume s1=line s2=point
-            Site* tmp = s1;
-            double k_tmp = k1;
-            s1 = s2;
-            s2 = tmp;
-            k1 = k2;
-            k2 = k_tmp;
-            assert( s1->isLine() );
-            assert( s2->isPoint() );
+            std::swap(s1, s2);
+            std::swap(k1, k2);
         }
         assert( s1->isLine() && s2->isPoint() ); // we have previously set s1(line) s2(point)
-        return sep_solver->solve(s1,k1,s2,k2,s3,k3,solns); 
-    } else if ( g[edge].type == PARA_LINELINE  && s3->isLine() ) { // an edge betwee parallel LineSites
-        //std::cout << " para lineline! \n";
-        return lll_para_solver->solve( s1,k1,s2,k2,s3,k3, solns );
-    } else if ( s1->isLine() && s2->isLine() && s3->isLine() ) 
-        return lll_solver->solve( s1,k1,s2,k2,s3,k3, solns ); // all lines.
-    else if ( s1->isPoint() && s2->isPoint() && s3->isPoint() )
-        return ppp_solver->solve( s1,1,s2,1,s3,1, solns ); // all points, no need to specify k1,k2,k3, they are all +1
-    else if ( (s3->isLine() && s1->isPoint() ) || 
-              (s1->isLine() && s3->isPoint() ) ||
-              (s3->isLine() && s2->isPoint() ) ||
-              (s2->isLine() && s3->isPoint() ) // bad coverage for this line?
-            ) {
-        // if s1/s2 form a SEPARATOR-edge, this is dispatched automatically to sep-solver
-        // here we detect for a separator case between
-        // s1/s3
-        // s2/s3
-        if (s3->isLine() && s1->isPoint() ) {
+        return solve_with( sep_solver, s1,k1,s2,k2,s3,k3, solns );
+    } else if ( g[edge].type == PARA_LINELINE && t3 == L ) { // an edge betwee parallel LineSites
+        return solve_with( lll_para_solver, s1,k1,s2,k2,s3,k3, solns );
+    }
+    
+    switch ( triple_key(t1, t2, t3) ) {
+        case triple<L,L,L>::key: // all lines.
+            return solve_with( lll_solver, s1,k1,s2,k2,s3,k3, solns );
+        case triple<P,P,P>::key: // all points, no need to specify k1,k2,k3, they are all +1
+            return solve_with( ppp_solver, s1,1,s2,1,s3,1, solns );
+        // if s1/s2 form a SEPARATOR-edge, this is dispatched to sep-solver above.
+        // here we detect a separator case between s1/s3 or s2/s3
+        case triple<P,P,L>::key:
+        case triple<P,L,L>::key:
+        case triple<P,A,L>::key:
             if ( detect_sep_case(s3,s1) ) {
                 alt_sep_solver->set_type(0);
-                return alt_sep_solver->solve(s1, k1, s2, k2, s3, k3, solns );
+                return solve_with( alt_sep_solver, s1,k1,s2,k2,s3,k3, solns );
             }
-        }
-        if (s3->isLine() && s2->isPoint() ) {
+            if ( t2 == P && detect_sep_case(s3,s2) ) {
+                alt_sep_solver->set_type(1);
+                return solve_with( alt_sep_solver, s1,k1,s2,k2,s3,k3, solns );
+            }
+            break;
+        case triple<L,P,L>::key:
+        case triple<A,P,L>::key:
             if ( detect_sep_case(s3,s2) ) {
                 alt_sep_solver->set_type(1);
-                return alt_sep_solver->solve(s1, k1, s2, k2, s3, k3, solns );
+                return solve_with( alt_sep_solver, s1,k1,s2,k2,s3,k3, solns );
             }
-        }
-    } 
+            break;
+        default:
+            break;
+    }
     
     // if we didn't dispatch to a solver above, we try the general solver
-    return qll_solver->solve( s1,k1,s2,k2,s3,k3, solns ); // general case solver
-    
+    qll_dispatched = true;
+    return solve_with( qll_solver, s1,k1,s2,k2,s3,k3, solns ); // general case solver
 }
 
 /// detect separator-case, so we can dispatch to the correct Solver
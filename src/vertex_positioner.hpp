@@ -29,20 +29,45 @@
 namespace ovd {
 
 namespace solvers {
-class Solver; // fwd decl
+class PPPSolver; // fwd decl
+class LLLSolver; // fwd decl
+class LLLPARASolver; // fwd decl
+class QLLSolver; // fwd decl
+class SEPSolver; // fwd decl
+class ALTSEPSolver; // fwd decl
 }
 
+/// How VertexPositioner::position() uses the permutations of solvers::QLLSolver
+enum QLLMode {
+    QLL_BEST_FIRST,        /*!< solve the best-conditioned permutation, escalate to all three if that fails (default) */
+    QLL_FORCE_ESCALATION,  /*!< always escalate, as if the best-conditioned permutation had failed. For testing. */
+    QLL_ALL_PERMUTATIONS   /*!< always solve all three permutations, never escalate */
+};
+
 /// Calculates the (x,y) position of a VoronoiVertex in the VoronoiDiagram
 class VertexPositioner {
 public:
     VertexPositioner(HEGraph& gi);
     virtual ~VertexPositioner();
     solvers::Solution position( HEEdge e, Site* s);
+    bool circumcenter(Site* s1, Site* s2, Site* s3, solvers::Solution& sl);
     /// return vector of errors
     std::vector<double> get_stat() {return errstat;}
+    /// clear the error-statistics
+    void reset_stat() {errstat.clear();}
+    /// number of times position() has returned a desperate solution
+    unsigned int num_desperate() const {return desperate_count;}
+    /// number of times position() has escalated QLLSolver to all three permutations
+    unsigned int num_qll_escalations() const {return qll_escalation_count;}
+    /// set how QLLSolver permutations are used, see QLLMode
+    void set_qll_mode(QLLMode m) {qll_mode = m;}
+    /// the next \a n calls of position() count as desperate solutions, as if the solvers had failed. only for testing.
+    void force_desperate(unsigned int n) {forced_desperate = n;}
     double dist_error(HEEdge e, const solvers::Solution& sl, Site* s3);
     void solver_debug(bool b);
     void set_silent(bool b); ///< no warning messages when silent==true
+    unsigned int solver_tier_count(int tier) const;
+    void reset_solver_tier_counts();
 private:
 
     /// predicate for rejecting out-of-region solutions
@@ -77,9 +102,13 @@ private:
     };
 
     solvers::Solution position(Site* s1, double k1, Site* s2, double k2, Site* s3);
+    bool select_solution(solvers::SolutionBuffer& solutions, Site* s1, Site* s2, Site* s3, 
+                         bool warn, solvers::Solution& sl);
+    bool acceptable(solvers::Solution& sl, Site* s1, Site* s2, Site* s3);
+    solvers::Solution failed_solution(Site* s1, double k1, Site* s2, double k2, Site* s3);
     int solver_dispatch(Site* s1, double k1, 
                Site* s2, double k2, 
-               Site* s3, double k3, std::vector<solvers::Solution>& slns ); 
+               Site* s3, double k3, solvers::SolutionBuffer& slns ); 
     bool detect_sep_case(Site* lsite, Site* psite);
 
 // solution-filtering
@@ -95,12 +124,13 @@ private:
 
 // solvers, to which we dispatch, depending on the input sites
     
-    solvers::Solver* ppp_solver; ///< point-point-point solver
-    solvers::Solver* lll_solver; ///< line-line-line solver
-    solvers::Solver* lll_para_solver; ///< solver
-    solvers::Solver* qll_solver; ///< solver
-    solvers::Solver* sep_solver; ///< separator solver
-    solvers::Solver* alt_sep_solver; ///< alternative separator solver
+// held by their own type, so that solver_dispatch() can call solve() without a virtual call
+    solvers::PPPSolver* ppp_solver; ///< point-point-point solver
+    solvers::LLLSolver* lll_solver; ///< line-line-line solver
+    solvers::LLLPARASolver* lll_para_solver; ///< solver
+    solvers::QLLSolver* qll_solver; ///< solver
+    solvers::SEPSolver* sep_solver; ///< separator solver
+    solvers::ALTSEPSolver* alt_sep_solver; ///< alternative separator solver
 // DATA
     HEGraph& g;  ///< reference to the VD graph.
     double t_min; ///< minimum offset-distance
@@ -108,6 +138,11 @@ private:
     HEEdge edge;  ///< the edge on which we position a new vertex
     std::vector<double> errstat; ///< error-statistics
     bool silent; ///< silent mode (outputs no warnings to stdout)
+    unsigned int desperate_count; ///< number of desperate solutions returned, see num_desperate()
+    bool qll_dispatched; ///< solver_dispatch() has called the QLLSolver, since position() cleared this
+    QLLMode qll_mode; ///< see set_qll_mode()
+    unsigned int qll_escalation_count; ///< see num_qll_escalations()
+    unsigned int forced_desperate; ///< see force_desperate()
 };
 
 /// \brief error functor for edge-based desperate solver
@@ -19,29 +19,53 @@
 */
 
 #include <cassert>
+#include <algorithm>
+#include <fstream>
 
 #include <boost/foreach.hpp>
 #include <boost/math/tools/roots.hpp> // for toms748
 #include <boost/tuple/tuple.hpp>
 #include <boost/assign/list_of.hpp>
+#include <boost/random/mersenne_twister.hpp>
 
 #include "voronoidiagram.hpp"
 
 #include "checker.hpp"
 #include "common/numeric.hpp" // for diangle
+#include "common/hilbert.hpp"
+#include "site_validator.hpp"
+#include "undo_log.hpp"
+#include "diagram_archive.hpp"
 
 namespace ovd {
 
 /// \brief create a VoronoiDiagram
 /// \param far is the radius of a circle within which all sites must be located. use far==1.0
-/// \param n_bins is the number of bins for FaceGrid, the bucket-search for nearest-neighbors 
-///        used in insert_point_site(). Use roughly sqrt(N) for a voronoi-diagram with N sites.
-VoronoiDiagram::VoronoiDiagram(double far, unsigned int n_bins) {
-    kd_tree = new kdtree::KDTree<kd_point>(2); // kd-tree with dimension 2    
+/// \param n_bins is the number of bins for the bucket-grid used for nearest-neighbor search
+///        in insert_point_site(). Use roughly sqrt(N) for a voronoi-diagram with N sites.
+///        With n_bins==0 a kd-tree is used instead, see use_face_grid().
+VoronoiDiagram::VoronoiDiagram(double far, unsigned int n_bins_in) {
+    far_radius=far;
+    n_bins = n_bins_in;
+    kd_tree = 0;
+    face_grid = 0;
+    if (n_bins>0)
+        face_grid = new grid_type(far_radius,n_bins);
+    else
+        kd_tree = new kd_type(2); // kd-tree with dimension 2    
+    jump_and_walk = false;
+    walk_max_steps = 64;
+    validate_sites = false;
     vd_checker = new VoronoiDiagramChecker( g ); // helper-class that checks topology/geometry
     vpos = new VertexPositioner( g ); // helper-class that positions vertices
+    undo = 0;
+    insertion_error = false;
+    publish_interval = 0;
+    unpublished = 0;
+    changes = 0;
     
-    far_radius=far;
+    vertex_count = 0;
+    epoch = 1;
     initialize();
     num_psites=3;
     num_lsites=0;
@@ -53,12 +77,84 @@ VoronoiDiagram::VoronoiDiagram(double far, unsigned int n_bins) {
 /// \brief delete allocated resources.
 VoronoiDiagram::~VoronoiDiagram() { 
     //std::cout << "~VoronoiDiagram()\n";
-    delete kd_tree;
+    if (kd_tree)
+        delete kd_tree;
+    if (face_grid)
+        delete face_grid;
     delete vpos;
     delete vd_checker;
+    if (undo)
+        delete undo;
     //std::cout << "~VoronoiDiagram() DONE.\n";
 }
 
+/// \brief clear the diagram back to its initial state with three generators
+///
+/// The result is the same as deleting the diagram and constructing a new one with
+/// the given \a far radius, but the solvers, the helper-classes and the allocated 
+/// storage (graph, face-vector, sites, search-structure) are kept for reuse.
+/// The settings use_face_grid(), use_jump_and_walk(), use_site_validation(), use_rollback(), use_snapshot_publishing(),
+/// debug and silent are also kept. The reset counts as a change, see num_changes().
+/// \param far radius of the circle within which all sites must be located
+void VoronoiDiagram::reset(double far) {
+    far_radius = far;
+    g.clear();
+    site_arena.clear();
+    if (kd_tree)
+        kd_tree->clear();
+    if (face_grid)
+        face_grid->clear(far_radius);
+    vertex_map.clear();
+    while ( !vertexQueue.empty() )
+        vertexQueue.pop();
+    incident_faces.clear();
+    modified_vertices.clear();
+    v0.clear();
+    vpos->reset_stat();
+    
+    vertex_count = 0;
+    epoch = 1;
+    initialize();
+    num_psites=3;
+    num_lsites=0;
+    num_asites=0;
+    reset_vertex_count();
+    committed();
+    publish_pending();
+}
+
+/// \brief add a vertex to the graph, and give it the next index of this diagram
+HEVertex VoronoiDiagram::add_vertex(const VoronoiVertex& vv) {
+    HEVertex v = g.add_vertex(vv);
+    g[v].index = vertex_count;
+    vertex_count++;
+    return v;
+}
+
+/// \brief insert vertex \a v into the middle of edge \a e, see HEGraph::add_vertex_in_edge()
+///
+/// with use_rollback(), the faces on both sides of \a e are saved to the undo-log first.
+void VoronoiDiagram::add_vertex_in_edge(HEVertex v, HEEdge e) {
+    if (undo) {
+        undo->save_face( g[e].face );
+        undo->save_face( g[ g[e].twin ].face );
+    }
+    g.add_vertex_in_edge(v, e);
+}
+
+/// \brief remove the degree-two vertex \a v, see HEGraph::remove_deg2_vertex()
+///
+/// with use_rollback(), the faces on both sides of \a v are saved to the undo-log first.
+void VoronoiDiagram::remove_deg2_vertex(HEVertex v) {
+    if (undo) {
+        BOOST_FOREACH( HEEdge e, g.out_edge_itr(v) ) {
+            undo->save_face( g[e].face );
+            undo->save_face( g[ g[e].twin ].face );
+        }
+    }
+    g.remove_deg2_vertex(v);
+}
+
 /// \brief initialize the diagram with three generators
 ///
 /// add one vertex at origo and three vertices at 'infinity' and their associated edges
@@ -75,19 +171,19 @@ void VoronoiDiagram::initialize() {
     Point vd2 = Point( +3.0*sqrt(3.0)*far_radius*far_multiplier/2.0, +3.0*far_radius*far_multiplier/2.0);
     Point vd3 = Point( -3.0*sqrt(3.0)*far_radius*far_multiplier/2.0, +3.0*far_radius*far_multiplier/2.0);
     // add init vertices
-    HEVertex v00 = g.add_vertex( VoronoiVertex( Point(0,0), UNDECIDED, NORMAL, gen1 ) );
-    HEVertex v01 = g.add_vertex( VoronoiVertex( vd1, OUT, OUTER, gen3) );
-    HEVertex v02 = g.add_vertex( VoronoiVertex( vd2, OUT, OUTER, gen1) );
-    HEVertex v03 = g.add_vertex( VoronoiVertex( vd3, OUT, OUTER, gen2) );
+    HEVertex v00 = add_vertex( VoronoiVertex( Point(0,0), UNDECIDED, NORMAL, gen1 ) );
+    HEVertex v01 = add_vertex( VoronoiVertex( vd1, OUT, OUTER, gen3) );
+    HEVertex v02 = add_vertex( VoronoiVertex( vd2, OUT, OUTER, gen1) );
+    HEVertex v03 = add_vertex( VoronoiVertex( vd3, OUT, OUTER, gen2) );
     // add initial sites to graph 
-    HEVertex vert1 = g.add_vertex( VoronoiVertex( gen1 , OUT, POINTSITE) );
-    HEVertex vert2 = g.add_vertex( VoronoiVertex( gen2 , OUT, POINTSITE) );
-    HEVertex vert3 = g.add_vertex( VoronoiVertex( gen3 , OUT, POINTSITE) );
+    HEVertex vert1 = add_vertex( VoronoiVertex( gen1 , OUT, POINTSITE) );
+    HEVertex vert2 = add_vertex( VoronoiVertex( gen2 , OUT, POINTSITE) );
+    HEVertex vert3 = add_vertex( VoronoiVertex( gen3 , OUT, POINTSITE) );
 
     // apex-points on the three edges: 
-    HEVertex a1 = g.add_vertex( VoronoiVertex( 0.5*(gen2+gen3), UNDECIDED, APEX, gen2 ) );
-    HEVertex a2 = g.add_vertex( VoronoiVertex( 0.5*(gen1+gen3), UNDECIDED, APEX, gen3 ) );
-    HEVertex a3 = g.add_vertex( VoronoiVertex( 0.5*(gen1+gen2), UNDECIDED, APEX, gen1 ) );
+    HEVertex a1 = add_vertex( VoronoiVertex( 0.5*(gen2+gen3), UNDECIDED, APEX, gen2 ) );
+    HEVertex a2 = add_vertex( VoronoiVertex( 0.5*(gen1+gen3), UNDECIDED, APEX, gen3 ) );
+    HEVertex a3 = add_vertex( VoronoiVertex( 0.5*(gen1+gen2), UNDECIDED, APEX, gen1 ) );
 
     // add face 1: v0-v1-v2 which encloses gen3
     HEEdge e1_1 =  g.add_edge( v00 , a1 );    
@@ -96,10 +192,9 @@ void VoronoiDiagram::initialize() {
     HEEdge e3_1 =  g.add_edge( v02, a2  ); 
     HEEdge e3_2 =  g.add_edge( a2 , v00 ); 
     HEFace f1   =  g.add_face(); 
-    g[f1].site  = new PointSite(gen3,f1, vert3);
+    g[f1].site  = site_arena.create<PointSite>(gen3,f1, vert3);
     g[f1].status = NONINCIDENT;
-    //fgrid->add_face( f1, gen3 ); // for grid search
-    kd_tree->insert( kd_point(gen3,f1) );
+    nearest_index_insert( kd_point(gen3,f1) );
     g.set_next_cycle( list_of(e1_1)(e1_2)(e2)(e3_1)(e3_2) , f1 ,1);
 
     // add face 2: v0-v02-v03 which encloses gen1
@@ -109,10 +204,9 @@ void VoronoiDiagram::initialize() {
     HEEdge e6_1 = g.add_edge( v03, a3 );
     HEEdge e6_2 = g.add_edge( a3, v00 ); 
     HEFace f2   =  g.add_face();
-    g[f2].site  = new PointSite(gen1,f2, vert1);
+    g[f2].site  = site_arena.create<PointSite>(gen1,f2, vert1);
     g[f2].status = NONINCIDENT;    
-    //fgrid->add_face( f2, gen1 );
-    kd_tree->insert( kd_point(gen1,f2) );
+    nearest_index_insert( kd_point(gen1,f2) );
     g.set_next_cycle( list_of(e4_1)(e4_2)(e5)(e6_1)(e6_2) , f2 ,1);
 
     // add face 3: v0-v3-v1 which encloses gen2
@@ -122,11 +216,11 @@ void VoronoiDiagram::initialize() {
     HEEdge e9_1 = g.add_edge( v01, a1  ); 
     HEEdge e9_2 = g.add_edge( a1 , v00 ); 
     HEFace f3   =  g.add_face();
-    g[f3].site  = new PointSite(gen2,f3, vert2); // this constructor needs f3...
+    g[f3].site  = site_arena.create<PointSite>(gen2,f3, vert2); // this constructor needs f3...
     g[f3].status = NONINCIDENT;    
-    //fgrid->add_face( f3, gen2 );
-    kd_tree->insert( kd_point(gen2,f3) );
+    nearest_index_insert( kd_point(gen2,f3) );
     g.set_next_cycle( list_of(e7_1)(e7_2)(e8)(e9_1)(e9_2) , f3 , 1);    
+    last_point_face = f3;
 
     // set type. 
     g[e1_1].type = LINE;  g[e1_1].set_parameters(g[f1].site, g[f3].site, false);
@@ -155,11 +249,277 @@ void VoronoiDiagram::initialize() {
     g.twin_edges(e3_2, e4_1);
     g.twin_edges(e6_1, e7_2);
     g.twin_edges(e6_2, e7_1);
+    // twins were given the same parameters above, so they can share one EdgeParams record
+    g[e9_2].share_parameters( g[e1_1] );
+    g[e9_1].share_parameters( g[e1_2] );
+    g[e4_2].share_parameters( g[e3_1] );
+    g[e4_1].share_parameters( g[e3_2] );
+    g[e7_2].share_parameters( g[e6_1] );
+    g[e7_1].share_parameters( g[e6_2] );
     
     assert( vd_checker->is_valid() );
 }
 
 
+/// \brief select the nearest-neighbor search used by insert_point_site()
+///
+/// \param b true for the bucket-grid, false for the kd-tree.
+/// The grid has n_bins x n_bins cells, where n_bins was given to the constructor
+/// (if it was zero, sqrt() of the current number of point-sites is used). 
+/// The new search-structure is built from the point-sites already in the diagram.
+void VoronoiDiagram::use_face_grid(bool b) {
+    if ( b == using_face_grid() )
+        return;
+    if (b) {
+        if (n_bins==0)
+            n_bins = std::max( 1 , (int)sqrt( (double)num_psites ) );
+        face_grid = new grid_type(far_radius,n_bins);
+        delete kd_tree;
+        kd_tree = 0;
+    } else {
+        kd_tree = new kd_type(2);
+        delete face_grid;
+        face_grid = 0;
+    }
+    build_nearest_index();
+}
+
+/// clear the kd-tree or bucket-grid, and insert the point-sites of the diagram
+void VoronoiDiagram::build_nearest_index() {
+    if (kd_tree)
+        kd_tree->clear();
+    if (face_grid)
+        face_grid->clear(far_radius);
+    for (HEFace f=0;f<g.num_faces();f++) {
+        if ( g[f].site && g[f].site->isPoint() && !g[f].null ) // null-faces share the site of the endpoint
+            nearest_index_insert( kd_point( g[f].site->position(), f ) );
+    }
+}
+
+/// \brief turn jump-and-walk point location on/off
+///
+/// when on, insert_point_site() locates the face nearest to the new site
+/// by walking across voronoi-edges, starting from the face of the previously inserted site.
+/// For inputs that arrive in spatially coherent order (contours, sorted scans) the walk
+/// is only a few steps long. If the walk takes more than \a max_steps steps the
+/// kd-tree (or bucket-grid) is used instead.
+void VoronoiDiagram::use_jump_and_walk(bool b, unsigned int max_steps) {
+    jump_and_walk = b;
+    walk_max_steps = max_steps;
+}
+
+/// \brief return the number of vertex positions computed in the given precision tier
+///
+/// The vertex solvers run in double first, and escalate to dd_real and then
+/// qd_real only when a forward error bound cannot confirm the solution.
+/// \param tier 0 for double, 1 for dd_real, 2 for qd_real
+unsigned int VoronoiDiagram::solver_tier_count(int tier) const {
+    return vpos->solver_tier_count(tier);
+}
+
+/// set the counters of solver_tier_count() to zero
+void VoronoiDiagram::reset_solver_tier_counts() {
+    vpos->reset_solver_tier_counts();
+}
+
+/// \brief return the number of vertices for which the quadratic-linear-linear solver was
+/// escalated from its best-conditioned permutation to all three permutations
+unsigned int VoronoiDiagram::num_qll_escalations() const {
+    return vpos->num_qll_escalations();
+}
+
+/// \brief set how the quadratic-linear-linear solver uses its permutations, see QLLMode.
+/// The default QLL_BEST_FIRST should only be changed for testing.
+void VoronoiDiagram::set_qll_mode(QLLMode m) {
+    vpos->set_qll_mode(m);
+}
+
+/// \brief count the next \a n new vertices as desperate solutions, as if the solvers had failed for them.
+/// Only for testing the failure path of use_rollback().
+void VoronoiDiagram::force_desperate(unsigned int n) {
+    vpos->force_desperate(n);
+}
+
+/// \brief write the diagram to \a out, in the binary format of DiagramArchive
+///
+/// call this between insertions, not while an insertion is stopped with its \a step parameter.
+void VoronoiDiagram::save(std::ostream& out) {
+    DiagramArchive::save(*this, out);
+}
+
+/// \brief write the diagram to the file \a filename, see save()
+/// \return false if the file could not be written
+bool VoronoiDiagram::save_file(const std::string& filename) {
+    std::ofstream out( filename.c_str(), std::ios::out | std::ios::binary );
+    if (!out)
+        return false;
+    save(out);
+    out.close();
+    return !out.fail();
+}
+
+/// \brief replace this diagram with one written by save()
+///
+/// the settings of this diagram (search-structure, jump-and-walk, validation, rollback, publishing, silent) are kept,
+/// and sites can be inserted into the loaded diagram as usual. The load counts as a change, see num_changes().
+/// \return false, and leave the diagram unchanged, if \a data is not a valid archive
+bool VoronoiDiagram::load(const char* data, std::size_t size) {
+    return DiagramArchive::load(*this, data, size);
+}
+
+/// \brief load() from a file, which is memory-mapped instead of read into a buffer
+/// \return false, and leave the diagram unchanged, if the file cannot be mapped or is not a valid archive
+bool VoronoiDiagram::load_file(const std::string& filename) {
+    return DiagramArchive::load_file(*this, filename);
+}
+
+/// \brief publish snapshots of the diagram for reader threads
+///
+/// when on, a DiagramSnapshot is published after every \a interval committed changes (insertions
+/// and removals, see num_changes()), and at the end of insert_point_sites(), insert_line_sites() and
+/// insert_polyline(). Reader threads call published() to get the latest snapshot, and keep
+/// it as long as they need it. The diagram is not locked: the writer builds the next snapshot
+/// while readers use older ones, and a snapshot is deleted when the last reader drops it.
+/// A snapshot is published immediately when publishing is turned on.
+///
+/// Each publish() copies the whole diagram, so with large diagrams an \a interval of more than one
+/// (or publish() called by the writer) keeps the cost down. Failed insertions that were rolled back are
+/// not changes.
+void VoronoiDiagram::use_snapshot_publishing(bool b, unsigned int interval) {
+    publish_interval = b ? std::max( 1u, interval ) : 0;
+    if (b)
+        publish();
+    else
+        boost::atomic_store( &current_snapshot, SnapshotPtr() );
+}
+
+/// \brief publish a snapshot of the diagram now, see use_snapshot_publishing()
+///
+/// the previous snapshot is released. It is deleted here, or by the last reader that holds it.
+void VoronoiDiagram::publish() {
+    SnapshotPtr next( new DiagramSnapshot(g, changes) );
+    boost::atomic_store( &current_snapshot, next );
+    unpublished = 0;
+}
+
+/// count a committed change, and publish() if publish_interval changes were not published
+void VoronoiDiagram::committed() {
+    changes++;
+    if ( publish_interval && ++unpublished >= publish_interval )
+        publish();
+}
+
+/// publish() the changes that were not published yet, at the end of a bulk insertion
+void VoronoiDiagram::publish_pending() {
+    if ( publish_interval && unpublished )
+        publish();
+}
+
+/// \brief turn rollback of failed insertions on/off
+///
+/// when on, insert_point_site(), insert_line_site() (and the bulk insert functions that call them)
+/// record the changes they make in an UndoLog. If the insertion fails, the changes are undone and
+/// the diagram is left as it was before the call. An insertion fails if:
+/// - a vertex is placed with VertexPositioner::desperate_solution(), or with a distance-error above 1e-3
+/// - one of the new or modified faces does not pass VoronoiDiagramChecker::face_ok()
+/// - an exception is thrown
+/// - it was stopped with the \a step parameter
+///
+/// Failed assert()s still abort a debug build, so this is useful with NDEBUG builds.
+/// The Site objects of a failed insertion stay in the site-arena until reset().
+/// Off by default, since the log costs time and memory in every insertion.
+void VoronoiDiagram::use_rollback(bool b) {
+    if ( b == using_rollback() )
+        return;
+    if (b) {
+        undo = new UndoLog(g);
+    } else {
+        delete undo;
+        undo = 0;
+    }
+}
+
+/// \brief greedy walk from face \a start towards the face nearest to \a p
+///
+/// at each step we move to the adjacent face whose PointSite is closest to \a p.
+/// On a voronoi diagram of points this stops at the face of the nearest site.
+/// \return false if no face was found within walk_max_steps steps
+bool VoronoiDiagram::walk_to_nearest_face(HEFace start, const Point& p, HEFace& nearest) {
+    HEFace current = start;
+    double current_dist = (g[current].site->position()-p).norm_sq();
+    for (unsigned int step=0; step<walk_max_steps; step++) {
+        HEFace next = current;
+        double next_dist = current_dist;
+        HEEdge start_edge = g[current].edge;
+        HEEdge e = start_edge;
+        do { // look at the faces across each edge of the current face
+            HEEdge twin = g[e].twin;
+            Site* adj_site = ( twin != HEEdge() ) ? g[ g[twin].face ].site : 0; // OUTEDGE:s have no twin
+            if ( adj_site && adj_site->isPoint() ) {
+                HEFace adj = g[twin].face;
+                double d = (adj_site->position()-p).norm_sq();
+                if ( d < next_dist ) {
+                    next = adj;
+                    next_dist = d;
+                }
+            }
+            e = g[e].next;
+        } while ( e != start_edge );
+        if ( next == current ) { // no neighbor is closer, so we are done
+            nearest = current;
+            return true;
+        }
+        current = next;
+        current_dist = next_dist;
+    }
+    if (debug) std::cout << " walk_to_nearest_face() gave up after " << walk_max_steps << " steps\n";
+    return false;
+}
+
+/// insert a point-site into the kd-tree or bucket-grid
+void VoronoiDiagram::nearest_index_insert(const kd_point& pt) {
+    if (face_grid)
+        face_grid->insert(pt);
+    else
+        kd_tree->insert(pt);
+}
+
+/// remove the point-site \a pt from the kd-tree or bucket-grid
+void VoronoiDiagram::nearest_index_remove(const kd_point& pt) {
+    bool found;
+    if (face_grid)
+        found = face_grid->remove(pt);
+    else
+        found = kd_tree->remove(pt);
+    if ( !found && !silent )
+        std::cout << "openvoronoi warning: point-site at " << pt.p << " is not in the nearest-neighbor index.\n";
+}
+
+/// update the face of the point-site at the position of \a pt in the kd-tree or bucket-grid
+void VoronoiDiagram::nearest_index_update(const kd_point& pt) {
+    bool found;
+    if (face_grid)
+        found = face_grid->update(pt);
+    else
+        found = kd_tree->update(pt);
+    if ( !found && !silent )
+        std::cout << "openvoronoi warning: point-site at " << pt.p << " is not in the nearest-neighbor index.\n";
+}
+
+/// return the face of the point-site that is nearest to \a p
+HEFace VoronoiDiagram::find_nearest_face(const Point& p) {
+    HEFace walk_face;
+    if ( jump_and_walk && walk_to_nearest_face( last_point_face, p, walk_face ) )
+        return walk_face;
+    std::pair<kd_point,bool> nearest;
+    if (face_grid)
+        nearest = face_grid->nearest( kd_point(p) );
+    else
+        nearest = kd_tree->nearest( kd_point(p) ); 
+    assert( nearest.second );
+    return nearest.first.face;
+}
+
 /// \brief insert a PointSite into the diagram 
 ///
 /// \param p position of site
@@ -173,7 +533,7 @@ void VoronoiDiagram::initialize() {
 /// All PointSite:s must be inserted before any LineSite:s or ArcSite:s are inserted.
 /// This is roughly "algorithm A" from the Sugihara-Iri 1994 paper, page 15/50
 ///
-/// step-1 find the face that is closest to the new site, see kd_tree.nearest()
+/// step-1 find the face that is closest to the new site, see find_nearest_face()
 /// step-2 among the vertices on the closest face, find the seed vertex, see find_seed_vertex()
 /// step-3 grow the tree of IN-vertices, see augment_vertex_set()
 /// step-4 add new voronoi-vertices on all IN-OUT edges so they becone IN-NEW-OUT, see add_vertices()
@@ -181,7 +541,27 @@ void VoronoiDiagram::initialize() {
 /// step-6 repair the next-pointers of faces that have been modified. see repair_face()
 /// step-7 remove IN-IN edges and IN-NEW edges, see remove_vertex_set()
 /// step-8 reset vertex/face status to be ready for next incremental operation, see reset_status()
-int VoronoiDiagram::insert_point_site(const Point& p) {
+///
+/// With use_rollback(), -1 is returned if the insertion fails. The diagram is then unchanged.
+int VoronoiDiagram::insert_point_site(const Point& p, int step) {
+    begin_insertion();
+    int handle = -1;
+    try {
+        handle = add_point_site(p, step);
+    } catch (...) {
+        if (!undo)
+            throw;
+    }
+    if ( !end_insertion( handle != -1 ) )
+        return -1;
+    nearest_index_insert( kd_point( p, last_point_face ) );
+    return handle;
+}
+
+/// \brief the steps of insert_point_site()
+/// \return handle of the new point-site, or -1 if stopped at \a step
+int VoronoiDiagram::add_point_site(const Point& p, int step) {
+    int current_step=1;
     num_psites++;
     if (p.norm() >= far_radius ) {
         std::cout << "openvoronoi error. All points must lie within unit-circle. You are trying to add p= " << p 
@@ -189,29 +569,45 @@ int VoronoiDiagram::insert_point_site(const Point& p) {
     } 
     assert( p.norm() < far_radius );     // only add vertices within the far_radius circle
     
-    HEVertex new_vert = g.add_vertex( VoronoiVertex(p,OUT,POINTSITE) );
-    PointSite* new_site =  new PointSite(p);
+    HEVertex new_vert = add_vertex( VoronoiVertex(p,OUT,POINTSITE) );
+    PointSite* new_site =  site_arena.create<PointSite>(p);
     new_site->v = new_vert;
-    vertex_map.insert( VertexMapPair(g[new_vert].index,new_vert) ); // so that we can find the descriptor later based on its index
+    vertex_map.resize( g[new_vert].index+1 ); // so that we can find the descriptor later based on its index
+    vertex_map[ g[new_vert].index ] = new_vert;
 // step-1
-    std::pair<kd_point,bool> nearest = kd_tree->nearest( kd_point(p) ); 
-    assert( nearest.second );
+    HEFace nearest_face = find_nearest_face( p );
 // step-2
-    HEVertex v_seed = find_seed_vertex( nearest.first.face , new_site);
+    HEVertex v_seed = find_seed_vertex( nearest_face , new_site);
     mark_vertex( v_seed, new_site );
+    if (step==current_step) 
+        return -1;
+    current_step++;
 // step-3
     augment_vertex_set( new_site ); // grow the tree to maximum size
+    if (step==current_step) 
+        return -1;
+    current_step++;
 // step-4
     add_vertices( new_site );  // insert NEW vertices on IN-OUT edges so they becobe IN-NEW-OUT edges
+    if (step==current_step) 
+        return -1;
+    current_step++;
 // step-5
     HEFace newface = add_face( new_site );
     g[new_vert].face = newface; // Vertices that correspond to point-sites have their .face property set!
+    last_point_face = newface;
     BOOST_FOREACH( HEFace f, incident_faces ) { // add NEW-NEW edges on all INCIDENT faces
         add_edges(newface, f);
     }
+    if (step==current_step) 
+        return -1;
+    current_step++;
 // step-6
     repair_face( newface  );
     if (debug) { std::cout << " new face: "; g.print_face( newface ); }
+    if (step==current_step) 
+        return -1;
+    current_step++;
 // step-7
     remove_vertex_set(); // remove all IN vertices and adjacent edges
 // step-8
@@ -223,6 +619,66 @@ int VoronoiDiagram::insert_point_site(const Point& p) {
     return g[new_vert].index; // return index to user for later use e.g. inserting LineSite
 }
 
+/// with use_rollback(), save the state of the diagram and start the undo-log
+void VoronoiDiagram::begin_insertion() {
+    if (!undo)
+        return;
+    insertion_error = false;
+    checkpoint.num_psites = num_psites;
+    checkpoint.num_lsites = num_lsites;
+    checkpoint.vertex_count = vertex_count;
+    checkpoint.vertex_map_size = vertex_map.size();
+    checkpoint.last_point_face = last_point_face;
+    checkpoint.num_faces = g.num_faces();
+    checkpoint.num_desperate = vpos->num_desperate();
+    undo->begin(epoch);
+}
+
+/// \brief end the insertion started with begin_insertion()
+///
+/// without use_rollback() this returns \a ok. With use_rollback(), a failed insertion
+/// is undone and false is returned.
+/// \param ok false if the insertion threw or was stopped early
+bool VoronoiDiagram::end_insertion(bool ok) {
+    if (!undo) {
+        if (ok)
+            committed();
+        return ok;
+    }
+    if ( ok && insertion_ok() ) {
+        undo->commit();
+        committed();
+        return true;
+    }
+    reset_status(); // while the vertices in modified_vertices still exist
+    while ( !vertexQueue.empty() )
+        vertexQueue.pop();
+    undo->rollback();
+    num_psites = checkpoint.num_psites;
+    num_lsites = checkpoint.num_lsites;
+    vertex_count = checkpoint.vertex_count;
+    vertex_map.resize( checkpoint.vertex_map_size );
+    last_point_face = checkpoint.last_point_face;
+    if (!silent)
+        std::cout << "openvoronoi warning: insertion failed and was rolled back.\n";
+    return false;
+}
+
+/// true if the insertion placed all vertices accurately, and all new and modified faces are ok
+bool VoronoiDiagram::insertion_ok() {
+    if ( insertion_error || vpos->num_desperate() != checkpoint.num_desperate )
+        return false;
+    BOOST_FOREACH( HEFace f, undo->saved_faces() ) {
+        if ( !vd_checker->face_ok(f) )
+            return false;
+    }
+    for (HEFace f=checkpoint.num_faces; f<g.num_faces(); f++) {
+        if ( !vd_checker->face_ok(f) )
+            return false;
+    }
+    return true;
+}
+
 /// \brief insert a LineSite into the diagram
 ///
 /// \param idx1 int handle to startpoint of line-segment
@@ -254,12 +710,55 @@ int VoronoiDiagram::insert_point_site(const Point& p) {
 /// -# remove IN-IN edges and IN-NEW edges, see remove_vertex_set()
 /// -# remove ::SPLIT vertices
 /// -# reset vertex/face status to be ready for next incremental operation, see reset_status()
+///
+/// With use_rollback(), false is returned if the insertion fails. The diagram is then unchanged.
 bool VoronoiDiagram::insert_line_site(int idx1, int idx2, int step) {
-    num_lsites++;
-    int current_step=1;
     // find the vertices corresponding to idx1 and idx2
     HEVertex start=HEVertex(), end=HEVertex();
     boost::tie(start,end) = find_endpoints(idx1,idx2);
+    return insert_segment(start, end, step);
+}
+
+/// \brief insert a LineSite between the point-site vertices \a start and \a end
+///
+/// this is insert_line_site() after the handles have been looked up. insert_polyline()
+/// and insert_line_sites() call it directly with vertex descriptors they already hold.
+/// With use_rollback(), false is returned if the insertion fails. The diagram is then unchanged.
+/// \param joint if not null, the PolylineJoint of the previous segment of a polyline. it is
+/// replaced with the joint at \a end, or cleared if the insertion fails.
+bool VoronoiDiagram::insert_segment(HEVertex start, HEVertex end, int step, PolylineJoint* joint) {
+    begin_insertion();
+    bool ok = false;
+    try {
+        ok = add_line_site(start, end, step, joint);
+    } catch (...) {
+        if (!undo)
+            throw;
+    }
+    ok = end_insertion(ok);
+    if ( joint && !ok )
+        joint->endp = HEVertex();
+    return ok;
+}
+
+/// \brief the steps of insert_line_site()
+///
+/// If \a joint is the PolylineJoint at \a start, its seed candidates and null-edge are used
+/// instead of searching the faces at \a start. \a joint is then set to the joint at \a end.
+/// \return false if stopped at \a step
+bool VoronoiDiagram::add_line_site(HEVertex start, HEVertex end, int step, PolylineJoint* joint) {
+    PolylineJoint start_joint; // the joint at start, if any
+    if ( joint ) {
+        if ( joint->endp == start && g[start].null_face == joint->null_face )
+            start_joint = *joint;
+        joint->endp = HEVertex(); // set again below, when the segment is done
+    }
+    num_lsites++;
+    int current_step=1;
+    if (undo) {
+        undo->save_vertex(start);
+        undo->save_vertex(end);
+    }
     g[start].status=OUT;
     g[end].status=OUT;   
     g[start].zero_dist();
@@ -289,8 +788,8 @@ bool VoronoiDiagram::insert_line_site(int idx1, int idx2, int step) {
     //    pos_site = new LineSite( g[start].position, g[end  ].position , +1);
     //    neg_site = new LineSite( g[end  ].position, g[start].position , -1);
     //} else {
-    pos_site = new LineSite( g[end  ].position, g[start].position , +1);
-    neg_site = new LineSite( g[start].position, g[end  ].position , -1);
+    pos_site = site_arena.create<LineSite>( g[end  ].position, g[start].position , +1);
+    neg_site = site_arena.create<LineSite>( g[start].position, g[end  ].position , -1);
     //}
 
     if (step==current_step) 
@@ -299,8 +798,13 @@ bool VoronoiDiagram::insert_line_site(int idx1, int idx2, int step) {
 
     HEFace seed_face = g[start].face; // assumes this point-site has a face!
     
-    // on the face of start-point, find the seed vertex
-    HEVertex v_seed = find_seed_vertex(seed_face, pos_site ) ;
+    // on the face of start-point, find the seed vertex. at a polyline joint, try the separator targets first.
+    // nothing has been removed from the diagram since the joint was made, so they are still vertices of the diagram
+    HEVertex v_seed = HEVertex();
+    if ( start_joint.endp != HEVertex() )
+        v_seed = find_joint_seed( start_joint, pos_site );
+    if ( v_seed == HEVertex() )
+        v_seed = find_seed_vertex(seed_face, pos_site ) ;
     if (debug) std::cout << " start face seed  = " << g[v_seed].index << "\n";
     mark_vertex( v_seed, pos_site  );
 
@@ -318,6 +822,15 @@ bool VoronoiDiagram::insert_line_site(int idx1, int idx2, int step) {
         return false; 
     current_step++;
 
+    if (undo) { // the faces around the endpoints are modified below, but may not be INCIDENT
+        undo->save_face( g[start].face );
+        undo->save_face( g[end].face );
+        if ( g[start].null_face != g.HFace() ) // existing null-faces, and the faces of their separators
+            undo->save_face_and_neighbors( g[start].null_face );
+        if ( g[end].null_face != g.HFace() )
+            undo->save_face_and_neighbors( g[end].null_face );
+    }
+
     // process the null-faces here
     HEVertex seg_start, seg_end; // new segment end-point vertices. these are created here.
     HEFace start_null_face, end_null_face; // either existing or new null-faces at endpoints
@@ -330,7 +843,8 @@ bool VoronoiDiagram::insert_line_site(int idx1, int idx2, int step) {
     // returns new seg_start/end vertices, new or existing null-faces, and separator endpoints (if separators should be added)
     Point dir2 = g[start].position - g[end].position;
     Point dir1 = g[end].position - g[start].position;
-    boost::tie(seg_start, start_null_face, pos_sep_start, neg_sep_start, start_to_null) = find_null_face(start, end  , left, dir1, pos_site);
+    HEEdge start_null_edge = ( start_joint.endp != HEVertex() ) ? start_joint.null_edge : HEEdge();
+    boost::tie(seg_start, start_null_face, pos_sep_start, neg_sep_start, start_to_null) = find_null_face(start, end  , left, dir1, pos_site, start_null_edge);
     boost::tie(seg_end  , end_null_face  , pos_sep_end  , neg_sep_end  , end_to_null  ) = find_null_face(end  , start, left, dir2, pos_site);
 
     // now safe to set the zero-face edge
@@ -387,6 +901,7 @@ bool VoronoiDiagram::insert_line_site(int idx1, int idx2, int step) {
         return false; 
     current_step++;
 
+    PolylineJoint end_joint; // the joint at end, for the next segment of a polyline
     { // add SEPARATORS
         // find SEPARATOR targets first
         typedef boost::tuple<HEEdge, HEVertex, HEEdge,bool> SepTarget;
@@ -413,6 +928,8 @@ bool VoronoiDiagram::insert_line_site(int idx1, int idx2, int step) {
         SepTarget pos_end_target, neg_end_target;
         pos_end_target = find_separator_target( g[end].face ,  pos_sep_end);
         neg_end_target = find_separator_target( g[end].face , neg_sep_end);
+        end_joint.seeds[0] = boost::get<1>(pos_end_target);
+        end_joint.seeds[1] = boost::get<1>(neg_end_target);
         // add positive separator edge at end
         add_separator( g[end].face , end_null_face, pos_end_target, pos_sep_end, g[pos_face].site , g[neg_face].site );
         
@@ -485,6 +1002,21 @@ bool VoronoiDiagram::insert_line_site(int idx1, int idx2, int step) {
     assert( vd_checker->face_ok( neg_face ) );    
     assert( vd_checker->is_valid() );
 
+    if ( joint ) {
+        end_joint.endp = end;
+        end_joint.null_face = end_null_face;
+        end_joint.null_edge = HEEdge();
+        if ( pos_sep_end != HEVertex() && neg_sep_end != HEVertex() ) {
+            // the null-edge between the two separators faces the point-site face of end
+            HEEdge next_edge, prev_edge;
+            boost::tie(next_edge,prev_edge) = g.find_next_prev(end_null_face, pos_sep_end);
+            if ( g[ g[next_edge].twin ].face == g[end].face )
+                end_joint.null_edge = next_edge;
+            else if ( g[ g[prev_edge].twin ].face == g[end].face )
+                end_joint.null_edge = prev_edge;
+        }
+        *joint = end_joint;
+    }
     return true; 
 }
 
@@ -519,11 +1051,11 @@ void VoronoiDiagram::insert_arc_site(int idx1, int idx2, const Point& center, bo
     ArcSite* pos_site;
     ArcSite* neg_site;
     if (cw) {
-        pos_site = new ArcSite( g[end  ].position, g[start].position , center, cw);
-        neg_site = new ArcSite( g[start].position, g[end  ].position , center, !cw);
+        pos_site = site_arena.create<ArcSite>( g[end  ].position, g[start].position , center, cw);
+        neg_site = site_arena.create<ArcSite>( g[start].position, g[end  ].position , center, !cw);
     } else {
-        pos_site = new ArcSite( g[start].position, g[end].position , center, !cw);
-        neg_site = new ArcSite( g[end].position, g[start].position , center, cw);
+        pos_site = site_arena.create<ArcSite>( g[start].position, g[end].position , center, !cw);
+        neg_site = site_arena.create<ArcSite>( g[end].position, g[start].position , center, cw);
     }
     
     if (debug) {
@@ -733,20 +1265,591 @@ void VoronoiDiagram::insert_arc_site(int idx1, int idx2, const Point& center, bo
     assert( vd_checker->face_ok( pos_face ) );
     assert( vd_checker->face_ok( neg_face ) );    
     assert( vd_checker->is_valid() );
+    committed();
+}
+
+/// sort-key for insert_point_sites() and insert_line_sites()
+struct BrioKey {
+    unsigned int round;   ///< BRIO round, inserted in increasing order
+    unsigned int hilbert; ///< position along the Hilbert curve within the round
+    unsigned int idx;     ///< index into the caller's point vector
+    /// order by round, then by position along the curve
+    bool operator<(const BrioKey& other) const {
+        if (round != other.round)
+            return round < other.round;
+        return hilbert < other.hilbert;
+    }
+};
 
-    //return true; 
+/// \brief insert many PointSite:s, in an order that is good for the incremental algorithm
+///
+/// \param points positions of the sites
+/// \return the handles of the sites, in the same order as \a points
+///
+/// The points are inserted in biased randomized insertion order (BRIO, Amenta, Choi and Rote 2003):
+/// each point is put in one of about log2(n) rounds with a geometric distribution, so that the first
+/// round holds a few points and each following round roughly doubles the number of sites in the diagram. This keeps the expected O(n log n) running time of a random order also for grids
+/// and sorted input. Within a round the points are sorted along a Hilbert curve, whose direction
+/// is reversed in every other round so that a round starts close to where the previous one ended.
+/// Points are located with jump-and-walk from the previous site during the bulk insertion.
+///
+/// The same rules as for insert_point_site() apply: no duplicate points, and all points inside far_radius.
+/// With use_site_validation(), a point at the position of an earlier point-site (in the diagram, or
+/// earlier in \a points) is not inserted, and its handle is -1.
+std::vector<int> VoronoiDiagram::insert_point_sites(const std::vector<Point>& points) {
+    std::vector<int> handles( points.size(), -1 );
+    if ( points.empty() )
+        return handles;
+    std::vector<bool> skip( points.size(), false );
+    if ( validate_sites ) {
+        // the point-sites already in the diagram come first, so that only new points are skipped
+        std::vector<Point> all;
+        BOOST_FOREACH( HEVertex v, vertex_map ) {
+            if ( v != HEVertex() )
+                all.push_back( g[v].position );
+        }
+        unsigned int n_old = all.size();
+        all.insert( all.end(), points.begin(), points.end() );
+        SiteValidator validator;
+        BOOST_FOREACH( const SiteConflict& c, validator.duplicate_points(all) ) {
+            if ( c.second < (int)n_old || skip[ c.second-n_old ] )
+                continue;
+            skip[ c.second-n_old ] = true;
+            if (!silent) std::cout << "insert_point_sites() WARNING: point " << c.second-n_old << " is a duplicate, not inserted\n";
+        }
+    }
+    HilbertOrder curve(points);
+    unsigned int last_round = 0; // rounds 0..last_round, about log2(n) of them
+    while ( (2u<<last_round) < points.size() )
+        last_round++;
+    
+    boost::mt19937 rng(42); // fixed seed, so that the handles do not change from run to run
+    std::vector<BrioKey> order( points.size() );
+    for (unsigned int n=0; n<points.size(); ++n) {
+        // the number of leading 1-bits has a geometric distribution. more 1-bits means an earlier round.
+        unsigned int bits = rng();
+        unsigned int ones = 0;
+        while ( ones < last_round && (bits & (1u<<ones)) )
+            ones++;
+        order[n].round = last_round - ones;
+        order[n].hilbert = curve.index( points[n] );
+        if ( order[n].round % 2 )
+            order[n].hilbert = ~order[n].hilbert; // reverse the curve direction
+        order[n].idx = n;
+    }
+    std::sort( order.begin(), order.end() );
+    
+    bool walk = jump_and_walk;
+    jump_and_walk = true;
+    BOOST_FOREACH( const BrioKey& key, order ) {
+        if ( !skip[key.idx] )
+            handles[key.idx] = insert_point_site( points[key.idx] );
+    }
+    jump_and_walk = walk;
+    publish_pending();
+    return handles;
+}
+
+/// \brief insert many LineSite:s, ordered by chain and by position along a Hilbert curve
+///
+/// \param segments pairs of point-site handles, as returned by insert_point_site()
+/// \return true for each segment that was inserted, in the same order as \a segments
+///
+/// The segments are split into chains: a chain continues through a point-site that
+/// is the endpoint of exactly two segments. Each chain is inserted in one go, so that
+/// each segment meets the null-face that the previous segment left at their common
+/// endpoint. The chains are inserted in the order of the midpoint of their first
+/// segment along a Hilbert curve, so that consecutive insertions touch nearby
+/// parts of the diagram.
+///
+/// A segment with an unknown handle, or with both ends at the same point-site, is
+/// not inserted and reported as false. Otherwise the rules of insert_line_site() apply:
+/// all point-sites first, and no intersecting segments. With use_site_validation(),
+/// segments that intersect each other or a LineSite in the diagram are not inserted either.
+std::vector<bool> VoronoiDiagram::insert_line_sites(const std::vector< std::pair<int,int> >& segments) {
+    unsigned int n_segs = segments.size();
+    std::vector<bool> result( n_segs, false );
+    std::vector<bool> done( n_segs, true ); // invalid segments are marked done, and never inserted
+    // segments at each point-site handle, in compressed rows: segments at handle h are
+    // incident[ first[h] ] .. incident[ first[h+1]-1 ]
+    std::vector<unsigned int> first( vertex_map.size()+1, 0 );
+    std::vector<Point> midpoints;
+    std::vector<Point> valid_midpoints; // for the bounding box of the Hilbert curve
+    for (unsigned int n=0; n<n_segs; ++n) {
+        int i1 = segments[n].first;
+        int i2 = segments[n].second;
+        if ( i1 < 0 || i2 < 0 || i1 >= (int)vertex_map.size() || i2 >= (int)vertex_map.size() ||
+             i1 == i2 || vertex_map[i1] == HEVertex() || vertex_map[i2] == HEVertex() ) {
+            if (!silent) std::cout << "insert_line_sites() WARNING: segment " << n << " has invalid handles " << i1 << " - " << i2 << "\n";
+            midpoints.push_back( Point(0,0) );
+            continue;
+        }
+        done[n] = false;
+        midpoints.push_back( 0.5*( g[ vertex_map[i1] ].position + g[ vertex_map[i2] ].position ) );
+    }
+    if ( validate_sites ) {
+        std::vector< std::pair<int,int> > valid;
+        std::vector<unsigned int> valid_idx;
+        for (unsigned int n=0; n<n_segs; ++n) {
+            if ( !done[n] ) {
+                valid.push_back( segments[n] );
+                valid_idx.push_back( n );
+            }
+        }
+        std::vector<bool> bad = find_intersecting_segments( valid );
+        for (unsigned int m=0; m<valid.size(); ++m) {
+            if ( bad[m] ) {
+                done[ valid_idx[m] ] = true;
+                if (!silent) std::cout << "insert_line_sites() WARNING: segment " << valid_idx[m] << " intersects another segment, not inserted\n";
+            }
+        }
+    }
+    for (unsigned int n=0; n<n_segs; ++n) {
+        if ( done[n] )
+            continue;
+        first[ segments[n].first+1 ]++;
+        first[ segments[n].second+1 ]++;
+        valid_midpoints.push_back( midpoints[n] );
+    }
+    for (unsigned int h=1; h<first.size(); ++h)
+        first[h] += first[h-1];
+    std::vector<unsigned int> incident( first.back() );
+    std::vector<unsigned int> fill( first.begin(), first.end()-1 );
+    for (unsigned int n=0; n<n_segs; ++n) {
+        if ( done[n] )
+            continue;
+        incident[ fill[segments[n].first]++ ] = n;
+        incident[ fill[segments[n].second]++ ] = n;
+    }
+    
+    // walk the chains. open chains are started at an end (a handle that does not have two segments),
+    // then what remains are closed loops.
+    HilbertOrder curve(valid_midpoints);
+    std::vector<unsigned int> order; // segments, chain after chain
+    std::vector<unsigned int> chain_start; // position in order where each chain starts
+    std::vector<BrioKey> chains; // BrioKey::idx is the chain number
+    for (int pass=0; pass<2; ++pass) {
+        for (unsigned int n=0; n<n_segs; ++n) {
+            if ( done[n] )
+                continue;
+            int from = segments[n].first;
+            if ( pass == 0 ) {
+                if ( first[from+1]-first[from] == 2 )
+                    from = segments[n].second;
+                if ( first[from+1]-first[from] == 2 )
+                    continue; // not the end of a chain
+            }
+            BrioKey chain;
+            chain.round = 0;
+            chain.hilbert = curve.index( midpoints[n] );
+            chain.idx = chains.size();
+            chains.push_back( chain );
+            chain_start.push_back( order.size() );
+            unsigned int s = n;
+            for (;;) {
+                done[s] = true;
+                order.push_back(s);
+                int to = ( segments[s].first == from ) ? segments[s].second : segments[s].first;
+                if ( first[to+1]-first[to] != 2 )
+                    break;
+                unsigned int next = incident[ first[to] ];
+                if ( next == s )
+                    next = incident[ first[to]+1 ];
+                if ( done[next] )
+                    break;
+                from = to;
+                s = next;
+            }
+        }
+    }
+    chain_start.push_back( order.size() );
+    std::stable_sort( chains.begin(), chains.end() );
+    
+    BOOST_FOREACH( const BrioKey& chain, chains ) {
+        for (unsigned int m=chain_start[chain.idx]; m<chain_start[chain.idx+1]; ++m) {
+            unsigned int seg = order[m];
+            result[seg] = insert_segment( vertex_map[segments[seg].first], vertex_map[segments[seg].second] );
+        }
+    }
+    publish_pending();
+    return result;
+}
 
+/// \brief insert the LineSite:s of a polyline, one segment after the other
+///
+/// \param handles point-site handles, as returned by insert_point_site(), in the order of the polyline
+/// \param closed if true, a last segment from handles.back() to handles.front() closes the polyline
+/// \return true if all segments were inserted
+///
+/// The handles are checked and looked up once, before any segment is inserted. If a handle
+/// is unknown, or two consecutive handles are equal, a warning is printed (unless silent)
+/// and nothing is inserted. A closed polyline may, but need not, repeat its first handle at the end.
+/// With use_site_validation(), nothing is inserted if a segment intersects another
+/// segment of the polyline, or a LineSite in the diagram.
+///
+/// Each segment starts at the vertex where the previous segment ended. The previous
+/// segment leaves a PolylineJoint there: the null-face and its edge towards the point-site
+/// face, and the separator targets on that face. The next segment inserts its endpoint in
+/// that null-edge, and takes its seed vertex from the separator targets, instead of searching
+/// the null-face and the point-site face. The searches are still used when a joint value does not
+/// apply, e.g. when the polyline continues straight so that no separator target is in conflict.
+/// The rules of insert_line_site() apply: all point-sites first, and no intersecting segments.
+bool VoronoiDiagram::insert_polyline(const std::vector<int>& handles, bool closed) {
+    unsigned int n_pts = handles.size();
+    if ( closed && n_pts > 1 && handles.front() == handles.back() )
+        n_pts--; // the closing segment is added below
+    if ( n_pts < 2 ) {
+        if (!silent) std::cout << "insert_polyline() WARNING: polyline has less than two points\n";
+        return false;
+    }
+    VertexVector verts;
+    verts.reserve( n_pts );
+    for (unsigned int n=0; n<n_pts; ++n) {
+        int h = handles[n];
+        if ( h < 0 || h >= (int)vertex_map.size() || vertex_map[h] == HEVertex() ) {
+            if (!silent) std::cout << "insert_polyline() WARNING: invalid handle " << h << " at position " << n << "\n";
+            return false;
+        }
+        if ( n > 0 && h == handles[n-1] ) {
+            if (!silent) std::cout << "insert_polyline() WARNING: repeated handle " << h << " at position " << n << "\n";
+            return false;
+        }
+        verts.push_back( vertex_map[h] );
+    }
+    if ( closed && n_pts == 2 ) {
+        if (!silent) std::cout << "insert_polyline() WARNING: closed polyline with two points\n";
+        return false;
+    }
+    if ( validate_sites ) {
+        std::vector< std::pair<int,int> > segs;
+        for (unsigned int n=0; n+1<n_pts; ++n)
+            segs.push_back( std::make_pair( handles[n], handles[n+1] ) );
+        if ( closed )
+            segs.push_back( std::make_pair( handles[n_pts-1], handles[0] ) );
+        std::vector<bool> bad = find_intersecting_segments( segs );
+        if ( std::find( bad.begin(), bad.end(), true ) != bad.end() ) {
+            if (!silent) std::cout << "insert_polyline() WARNING: polyline intersects itself or a LineSite, not inserted\n";
+            return false;
+        }
+    }
+    bool ok = true;
+    PolylineJoint joint;
+    for (unsigned int n=0; n+1<n_pts; ++n)
+        ok = insert_segment( verts[n], verts[n+1], 99, &joint ) && ok;
+    if ( closed )
+        ok = insert_segment( verts[n_pts-1], verts[0], 99, &joint ) && ok;
+    publish_pending();
+    return ok;
+}
+
+/// \brief remove a PointSite from the diagram
+///
+/// \param handle the int handle returned by insert_point_site() or insert_point_sites()
+/// \return false if \a handle is not a point-site in the diagram, or if the site can not be removed
+///
+/// \details
+/// Only the face of the removed site is rebuilt, so the cost is proportional to the number of edges of
+/// the face, not to the number of sites in the diagram. The steps are:
+/// -# walk around the face of the site, and find the neighbor faces, in counterclockwise order
+/// -# triangulate the hole among the neighbor sites, see triangulate_hole()
+/// -# remove the edges (and ::APEX vertices) of the face, and the vertex of the site
+/// -# add a ::NORMAL vertex at the circumcenter of each triangle, and connect these with new edges,
+///    so that the neighbor faces divide the area of the removed face. see add_bisector_edge()
+/// -# repair the next-pointers of all new edges, and of the edges into the vertices on the old face boundary
+/// -# the vertices on the old face boundary now have degree two, and are removed with remove_deg2_vertex()
+/// -# remove the face with HEGraph::remove_face(). The last face takes its index.
+///
+/// \attention Only supported before any LineSite or ArcSite is inserted.
+/// The removal is not covered by use_rollback(). The Site object stays in the site-arena until reset().
+bool VoronoiDiagram::remove_point_site(int handle) {
+    if ( handle < 0 || handle >= (int)vertex_map.size() || vertex_map[handle] == HEVertex() ) {
+        if (!silent)
+            std::cout << "openvoronoi warning: remove_point_site(" << handle << ") is not a point-site.\n";
+        return false;
+    }
+    if ( num_lsites > 0 || num_asites > 0 ) {
+        if (!silent)
+            std::cout << "openvoronoi warning: remove_point_site() is not supported after line- or arc-sites are inserted.\n";
+        return false;
+    }
+    HEVertex site_vertex = vertex_map[handle];
+    HEFace f = g[site_vertex].face;
+    Point p = g[site_vertex].position;
+    
+    // the boundary of f, starting at the first edge along some neighbor face
+    EdgeVector boundary;
+    HEEdge start = g[f].edge;
+    HEEdge current = start;
+    do {
+        boundary.push_back( current );
+        current = g[current].next;
+    } while ( current != start );
+    unsigned int first = 0;
+    while ( first < boundary.size() && 
+            g[ g[ boundary[first] ].twin ].face == g[ g[ boundary[(first+boundary.size()-1)%boundary.size()] ].twin ].face )
+        first++;
+    if ( first == boundary.size() ) {
+        if (!silent)
+            std::cout << "openvoronoi warning: remove_point_site(" << handle << ") the face has only one neighbor.\n";
+        return false;
+    }
+    std::rotate( boundary.begin(), boundary.begin()+first, boundary.end() );
+    
+    // neighbor faces, and the corners between them. corner[j] is between nbr[j-1] and nbr[j].
+    // other vertices on the boundary are APEX vertices that split an edge to one neighbor.
+    std::vector<HEFace> nbr;
+    std::vector<Site*> q;
+    VertexVector corner;
+    VertexVector apex;
+    for (unsigned int n=0; n<boundary.size(); n++) {
+        HEFace twin_face = g[ g[ boundary[n] ].twin ].face;
+        if ( n == 0 || twin_face != nbr.back() ) {
+            nbr.push_back( twin_face );
+            q.push_back( g[twin_face].site );
+            corner.push_back( g.source( boundary[n] ) );
+        } else {
+            apex.push_back( g.source( boundary[n] ) );
+        }
+    }
+    unsigned int m = nbr.size();
+    std::vector<unsigned int> ears;
+    std::vector<solvers::Solution> circles;
+    if ( m < 3 || !triangulate_hole(q, p, ears, circles) ) {
+        if (!silent)
+            std::cout << "openvoronoi warning: remove_point_site(" << handle << ") could not triangulate the hole.\n";
+        return false;
+    }
+    if (debug) std::cout << "remove_point_site( " << handle << " ) face " << f << " with " << m << " neighbors\n";
+
+    // remove the face boundary
+    BOOST_FOREACH( HEEdge e, boundary ) {
+        g.remove_edge( g[e].twin );
+        g.remove_edge( e );
+    }
+    BOOST_FOREACH( HEVertex v, apex ) {
+        g.remove_vertex( v );
+    }
+    g.remove_vertex( site_vertex );
+    
+    // replay the ear-clipping, and add a vertex and edges for each triangle.
+    // side[j] is the vertex on the far side of the polygon-side from q[j] to q[nxt[j]].
+    std::vector<unsigned int> prv(m), nxt(m);
+    VertexVector side(m);
+    for (unsigned int j=0; j<m; j++) {
+        prv[j] = (j+m-1)%m;
+        nxt[j] = (j+1)%m;
+        side[j] = corner[ nxt[j] ];
+    }
+    VertexVector touched( corner.begin(), corner.end() );
+    for (unsigned int n=0; n<ears.size(); n++) {
+        unsigned int j = ears[n];
+        HEVertex w = add_vertex( VoronoiVertex( circles[n].p, UNDECIDED, NORMAL, q[j]->position() ) );
+        touched.push_back( w );
+        add_bisector_edge( side[ prv[j] ], w, nbr[ prv[j] ], nbr[j], touched );
+        add_bisector_edge( side[j], w, nbr[j], nbr[ nxt[j] ], touched );
+        if ( n+1 == ears.size() ) // the last triangle
+            add_bisector_edge( side[ nxt[j] ], w, nbr[ nxt[j] ], nbr[ prv[j] ], touched );
+        side[ prv[j] ] = w;
+        nxt[ prv[j] ] = nxt[j];
+        prv[ nxt[j] ] = prv[j];
+    }
+    BOOST_FOREACH( HEVertex v, touched ) {
+        repair_next( v );
+    }
+    BOOST_FOREACH( HEVertex v, corner ) { // the bisector through the corner now continues to a new vertex
+        remove_deg2_vertex( v );
+    }
+    #ifndef NDEBUG
+    BOOST_FOREACH( HEFace n, nbr ) {
+        assert( vd_checker->face_ok( n ) );
+    }
+    #endif
+
+    // the last face moves to index f
+    HEFace last = g.num_faces()-1;
+    HEFace walk_face = nbr[0];
+    nearest_index_remove( kd_point( p, f ) );
+    g.remove_face( f );
+    if ( f != last ) {
+        Site* moved = g[f].site;
+        g[ moved->vertex() ].face = f;
+        nearest_index_update( kd_point( moved->position(), f ) );
+        if ( walk_face == last )
+            walk_face = f;
+    }
+    if ( last_point_face == f )
+        last_point_face = walk_face;
+    else if ( last_point_face == last )
+        last_point_face = f;
+    vertex_map[handle] = HEVertex();
+    num_psites--;
+    
+    assert( vd_checker->is_valid() );
+    committed();
+    return true;
+}
+
+/// \brief Delaunay triangulation of the hole left by a removed PointSite at \a p
+///
+/// \param q the sites of the neighbor faces, counterclockwise around \a p. They form a polygon
+///        that is star-shaped as seen from \a p.
+/// \param ears the order in which ears of the polygon are clipped, as indices into \a q.
+///        The last ear is the final triangle.
+/// \param circles the circumcircle of each clipped ear
+/// \return false if at some point there is no convex ear
+///
+/// A convex ear is clipped if \a p has the largest power with respect to its circumcircle.
+/// This ear is a Delaunay triangle of the remaining sites (O. Devillers,
+/// "On deletion in Delaunay triangulations", 1999). 
+/// The ears are found with a linear search, which is fast for the typical face with six edges.
+bool VoronoiDiagram::triangulate_hole(const std::vector<Site*>& q, const Point& p,
+                                      std::vector<unsigned int>& ears, std::vector<solvers::Solution>& circles) {
+    unsigned int m = q.size();
+    std::vector<unsigned int> prv(m), nxt(m);
+    std::vector<bool> convex(m);
+    std::vector<double> power(m);
+    std::vector<solvers::Solution> circle( m, solvers::Solution( Point(0,0), 0, +1 ) );
+    for (unsigned int j=0; j<m; j++) {
+        prv[j] = (j+m-1)%m;
+        nxt[j] = (j+1)%m;
+    }
+    for (unsigned int j=0; j<m; j++)
+        convex[j] = hole_ear( q[prv[j]], q[j], q[nxt[j]], p, circle[j], power[j] );
+    unsigned int j0 = 0;
+    for (unsigned int left=m; left>3; left--) {
+        int best = -1;
+        unsigned int j = j0;
+        do {
+            if ( convex[j] && ( best == -1 || power[j] > power[best] ) )
+                best = j;
+            j = nxt[j];
+        } while ( j != j0 );
+        if ( best == -1 )
+            return false;
+        ears.push_back( best );
+        circles.push_back( circle[best] );
+        nxt[ prv[best] ] = nxt[best];
+        prv[ nxt[best] ] = prv[best];
+        j0 = prv[best];
+        convex[j0] = hole_ear( q[prv[j0]], q[j0], q[nxt[j0]], p, circle[j0], power[j0] );
+        j = nxt[best];
+        convex[j] = hole_ear( q[prv[j]], q[j], q[nxt[j]], p, circle[j], power[j] );
+    }
+    if ( !convex[j0] )
+        return false;
+    ears.push_back( j0 );
+    circles.push_back( circle[j0] );
+    return true;
+}
+
+/// \brief the circumcircle of the ear \a s1 - \a s2 - \a s3, and the power of \a p with respect to it
+/// \return false if the ear is not convex, i.e. \a s1, \a s2, \a s3 is not a left turn
+bool VoronoiDiagram::hole_ear(Site* s1, Site* s2, Site* s3, const Point& p, solvers::Solution& circle, double& power) {
+    if ( (s2->position()-s1->position()).cross( s3->position()-s2->position() ) <= 0 )
+        return false;
+    if ( !vpos->circumcenter(s1, s2, s3, circle) )
+        return false;
+    power = (p-circle.p).norm_sq() - circle.t*circle.t;
+    return true;
+}
+
+/// \brief add a PointSite - PointSite edge from \a src to \a trg, with face \a f on its left and \a twin_f on its right.
+///
+/// Like add_edge(), an ::APEX vertex is added if \a src and \a trg are on different sides of the
+/// line through the two sites. Next-pointers are not set, see repair_next().
+/// New vertices are added to \a touched.
+void VoronoiDiagram::add_bisector_edge(HEVertex src, HEVertex trg, HEFace f, HEFace twin_f, VertexVector& touched) {
+    Site* f_site = g[f].site;
+    Site* twin_site = g[twin_f].site;
+    bool src_sign = g[src].position.is_right( f_site->position(), twin_site->position() );
+    bool trg_sign = g[trg].position.is_right( f_site->position(), twin_site->position() );
+    if ( src_sign == trg_sign ) {
+        HEEdge e, e_twin;
+        boost::tie(e, e_twin) = g.add_twin_edges( src, trg );
+        g[e].set_parameters( f_site, twin_site, !src_sign );
+        g[e_twin].set_parameters( f_site, twin_site, !src_sign );
+        g[e_twin].share_parameters( g[e] );
+        g[e].face = f;            g[e].k = +1;
+        g[e_twin].face = twin_f;  g[e_twin].k = +1;
+    } else {
+        //   src -- e1 --> APEX -- e2 --> trg     on f
+        //   src <- e1_tw- APEX <- e2_tw- trg     on twin_f
+        HEVertex apex = add_vertex( VoronoiVertex(Point(0,0), UNDECIDED, APEX) );
+        HEEdge e1, e1_tw, e2, e2_tw;
+        boost::tie(e1, e1_tw) = g.add_twin_edges( src, apex );
+        boost::tie(e2, e2_tw) = g.add_twin_edges( apex, trg );
+        g[e1].set_parameters( f_site, twin_site, !src_sign );
+        g[e2].set_parameters( f_site, twin_site, !trg_sign );
+        g[e1_tw].set_parameters( twin_site, f_site, src_sign );
+        g[e2_tw].set_parameters( twin_site, f_site, trg_sign );
+        g[e1_tw].share_parameters( g[e1] );
+        g[e2_tw].share_parameters( g[e2] );
+        g[e1].face = f;          g[e1].k = +1;
+        g[e2].face = f;          g[e2].k = +1;
+        g[e1_tw].face = twin_f;  g[e1_tw].k = +1;
+        g[e2_tw].face = twin_f;  g[e2_tw].k = +1;
+        double min_t = g[e1].minimum_t( f_site, twin_site );
+        g[apex].position = g[e1].point( min_t );
+        g[apex].init_dist( f_site->apex_point( g[apex].position ) );
+        touched.push_back( apex );
+    }
+}
+
+/// \brief set the next-pointer of each edge into \a v to the edge out of \a v on the same face
+///
+/// this also sets the edge of each face around \a v.
+void VoronoiDiagram::repair_next(HEVertex v) {
+    EdgeVector out = g.out_edges(v);
+    BOOST_FOREACH( HEEdge e, out ) {
+        HEEdge in = g[e].twin;
+        BOOST_FOREACH( HEEdge e_next, out ) {
+            if ( g[e_next].face == g[in].face ) {
+                g[in].next = e_next;
+                break;
+            }
+        }
+        g[ g[in].face ].edge = in;
+    }
+}
+
+/// \brief true for each of \a segments that intersects another one, or a LineSite already in the diagram
+///
+/// \param segments pairs of valid point-site handles
+/// used by the bulk insert functions when use_site_validation() is on.
+std::vector<bool> VoronoiDiagram::find_intersecting_segments(const std::vector< std::pair<int,int> >& segments) {
+    // the points are the point-sites, by handle, followed by the endpoints of LineSite:s in the diagram
+    std::vector<Point> points( vertex_map.size() );
+    for (unsigned int h=0; h<vertex_map.size(); ++h) {
+        if ( vertex_map[h] != HEVertex() )
+            points[h] = g[ vertex_map[h] ].position;
+    }
+    std::vector< std::pair<int,int> > all( segments );
+    BOOST_FOREACH( HEEdge e, g.edges() ) {
+        if ( g[e].type == LINESITE && g[e].k == 1 ) {
+            all.push_back( std::make_pair( (int)points.size(), (int)points.size()+1 ) );
+            points.push_back( g[ g.source(e) ].position );
+            points.push_back( g[ g.target(e) ].position );
+        }
+    }
+    std::vector<bool> bad( segments.size(), false );
+    SiteValidator validator;
+    BOOST_FOREACH( const SiteConflict& c, validator.intersections(points, all) ) {
+        if ( c.first < (int)segments.size() )
+            bad[c.first] = true;
+        if ( c.second >= 0 && c.second < (int)segments.size() )
+            bad[c.second] = true;
+    }
+    return bad;
 }
 
 /// \brief find vertex descriptors corresponding to \a idx1 and \a idx2
 // given indices idx1 and idx2, return the corresponding vertex descriptors
 // the vertex_map is populated in insert_point_site()
 std::pair<HEVertex,HEVertex> VoronoiDiagram::find_endpoints(int idx1, int idx2) {
-    std::map<int,HEVertex>::iterator it_start, it_end;
-    it_start = vertex_map.find(idx1);
-    it_end = vertex_map.find(idx2);
-    assert( it_start != vertex_map.end() && it_end != vertex_map.end() ); // we must find idx1 and idx2 in the map
-    return std::make_pair( it_start->second, it_end->second);
+    // we must find idx1 and idx2 in the table
+    assert( idx1 >= 0 && idx1 < (int)vertex_map.size() && vertex_map[idx1] != HEVertex() );
+    assert( idx2 >= 0 && idx2 < (int)vertex_map.size() && vertex_map[idx2] != HEVertex() );
+    return std::make_pair( vertex_map[idx1], vertex_map[idx2] );
 }
 
 
@@ -783,17 +1886,16 @@ std::pair<HEVertex,HEFace> VoronoiDiagram::process_null_edge(Point dir, HEEdge n
     
     if ( g[adj].type == ENDPOINT ) { // target is endpoint
         // insert a normal vertex, positioned at mid-alfa between src/trg.
-        HEVertex new_v = g.add_vertex( VoronoiVertex(g[src].position,NEW,NORMAL,g[src].position) );
+        HEVertex new_v = add_vertex( VoronoiVertex(g[src].position,NEW,NORMAL,g[src].position) );
         double mid = numeric::diangle_mid( g[src].alfa, g[trg].alfa  );
         g[new_v].alfa = mid;
-        modified_vertices.insert(new_v);
-        g.add_vertex_in_edge( new_v, next_edge);
-        g[new_v].k3=new_k3;
-
+        mark_modified(new_v);
         if (debug) {
             std::cout << " e.trg=(ENDPOINT) \n";
             std::cout << " added NEW NORMAL vertex " << g[new_v].index << " in edge "; g.print_edge(next_edge);
         }
+        add_vertex_in_edge( new_v, next_edge); // this removes next_edge
+        g[new_v].k3=new_k3;
         return std::make_pair(HEVertex(), g.HFace() );
         
     } else {
@@ -883,7 +1985,7 @@ std::pair<HEVertex,HEFace> VoronoiDiagram::process_null_edge(Point dir, HEEdge n
             HEVertex sep_target = g.target(sep_edge);
             g[sep_target].status = NEW;
             g[sep_target].k3 = new_k3;
-            modified_vertices.insert(sep_target);
+            mark_modified(sep_target);
             
             return std::make_pair( HEVertex(), g[pointsite_edge].face ); // no new separator-point returned
         }
@@ -926,7 +2028,7 @@ std::pair<HEVertex,HEFace> VoronoiDiagram::process_null_edge(Point dir, HEEdge n
                 g[adj].status = NEW;
             }
             g[adj].k3 = new_k3;
-            modified_vertices.insert(adj);
+            mark_modified(adj);
             return std::make_pair( sep_point, g.HFace() );
         }
     }
@@ -938,14 +2040,14 @@ std::pair<HEVertex,HEFace> VoronoiDiagram::process_null_edge(Point dir, HEEdge n
 /// \param edge the null-edge into which we insert the new vertex
 /// \param sep_dir direction for setting alfa of the new vertex
 HEVertex VoronoiDiagram::add_separator_vertex(HEVertex endp, HEEdge edge, Point sep_dir) {
-    HEVertex sep = g.add_vertex( VoronoiVertex(g[endp].position,OUT,SEPPOINT) );
+    HEVertex sep = add_vertex( VoronoiVertex(g[endp].position,OUT,SEPPOINT) );
     g[sep].set_alfa(sep_dir);
     if (debug) {
         std::cout << " adding separator " << g[sep].index << " in null edge "; 
         g.print_edge(edge);
     }
-    g.add_vertex_in_edge(sep,edge);
-    modified_vertices.insert(sep);
+    add_vertex_in_edge(sep,edge);
+    mark_modified(sep);
     return sep;
 }
 
@@ -968,6 +2070,9 @@ bool VoronoiDiagram::null_vertex_target( HEVertex v , HEVertex& trg) {
 /// \param left   a point left of the new segment
 /// \param dir    alfa-direction for positioning endpoint vertex on null-face
 /// \param new_site    the new Site we are inserting 
+/// \param insert_edge  if \a start has a null-face, an edge of it where the new endpoint may be inserted.
+///                     used if it is still on the null-face and its twin is on an ::INCIDENT face,
+///                     otherwise the null-face is searched
 ///
 /// \return HEVertex ::ENDPOINT-vertex for the new vertex
 /// \return HEFace  null-face at endpoint (new or existing)
@@ -975,7 +2080,7 @@ bool VoronoiDiagram::null_vertex_target( HEVertex v , HEVertex& trg) {
 /// \return HEVertex negative ::SEPARATOR edge endpoint vertex (if a negative separator should be added)
 /// \return HEFace face-to-null. if a PointSite face should disappear, we return it here.
 boost::tuple<HEVertex,HEFace,HEVertex,HEVertex,HEFace>
-VoronoiDiagram::find_null_face(HEVertex start, HEVertex other, Point left, Point dir, Site* new_site) {
+VoronoiDiagram::find_null_face(HEVertex start, HEVertex other, Point left, Point dir, Site* new_site, HEEdge insert_edge) {
     HEVertex seg_start = HEVertex(); // new end-point vertices
     HEFace start_null_face; // either existing or new null-face at start-vertex
     
@@ -1004,13 +2109,24 @@ VoronoiDiagram::find_null_face(HEVertex start, HEVertex other, Point left, Point
         start_null_face = g[start].null_face;
 
         // create a new segment ENDPOINT vertex with zero clearance-disk
-        seg_start = g.add_vertex( VoronoiVertex(g[start].position,OUT,ENDPOINT,0) );
+        seg_start = add_vertex( VoronoiVertex(g[start].position,OUT,ENDPOINT,0) );
         // find the edge on the null-face where we insert seg_start
-        HEEdge insert_edge = HEEdge();
-        {
+        g[seg_start].set_alfa(dir);
+        if ( insert_edge != HEEdge() ) {
+            // the given edge may have been removed since it was found. only look at its
+            // properties once it is found in the edge-cycle of the null-face
+            bool on_null_face = false;
+            HEEdge current = g[start_null_face].edge;
+            do {
+                on_null_face = ( current == insert_edge );
+                current = g[current].next;
+            } while ( current != g[start_null_face].edge && !on_null_face );
+            if ( !on_null_face || g[ g[ g[insert_edge].twin ].face ].status != INCIDENT )
+                insert_edge = HEEdge(); // the given edge can not be used
+        }
+        if ( insert_edge == HEEdge() ) {
             HEEdge current2 = g[start_null_face].edge;
             HEEdge start_edge2 = current2;
-            g[seg_start].set_alfa(dir);
             bool found = false;
             if (debug) std::cout << " Looking for endpoint edge:\n";
             do {
@@ -1035,10 +2151,10 @@ VoronoiDiagram::find_null_face(HEVertex start, HEVertex other, Point left, Point
             }*/
             if (debug) { std::cout << "  endpoint edge is "; g.print_edge(insert_edge); }
         }
-        g.add_vertex_in_edge(seg_start,insert_edge); // insert endpoint in null-edge
-
         if (debug) { std::cout << "  new endpoint vertex " << g[seg_start].index << " inserted in edge "; g.print_edge(insert_edge); }
 
+        add_vertex_in_edge(seg_start,insert_edge); // insert endpoint in null-edge (this removes insert_edge)
+
         // "process" the adjacent null-edges 
         HEEdge next_edge, prev_edge;
         boost::tie(next_edge,prev_edge) = g.find_next_prev(start_null_face, seg_start);
@@ -1059,12 +2175,12 @@ VoronoiDiagram::find_null_face(HEVertex start, HEVertex other, Point left, Point
         g[start_null_face].null = true;
           
         if (debug) std::cout << " find_null_face() endp= " << g[start].index <<  " creating new null_face " << start_null_face << "\n";
-        seg_start = g.add_vertex( VoronoiVertex(g[start].position,OUT,ENDPOINT) );
+        seg_start = add_vertex( VoronoiVertex(g[start].position,OUT,ENDPOINT) );
         g[seg_start].zero_dist();
         g[seg_start].set_alfa(dir);
         g[seg_start].k3=0;
-        pos_sep_start = g.add_vertex( VoronoiVertex(g[start].position,UNDECIDED,SEPPOINT) );
-        neg_sep_start = g.add_vertex( VoronoiVertex(g[start].position,UNDECIDED,SEPPOINT) );
+        pos_sep_start = add_vertex( VoronoiVertex(g[start].position,UNDECIDED,SEPPOINT) );
+        neg_sep_start = add_vertex( VoronoiVertex(g[start].position,UNDECIDED,SEPPOINT) );
         
         g[pos_sep_start].zero_dist();
         g[neg_sep_start].zero_dist();
@@ -1235,6 +2351,7 @@ void VoronoiDiagram::add_separator(HEFace f, HEFace null_face,
     }
     g[e2   ].set_sep_parameters( g[sep_endp].position, g[v_target].position );
     g[e2_tw].set_sep_parameters( g[sep_endp].position, g[v_target].position );
+    g[e2_tw].share_parameters( g[e2] );
         
     if (debug) {
         std::cout << "add_separator(): ";
@@ -1244,6 +2361,26 @@ void VoronoiDiagram::add_separator(HEFace f, HEFace null_face,
     assert( vd_checker->check_edge(e2_tw) );
 }
 
+/// \brief the seed candidate of \a joint with the largest clearance-disk violation by \a site
+///
+/// like find_seed_vertex(), but only the PolylineJoint::seeds are examined.
+/// \return HEVertex() if no candidate is in the region of \a site and violated by it
+HEVertex VoronoiDiagram::find_joint_seed(const PolylineJoint& joint, Site* site) {
+    double minPred( 0.0 );
+    HEVertex minimalVertex = HEVertex();
+    BOOST_FOREACH( HEVertex q, joint.seeds ) {
+        if ( q == HEVertex() || g[q].status == OUT || g[q].type != NORMAL || !site->in_region( g[q].position ) )
+            continue;
+        double h = g[q].in_circle( site->apex_point( g[q].position ) );
+        if ( h < minPred ) {
+            minPred = h;
+            minimalVertex = q;
+        }
+    }
+    if (debug && minimalVertex != HEVertex() ) std::cout << "find_joint_seed() seed= " << g[minimalVertex].index << " h= " << minPred << "\n";
+    return minimalVertex;
+}
+
 /// find amount of clearance-disk violation on all vertices of face f 
 /// \return vertex with the largest clearance-disk violation
 HEVertex VoronoiDiagram::find_seed_vertex(HEFace f, Site* site)  {
@@ -1290,7 +2427,7 @@ void VoronoiDiagram::augment_vertex_set(  Site* site ) {
         HEVertex v = HEVertex();
         double h(0);
         boost::tie( v, h ) = vertexQueue.top();
-        assert( g.g[v].status == UNDECIDED );
+        assert( g[v].status == UNDECIDED );
         vertexQueue.pop(); 
         if ( h < 0.0 ) { // try to mark IN if h<0 and passes (C4) and (C5) tests and in_region(). otherwise mark OUT
             if ( predicate_c4(v) || !predicate_c5(v) || !site->in_region(g[v].position) ) {
@@ -1309,7 +2446,7 @@ void VoronoiDiagram::augment_vertex_set(  Site* site ) {
             g[v].status = OUT; // detH was positive (or zero), so mark OUT
             if (debug) std::cout << g[v].index << " marked OUT (in_circle) ( " << h << " )\n";
         }
-        modified_vertices.insert( v );
+        mark_modified( v );
     }
     
     assert( vertexQueue.empty() );
@@ -1324,7 +2461,7 @@ void VoronoiDiagram::augment_vertex_set(  Site* site ) {
 void VoronoiDiagram::mark_vertex(HEVertex& v,  Site* site) {
     g[v].status = IN;
     v0.push_back( v );
-    modified_vertices.insert(v);
+    mark_modified(v);
     
     if (site->isPoint())
         mark_adjacent_faces_p(v);
@@ -1334,10 +2471,10 @@ void VoronoiDiagram::mark_vertex(HEVertex& v,  Site* site) {
     // push the v-adjacent vertices onto the queue
     BOOST_FOREACH(HEEdge e, g.out_edge_itr( v )) {
         HEVertex w = g.target( e );
-        if ( (g[w].status == UNDECIDED) && (!g[w].in_queue) ) {
+        if ( (g[w].status == UNDECIDED) && (g[w].queue_epoch != epoch) ) {
                 // when pushing onto queue we also evaluate in_circle predicate so that we process vertices in the correct order
                 vertexQueue.push( VertexDetPair(w , g[w].in_circle(site->apex_point(g[w].position)) ) ); 
-                g[w].in_queue=true;
+                g[w].queue_epoch = epoch;
                 if (debug) std::cout << "  " << g[w].index << " queued (h=" << g[w].in_circle(site->apex_point(g[w].position)) << " )\n";
         }
     }
@@ -1352,6 +2489,8 @@ void VoronoiDiagram::mark_adjacent_faces_p( HEVertex v ) {
     BOOST_FOREACH(HEEdge e, g.out_edge_itr( v )) {
         HEFace adj_face = g[e].face;
         if ( g[adj_face].status  != INCIDENT ) {
+            if (undo)
+                undo->save_face(adj_face);
             g[adj_face].status = INCIDENT; 
             incident_faces.push_back(adj_face);
         }
@@ -1375,6 +2514,8 @@ void VoronoiDiagram::mark_adjacent_faces( HEVertex v, Site* site) {
 
     BOOST_FOREACH( HEFace adj_face, new_adjacent_faces ) {
         if ( g[adj_face].status != INCIDENT ) {
+            if (undo)
+                undo->save_face(adj_face);
             if ( site->isLine() )
                 add_split_vertex(adj_face, site);
 
@@ -1484,17 +2625,13 @@ void VoronoiDiagram::add_split_vertex(HEFace f, Site* s) {
             // - create virtual line-site vs: same direction as s(lineSite), but goes through fs(pointSite)
             // - use solver to position SPLIT vertex. The sites are: (vs,fs, fs-adjacent)
         #ifndef TOMS748
-            Site* vs = new LineSite(*s);
-            vs->set_c( fs->position() ); // modify the line-equation so that the line goes trough fs->position()
-            Solution sl = vpos->position( split_edge, vs );
+            LineSite vs(*s);
+            vs.set_c( fs->position() ); // modify the line-equation so that the line goes trough fs->position()
+            Solution sl = vpos->position( split_edge, &vs );
             split_pt_pos = sl.p;
         #endif
         
-            HEVertex v = g.add_vertex( VoronoiVertex(split_pt_pos, UNDECIDED, SPLIT, fs->position() ) );
-            
-        #ifndef TOMS748
-            delete vs;
-        #endif
+            HEVertex v = add_vertex( VoronoiVertex(split_pt_pos, UNDECIDED, SPLIT, fs->position() ) );
         
             //std::cout << "toms748: " << split_pt << "\n";
             //std::cout << "solver:  " << sl.p << "\n";
@@ -1505,7 +2642,7 @@ void VoronoiDiagram::add_split_vertex(HEFace f, Site* s) {
             
             assert( vd_checker->check_edge(split_edge) );
             // 3) insert new SPLIT vertex into the edge
-            g.add_vertex_in_edge(v, split_edge);
+            add_vertex_in_edge(v, split_edge);
         }
     }
 }
@@ -1537,8 +2674,8 @@ void VoronoiDiagram::remove_split_vertex(HEFace f) {
         assert(g[v].type == SPLIT); 
         if (debug) std::cout << " removing split-vertex " << g[v].index << "\n";
         
-        g.remove_deg2_vertex( v );
-        modified_vertices.erase(v);
+        unmark_modified(v);
+        remove_deg2_vertex( v );
         
         assert( vd_checker->face_ok( f ) );
     }
@@ -1573,14 +2710,16 @@ void VoronoiDiagram::add_vertices( Site* new_site ) {
             
             std::cout <<  "     derr =" << vpos->dist_error( q_edges[m], sl, new_site) << "\n";
             //exit(-1);
+            insertion_error = true;
         }
-        HEVertex q = g.add_vertex( VoronoiVertex( sl.p, NEW, NORMAL, new_site->apex_point( sl.p ), sl.k3 ) );
-        modified_vertices.insert(q);
-        g.add_vertex_in_edge( q, q_edges[m] );
+        HEVertex q = add_vertex( VoronoiVertex( sl.p, NEW, NORMAL, new_site->apex_point( sl.p ), sl.k3 ) );
+        mark_modified(q);
+        // q_edges[m] is removed by add_vertex_in_edge(), so look at it before the split.
         g[q].max_error = vpos->dist_error( q_edges[m], sl, new_site);
+        HEVertex src = g.source(q_edges[m]);
+        HEVertex trg = g.target(q_edges[m]);
+        add_vertex_in_edge( q, q_edges[m] );
         if (debug) {
-            HEVertex src = g.source(q_edges[m]);
-            HEVertex trg = g.target(q_edges[m]);
             std::cout << " NEW vertex " << g[q].index << " k3= "<< g[q].k3 << " on edge " << g[src].index << " - " << g[trg].index << "\n";
             assert( (g[q].k3==1) || (g[q].k3==-1) );
         }
@@ -1596,10 +2735,6 @@ HEFace VoronoiDiagram::add_face(Site* s) {
     g[newface].site = s;
     s->face = newface;
     g[newface].status = NONINCIDENT;
-    if (s->isPoint() )
-        kd_tree->insert( kd_point( s->position(), newface ) );
-        //fgrid->add_face( newface, s->position() ); 
-    
     return newface;
 }
 
@@ -1750,6 +2885,7 @@ void VoronoiDiagram::add_edge(EdgeData ed, HEFace newface, HEFace newface2) {
         g[e_twin].next = twin_next;
         g[e_twin].k = g[new_source].k3; 
         g[e_twin].set_parameters( f_site, new_site,  !src_sign ); // new_site, f_site, src_sign 
+        g[e_twin].share_parameters( g[e_new] );
         g[e_twin].face = new_face; 
         g[new_face].edge = e_twin;
 
@@ -1769,7 +2905,7 @@ void VoronoiDiagram::add_edge(EdgeData ed, HEFace newface, HEFace newface2) {
         //   twn_nxt <- NEW <- e1_tw -- APEX <-e2_tw-- NEW <- twn_prv    
         //                       new1/new2         new1/new2
         //   
-        HEVertex apex = g.add_vertex( VoronoiVertex(Point(0,0), NEW,APEX) );
+        HEVertex apex = add_vertex( VoronoiVertex(Point(0,0), NEW,APEX) );
         if (debug) std::cout << " add_edge with APEX " << g[new_source].index << " - [" << g[apex].index << "] - " << g[new_target].index << "\n";
         
         HEEdge e1, e1_tw;
@@ -1792,6 +2928,8 @@ void VoronoiDiagram::add_edge(EdgeData ed, HEFace newface, HEFace newface2) {
     // twin edges
         g[e1_tw].set_parameters(new_site, f_site, src_sign);
         g[e2_tw].set_parameters(new_site, f_site, trg_sign);
+        g[e1_tw].share_parameters( g[e1] );
+        g[e2_tw].share_parameters( g[e2] );
 
         assert( g[twin_previous].k == g[twin_next].k );  
         assert( g[twin_previous].face == g[twin_next].face );        
@@ -1818,7 +2956,7 @@ void VoronoiDiagram::add_edge(EdgeData ed, HEFace newface, HEFace newface2) {
         double min_t = g[e1].minimum_t(f_site,new_site);
         g[apex].position = g[e1].point(min_t);
         g[apex].init_dist(f_site->apex_point(g[apex].position));
-        modified_vertices.insert( apex );
+        mark_modified( apex );
     }
 }
 
@@ -2102,8 +3240,8 @@ void VoronoiDiagram::repair_face( HEFace f, std::pair<HEVertex,HEVertex> segment
 void VoronoiDiagram::remove_vertex_set() {
     BOOST_FOREACH( HEVertex& v, v0 ) {      // it should now be safe to delete all IN vertices
         assert( g[v].status == IN );
+        unmark_modified(v);
         g.delete_vertex(v); // this also removes edges connecting to v
-        modified_vertices.erase(v);
     }
 }
 
@@ -2112,9 +3250,12 @@ void VoronoiDiagram::remove_vertex_set() {
 /// at the end after an incremental insertion of a new site,
 /// reset status of modified_vertices to UNDECIDED and incident_faces to NONINCIDENT,
 /// so that we are ready for the next insertion.
+/// Advancing the epoch makes all queue- and modified-stamps stale at once.
+/// The vectors keep their storage, so a steady-state insertion does not allocate here.
 void VoronoiDiagram::reset_status() {
     BOOST_FOREACH( HEVertex v, modified_vertices ) {
-        g[v].reset_status();
+        if ( v != HEVertex() )
+            g[v].reset_status();
     }
     modified_vertices.clear();
     BOOST_FOREACH(HEFace& f, incident_faces ) { 
@@ -2122,6 +3263,31 @@ void VoronoiDiagram::reset_status() {
     }
     incident_faces.clear();
     v0.clear();
+    if ( ++epoch == 0 ) { // wrapped around after 2^32 insertions. clear all stamps.
+        BOOST_FOREACH( HEVertex v, g.vertices() ) {
+            g[v].queue_epoch = 0;
+            g[v].modified_epoch = 0;
+        }
+        epoch = 1;
+    }
+}
+
+/// add \a v to modified_vertices, unless it is already there
+void VoronoiDiagram::mark_modified(HEVertex v) {
+    if ( g[v].modified_epoch == epoch )
+        return;
+    g[v].modified_epoch = epoch;
+    g[v].modified_slot = modified_vertices.size();
+    modified_vertices.push_back(v);
+}
+
+/// remove \a v from modified_vertices. call this before \a v is deleted from the graph.
+void VoronoiDiagram::unmark_modified(HEVertex v) {
+    if ( g[v].modified_epoch != epoch )
+        return;
+    assert( modified_vertices[ g[v].modified_slot ] == v );
+    modified_vertices[ g[v].modified_slot ] = HEVertex();
+    g[v].modified_epoch = 0;
 }
 
 /// \brief find and return ::IN - ::OUT edges
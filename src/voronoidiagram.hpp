@@ -20,14 +20,19 @@
 #pragma once
 
 #include <queue>
+#include <string>
+#include <ostream>
 #include <set>
 #include <boost/tuple/tuple.hpp>
 
 #include "common/point.hpp"
+#include "common/arena.hpp"
 #include "graph.hpp"
 #include "vertex_positioner.hpp"
 #include "filter.hpp"
 #include "kdtree.hpp"
+#include "bucketgrid.hpp"
+#include "diagram_snapshot.hpp"
 
 /*! \mainpage OpenVoronoi
  *
@@ -89,6 +94,8 @@ namespace ovd
  
  
 class VoronoiDiagramChecker;
+class UndoLog;
+class DiagramArchive;
 
 /// \brief KD-tree for 2D point location
 ///
@@ -119,6 +126,8 @@ struct kd_point {
 
 /// type of the KD-tree used for nearest-neighbor search
 typedef kdtree::KDTree<kd_point> kd_type; 
+/// type of the bucket-grid used for nearest-neighbor search
+typedef bucketgrid::BucketGrid<kd_point> grid_type; 
 
 /// \brief Voronoi diagram.
 ///
@@ -132,8 +141,13 @@ class VoronoiDiagram {
 public:
     VoronoiDiagram(double far, unsigned int n_bins);
     virtual ~VoronoiDiagram();
-    int insert_point_site(const Point& p);
+    void reset(double far);
+    int insert_point_site(const Point& p, int step=99);
+    std::vector<int> insert_point_sites(const std::vector<Point>& points);
     bool insert_line_site(int idx1, int idx2, int step=99); // default step should make algorithm run until the end!
+    std::vector<bool> insert_line_sites(const std::vector< std::pair<int,int> >& segments);
+    bool insert_polyline(const std::vector<int>& handles, bool closed);
+    bool remove_point_site(int handle);
     void insert_arc_site(int idx1, int idx2, const Point& c, bool cw, int step=99);
     
     /// return the far radius
@@ -153,8 +167,8 @@ public:
     HEGraph& get_graph_reference() {return g;}
     
     std::string print() const;
-    /// reset vertex index count \todo not very elegant...
-    static void reset_vertex_count() { VoronoiVertex::reset_count(); } // why do we need this?
+    /// reset vertex index count of this diagram \todo not very elegant...
+    void reset_vertex_count() { vertex_count = 0; } // why do we need this?
     /// turn on debug output
     void debug_on() {debug=true;} 
     /// set silent mode on/off
@@ -163,8 +177,40 @@ public:
         vpos->set_silent(silent);
     } 
     bool check(); 
+    void use_face_grid(bool b);
+    /// true if insert_point_site() uses the bucket-grid, false if it uses the kd-tree
+    bool using_face_grid() const {return face_grid!=0;}
+    void use_jump_and_walk(bool b, unsigned int max_steps=64);
+    /// \brief check sites in insert_point_sites(), insert_line_sites() and insert_polyline() with SiteValidator
+    ///
+    /// duplicate points and intersecting segments are then skipped with a warning, instead of
+    /// being inserted and corrupting (or crashing) the diagram.
+    void use_site_validation(bool b) { validate_sites = b; }
+    void use_rollback(bool b);
+    /// true if a failed insertion is undone, see use_rollback()
+    bool using_rollback() const {return undo!=0;}
+    unsigned int solver_tier_count(int tier) const;
+    void reset_solver_tier_counts();
+    unsigned int num_qll_escalations() const;
+    void set_qll_mode(QLLMode m);
+    void force_desperate(unsigned int n);
     void filter( Filter* flt);
     void filter_reset();
+    void save(std::ostream& out);
+    bool save_file(const std::string& filename);
+    bool load(const char* data, std::size_t size);
+    bool load_file(const std::string& filename);
+    /// \brief an immutable copy of the diagram, for read-only algorithms, see DiagramSnapshot
+    DiagramSnapshot snapshot() { return DiagramSnapshot(g, changes); }
+    void use_snapshot_publishing(bool b, unsigned int interval=1);
+    void publish();
+    /// \brief the most recently published snapshot, or an empty pointer if publishing is off
+    ///
+    /// unlike all other member functions, this may be called from any thread while the diagram is modified.
+    SnapshotPtr published() const { return boost::atomic_load( &current_snapshot ); }
+    /// the number of committed insertions, removals, resets and loads. the version of a snapshot taken now.
+    unsigned int num_changes() const { return changes; }
+    friend class DiagramArchive;
 protected:
     /// type for item in VertexQueue. pair of vertex-descriptor and
     /// the value of the in_circle predicate
@@ -188,6 +234,28 @@ protected:
     /// whose IN/OUT status we are 'most certain' about are processed first
     typedef std::priority_queue< VertexDetPair , std::vector<VertexDetPair>, abs_comparison > VertexQueue;
     
+    /// \brief state of the diagram outside the graph, saved by begin_insertion()
+    struct Checkpoint {
+        int num_psites;                  ///< VoronoiDiagram::num_psites
+        int num_lsites;                  ///< VoronoiDiagram::num_lsites
+        int vertex_count;                ///< VoronoiDiagram::vertex_count
+        unsigned int vertex_map_size;    ///< size of VoronoiDiagram::vertex_map
+        HEFace last_point_face;          ///< VoronoiDiagram::last_point_face
+        unsigned int num_faces;          ///< number of faces in the graph
+        unsigned int num_desperate;      ///< VertexPositioner::num_desperate()
+    };
+
+    /// \brief what add_line_site() leaves at the end of a segment, for the next segment of a polyline
+    ///
+    /// see insert_polyline(). Valid only right after the segment that ended at \a endp was inserted.
+    struct PolylineJoint {
+        PolylineJoint() : endp(), null_face(0), null_edge() { seeds[0] = seeds[1] = HEVertex(); }
+        HEVertex endp;      ///< point-site vertex where the segment ended. HEVertex() if there is no joint
+        HEFace null_face;   ///< null-face of endp
+        HEEdge null_edge;   ///< edge of null_face with the point-site face of endp on its twin, or HEEdge()
+        HEVertex seeds[2];  ///< targets of the separators at endp, on its point-site face. seed-vertex candidates
+    };
+
     /// \brief data required for adding a new edge
     ///
     /// used in add_edge() for storing information related to
@@ -203,12 +271,25 @@ protected:
     };
 
     void initialize();
+    void nearest_index_insert(const kd_point& pt);
+    void nearest_index_remove(const kd_point& pt);
+    void nearest_index_update(const kd_point& pt);
+    HEFace find_nearest_face(const Point& p);
+    bool walk_to_nearest_face(HEFace start, const Point& p, HEFace& nearest);
     HEVertex   find_seed_vertex(HEFace f, Site* site);
+    HEVertex   find_joint_seed(const PolylineJoint& joint, Site* site);
     EdgeVector find_in_out_edges(); 
     EdgeData   find_edge_data(HEFace f, VertexVector startverts, std::pair<HEVertex,HEVertex> segment);
     EdgeVector find_split_edges(HEFace f, Point pt1, Point pt2);
     bool       find_split_vertex(HEFace f, HEVertex& v);
     std::pair<HEVertex,HEVertex> find_endpoints(int idx1, int idx2);
+    int  add_point_site(const Point& p, int step);
+    bool insert_segment(HEVertex start, HEVertex end, int step=99, PolylineJoint* joint=0);
+    bool add_line_site(HEVertex start, HEVertex end, int step, PolylineJoint* joint);
+    void begin_insertion();
+    bool end_insertion(bool ok);
+    bool insertion_ok();
+    std::vector<bool> find_intersecting_segments(const std::vector< std::pair<int,int> >& segments);
     bool null_vertex_target( HEVertex v , HEVertex& trg);
     void augment_vertex_set( Site* site);        
     bool predicate_c4(HEVertex v);
@@ -223,7 +304,7 @@ protected:
     void   add_edge(EdgeData ed, HEFace new1, HEFace new2=0);
     void   add_separator(HEFace f, HEFace nf, boost::tuple<HEEdge, HEVertex, HEEdge,bool> target, HEVertex endp, Site* s1, Site* s2);
     void   add_split_vertex(HEFace f, Site* s);
-    boost::tuple<HEVertex,HEFace,HEVertex,HEVertex,HEFace> find_null_face(HEVertex start, HEVertex other, Point l, Point dir, Site* new_site);
+    boost::tuple<HEVertex,HEFace,HEVertex,HEVertex,HEFace> find_null_face(HEVertex start, HEVertex other, Point l, Point dir, Site* new_site, HEEdge insert_edge=HEEdge());
     boost::tuple<HEEdge,HEVertex,HEEdge,bool> find_separator_target(HEFace f, HEVertex endp);
     std::pair<HEVertex,HEFace> process_null_edge(Point dir, HEEdge next_edge , bool k3, bool next_prev);
     HEVertex add_separator_vertex(HEVertex endp, HEEdge edge, Point sep_dir);
@@ -234,25 +315,58 @@ protected:
     void remove_vertex_set();
     void remove_split_vertex(HEFace f);
     void reset_status();
+    void mark_modified(HEVertex v);
+    void unmark_modified(HEVertex v);
     int num_new_vertices(HEFace f);
+    HEVertex add_vertex(const VoronoiVertex& vv);
+    void add_vertex_in_edge(HEVertex v, HEEdge e);
+    void remove_deg2_vertex(HEVertex v);
+    bool triangulate_hole(const std::vector<Site*>& q, const Point& p,
+                          std::vector<unsigned int>& ears, std::vector<solvers::Solution>& circles);
+    bool hole_ear(Site* s1, Site* s2, Site* s3, const Point& p, solvers::Solution& circle, double& power);
+    void add_bisector_edge(HEVertex src, HEVertex trg, HEFace f, HEFace twin_f, VertexVector& touched);
+    void repair_next(HEVertex v);
+    void build_nearest_index();
+    void committed();
+    void publish_pending();
 // HELPER-CLASSES
     VoronoiDiagramChecker* vd_checker; ///< sanity-checks on the diagram are done by this helper class
     kd_type* kd_tree; ///< kd-tree for nearest neighbor search during point Site insertion
+    grid_type* face_grid; ///< bucket-grid for nearest neighbor search, used instead of kd_tree when non-zero
+    unsigned int n_bins; ///< number of bins (along x and y) for face_grid
+    bool jump_and_walk; ///< locate new point-sites by walking from last_point_face
+    unsigned int walk_max_steps; ///< give up the walk, and use kd_tree/face_grid, after this many steps
+    bool validate_sites; ///< check the input of the bulk insert functions, see use_site_validation()
+    HEFace last_point_face; ///< face of the most recently inserted PointSite
     VertexPositioner* vpos; ///< an algorithm for positioning vertices
+    UndoLog* undo; ///< undo-log of the current insertion, when non-zero. see use_rollback()
+    Checkpoint checkpoint; ///< state at the start of the current insertion, used with undo
+    bool insertion_error; ///< a vertex of the current insertion could not be positioned accurately
+    unsigned int publish_interval; ///< publish() after this many committed changes. zero when publishing is off
+    unsigned int unpublished; ///< committed changes since the last publish()
+    unsigned int changes; ///< num_changes()
+    /// the published snapshot. written by publish(), and read by published() from other threads,
+    /// so it is only accessed with boost::atomic_load() and boost::atomic_store()
+    SnapshotPtr current_snapshot;
 // DATA
-    typedef std::map<int,HEVertex> VertexMap; ///< type for vertex-index to vertex-descriptor map
-    typedef std::pair<int,HEVertex> VertexMapPair; ///< associate vertex index with vertex descriptor
-    
-    VertexMap vertex_map; ///< map from int handles to vertex-descriptors, used in insert_line_site()
-    VertexQueue vertexQueue; ///< queue of vertices to be processed
+    /// vertex-descriptors of point-sites, indexed by the int handle (vertex index) returned by insert_point_site().
+    /// other vertex indices hold HEVertex(). used in insert_line_site()
+    VertexVector vertex_map;
+    VertexQueue vertexQueue; ///< queue of vertices to be processed. its storage is kept between insertions
+    Arena site_arena; ///< all Site objects are created here, and destroyed with the diagram
     HEGraph g; ///< the half-edge diagram of the vd
     double far_radius; ///< sites must fall within a circle with radius far_radius
     int num_psites; ///< the number of point sites
     int num_lsites; ///< the number of line-segment sites
     int num_asites; ///< the number of arc-sites
+    int vertex_count; ///< index for the next new vertex. vertex indices are unique within one diagram.
     FaceVector incident_faces; ///< temporary variable for ::INCIDENT faces, will be reset to ::NONINCIDENT after a site has been inserted
-    std::set<HEVertex> modified_vertices; ///< temporary variable for in-vertices, out-vertices that need to be reset after a site has been inserted
+    /// temporary variable for in-vertices, out-vertices that need to be reset after a site has been inserted.
+    /// filled by mark_modified(). vertices removed by unmark_modified() leave a HEVertex() hole.
+    VertexVector modified_vertices;
     VertexVector v0; ///< IN-vertices, i.e. to-be-deleted
+    /// insertion counter for the epoch-stamps in VoronoiVertex. advanced by reset_status(), never zero
+    unsigned int epoch;
     bool debug; ///< turn debug output on/off
     bool silent; ///< no warnings emitted when silent==true
 private: